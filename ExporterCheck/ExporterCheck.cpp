@@ -0,0 +1,129 @@
+//checks that headers made by NetworkExporter evaluate the same way as the networks they were made from
+//the headers in generated/ are compiled into this program. it makes the same networks again, checks the exporter still writes the same headers,
+//and compares the compiled Evaluate functions with Network::Evaluate
+//the project runs it after every build, so a failed check fails the build
+//run with --regenerate <directory> to rewrite the headers after changing the exporter on purpose (then build again)
+#include "nlv.h"
+#include "generated/DenseCheck.h"
+#include "generated/RecurrentCheck.h"
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+using namespace nlv;
+
+//outputs go through the same math in the same order, so they can only differ by how the compiler optimizes floats
+constexpr float TOLERANCE = 1e-5f;
+constexpr uint32_t EVALUATION_COUNT = 64;
+
+//genes are multiples of 1/512, so every compiler and standard library makes exactly the same network (and the same header)
+static void SetCheckGenes(Network& network)
+{
+	for (uint32_t i = 0; i < network.GetGeneCount(); i++)
+		network.SetGene(i, (float)((i * 7919 + 13) % 2001) / 512.0f - 1000.0f / 512.0f);
+}
+
+static Network MakeDenseNetwork()
+{
+	Network network(12, { 16, 10 }, 4);
+	SetCheckGenes(network);
+	return network;
+}
+
+//recurrent layers, 16 bit genes and disabled connections are all things the exporter has to bake into the header
+static Network MakeRecurrentNetwork()
+{
+	Network network(5, { 6, 3 }, 2, { LayerType::GRU, LayerType::Elman });
+	SetCheckGenes(network);
+	network.SetGenePrecision(GenePrecision::BFloat16);
+	network.EnableConnectionMask();
+	network.SetConnectionEnabled(0, 1, 1, false);
+	network.SetConnectionEnabled(1, 2, 4, false);
+	return network;
+}
+
+static void MakeInput(float* input, uint32_t count, uint32_t evaluation)
+{
+	for (uint32_t i = 0; i < count; i++)
+		input[i] = std::sin((float)i + evaluation * 0.3f) * 2;
+}
+
+// Returns whether the exporter still makes the header that was compiled in
+static bool CheckHeaderText(const Network& network, const char* name, const char* filename)
+{
+	std::ifstream file(std::string("generated/") + filename);
+	if (!file.is_open())
+	{
+		//(only the evaluation can be checked when the program isn't run from its own directory)
+		printf("%s: couldn't open generated/%s, skipping the header text check\n", name, filename);
+		return true;
+	}
+	std::stringstream ss;
+	ss << file.rdbuf();
+	if (ss.str() != NetworkExporter(network, name).SaveToString())
+	{
+		printf("%s: the exporter makes a different header to generated/%s, run with --regenerate\n", name, filename);
+		return false;
+	}
+	return true;
+}
+
+// Compares the compiled header's Evaluate function with Network::Evaluate over EVALUATION_COUNT inputs
+// evaluate: calls the header's Evaluate function with an input and output (and its state if the network is recurrent)
+template<typename Evaluate>
+static bool CheckEvaluation(Network& network, const char* name, Evaluate&& evaluate)
+{
+	std::vector<float> input(network.GetInputCount());
+	std::vector<float> output(network.GetOutputCount());
+	float maxDifference = 0;
+	for (uint32_t e = 0; e < EVALUATION_COUNT; e++)
+	{
+		MakeInput(input.data(), network.GetInputCount(), e);
+		evaluate(input.data(), output.data());
+		const float* expected = network.Evaluate(input.data(), network.GetInputCount());
+		for (uint32_t o = 0; o < network.GetOutputCount(); o++)
+			maxDifference = std::max(maxDifference, std::abs(output[o] - expected[o]));
+	}
+
+	bool passed = maxDifference <= TOLERANCE;
+	printf("%s: max difference %g %s\n", name, maxDifference, passed ? "(passed)" : "(failed)");
+	return passed;
+}
+
+int main(int argc, char** argv)
+{
+	Network dense = MakeDenseNetwork();
+	Network recurrent = MakeRecurrentNetwork();
+
+	if (argc == 3 && std::string(argv[1]) == "--regenerate")
+	{
+		std::string directory = argv[2];
+		bool saved = NetworkExporter(dense, "dense_check").SaveToFile(directory + "/DenseCheck.h")
+			&& NetworkExporter(recurrent, "recurrent_check").SaveToFile(directory + "/RecurrentCheck.h");
+		printf(saved ? "headers saved, build and run again to check them\n" : "couldn't save the headers\n");
+		return saved ? 0 : 1;
+	}
+
+	bool passed = CheckHeaderText(dense, "dense_check", "DenseCheck.h");
+	passed &= CheckHeaderText(recurrent, "recurrent_check", "RecurrentCheck.h");
+
+	//the layouts have to match before the outputs can be compared
+	if (dense_check::INPUT_COUNT != dense.GetInputCount() || dense_check::OUTPUT_COUNT != dense.GetOutputCount()
+		|| recurrent_check::INPUT_COUNT != recurrent.GetInputCount() || recurrent_check::OUTPUT_COUNT != recurrent.GetOutputCount()
+		|| recurrent_check::STATE_COUNT != recurrent.GetStateCount())
+	{
+		printf("the compiled headers are for different networks, run with --regenerate\n");
+		return 1;
+	}
+
+	passed &= CheckEvaluation(dense, "dense_check", [](const float* input, float* output) { dense_check::Evaluate(input, output); });
+	//both start with a hidden state of 0s, and keep it between evaluations
+	float state[recurrent_check::STATE_COUNT] = {};
+	passed &= CheckEvaluation(recurrent, "recurrent_check", [&](const float* input, float* output) { recurrent_check::Evaluate(input, output, state); });
+
+	printf(passed ? "passed\n" : "failed\n");
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#pragma once
+//generated by nlv from a network with 12 inputs and layers of 16 (dense) 10 (dense) 4 (dense)
+#include <cmath>
+#include <cstdint>
+
+namespace dense_check
+{
+	constexpr uint32_t INPUT_COUNT = 12;
+	constexpr uint32_t OUTPUT_COUNT = 4;
+	//the number of floats of hidden state recurrent layers keep between evaluations
+	constexpr uint32_t STATE_COUNT = 0;
+
+	namespace detail
+	{
+		inline float Activate(float weightedInput)
+		{
+			return 1.0f / (1 + std::exp(weightedInput));
+		}
+
+		//adds input * weights into sums
+		template<uint32_t IN, uint32_t OUT>
+		inline void AddWeighted(const float* input, const float (&weights)[IN][OUT], float (&sums)[OUT])
+		{
+			for (uint32_t i = 0; i < IN; i++)
+				for (uint32_t n = 0; n < OUT; n++)
+					sums[n] += input[i] * weights[i][n];
+		}
+
+		//outputs = Activate(biases + input * weights)
+		template<uint32_t IN, uint32_t OUT>
+		inline void Dense(const float* input, const float (&biases)[OUT], const float (&weights)[IN][OUT], float (&outputs)[OUT])
+		{
+			for (uint32_t n = 0; n < OUT; n++)
+				outputs[n] = biases[n];
+			AddWeighted(input, weights, outputs);
+			for (uint32_t n = 0; n < OUT; n++)
+				outputs[n] = Activate(outputs[n]);
+		}
+
+		//outputs = Activate(biases + input * weights + hiddenInput * hiddenWeights), a gate of a recurrent layer
+		template<uint32_t IN, uint32_t OUT>
+		inline void Gate(const float* input, const float* hiddenInput, const float (&biases)[OUT], const float (&weights)[IN][OUT],
+			const float (&hiddenWeights)[OUT][OUT], float (&outputs)[OUT])
+		{
+			for (uint32_t n = 0; n < OUT; n++)
+				outputs[n] = biases[n];
+			AddWeighted(input, weights, outputs);
+			AddWeighted(hiddenInput, hiddenWeights, outputs);
+			for (uint32_t n = 0; n < OUT; n++)
+				outputs[n] = Activate(outputs[n]);
+		}
+	}
+
+	//layer 0: dense, 12 inputs, 16 outputs
+	inline constexpr float LAYER0_BIASES[1][16] = {
+		{ -1.92773438f, 1.81445312f, 1.6484375f, 1.48242188f, 1.31640625f, 1.15039062f, 0.984375f, 0.818359375f, 0.65234375f, 0.486328125f, 0.3203125f, 0.154296875f, -0.01171875f, -0.177734375f, -0.34375f, -0.509765625f }
+	};
+	inline constexpr float LAYER0_WEIGHTS[1][12][16] = {
+	{
+		{ -0.67578125f, -0.841796875f, -1.0078125f, -1.17382812f, -1.33984375f, -1.50585938f, -1.671875f, -1.83789062f, 1.90429688f, 1.73828125f, 1.57226562f, 1.40625f, 1.24023438f, 1.07421875f, 0.908203125f, 0.7421875f },
+		{ 0.576171875f, 0.41015625f, 0.244140625f, 0.078125f, -0.087890625f, -0.25390625f, -0.419921875f, -0.5859375f, -0.751953125f, -0.91796875f, -1.08398438f, -1.25f, -1.41601562f, -1.58203125f, -1.74804688f, -1.9140625f },
+		{ 1.828125f, 1.66210938f, 1.49609375f, 1.33007812f, 1.1640625f, 0.998046875f, 0.83203125f, 0.666015625f, 0.5f, 0.333984375f, 0.16796875f, 0.001953125f, -0.1640625f, -0.330078125f, -0.49609375f, -0.662109375f },
+		{ -0.828125f, -0.994140625f, -1.16015625f, -1.32617188f, -1.4921875f, -1.65820312f, -1.82421875f, 1.91796875f, 1.75195312f, 1.5859375f, 1.41992188f, 1.25390625f, 1.08789062f, 0.921875f, 0.755859375f, 0.58984375f },
+		{ 0.423828125f, 0.2578125f, 0.091796875f, -0.07421875f, -0.240234375f, -0.40625f, -0.572265625f, -0.73828125f, -0.904296875f, -1.0703125f, -1.23632812f, -1.40234375f, -1.56835938f, -1.734375f, -1.90039062f, 1.84179688f },
+		{ 1.67578125f, 1.50976562f, 1.34375f, 1.17773438f, 1.01171875f, 0.845703125f, 0.6796875f, 0.513671875f, 0.34765625f, 0.181640625f, 0.015625f, -0.150390625f, -0.31640625f, -0.482421875f, -0.6484375f, -0.814453125f },
+		{ -0.98046875f, -1.14648438f, -1.3125f, -1.47851562f, -1.64453125f, -1.81054688f, 1.93164062f, 1.765625f, 1.59960938f, 1.43359375f, 1.26757812f, 1.1015625f, 0.935546875f, 0.76953125f, 0.603515625f, 0.4375f },
+		{ 0.271484375f, 0.10546875f, -0.060546875f, -0.2265625f, -0.392578125f, -0.55859375f, -0.724609375f, -0.890625f, -1.05664062f, -1.22265625f, -1.38867188f, -1.5546875f, -1.72070312f, -1.88671875f, 1.85546875f, 1.68945312f },
+		{ 1.5234375f, 1.35742188f, 1.19140625f, 1.02539062f, 0.859375f, 0.693359375f, 0.52734375f, 0.361328125f, 0.1953125f, 0.029296875f, -0.13671875f, -0.302734375f, -0.46875f, -0.634765625f, -0.80078125f, -0.966796875f },
+		{ -1.1328125f, -1.29882812f, -1.46484375f, -1.63085938f, -1.796875f, 1.9453125f, 1.77929688f, 1.61328125f, 1.44726562f, 1.28125f, 1.11523438f, 0.94921875f, 0.783203125f, 0.6171875f, 0.451171875f, 0.28515625f },
+		{ 0.119140625f, -0.046875f, -0.212890625f, -0.37890625f, -0.544921875f, -0.7109375f, -0.876953125f, -1.04296875f, -1.20898438f, -1.375f, -1.54101562f, -1.70703125f, -1.87304688f, 1.86914062f, 1.703125f, 1.53710938f },
+		{ 1.37109375f, 1.20507812f, 1.0390625f, 0.873046875f, 0.70703125f, 0.541015625f, 0.375f, 0.208984375f, 0.04296875f, -0.123046875f, -0.2890625f, -0.455078125f, -0.62109375f, -0.787109375f, -0.953125f, -1.11914062f }
+	}
+	};
+
+	//layer 1: dense, 16 inputs, 10 outputs
+	inline constexpr float LAYER1_BIASES[1][10] = {
+		{ -1.28515625f, -1.45117188f, -1.6171875f, -1.78320312f, -1.94921875f, 1.79296875f, 1.62695312f, 1.4609375f, 1.29492188f, 1.12890625f }
+	};
+	inline constexpr float LAYER1_WEIGHTS[1][16][10] = {
+	{
+		{ 0.962890625f, 0.796875f, 0.630859375f, 0.46484375f, 0.298828125f, 0.1328125f, -0.033203125f, -0.19921875f, -0.365234375f, -0.53125f },
+		{ -0.697265625f, -0.86328125f, -1.02929688f, -1.1953125f, -1.36132812f, -1.52734375f, -1.69335938f, -1.859375f, 1.8828125f, 1.71679688f },
+		{ 1.55078125f, 1.38476562f, 1.21875f, 1.05273438f, 0.88671875f, 0.720703125f, 0.5546875f, 0.388671875f, 0.22265625f, 0.056640625f },
+		{ -0.109375f, -0.275390625f, -0.44140625f, -0.607421875f, -0.7734375f, -0.939453125f, -1.10546875f, -1.27148438f, -1.4375f, -1.60351562f },
+		{ -1.76953125f, -1.93554688f, 1.80664062f, 1.640625f, 1.47460938f, 1.30859375f, 1.14257812f, 0.9765625f, 0.810546875f, 0.64453125f },
+		{ 0.478515625f, 0.3125f, 0.146484375f, -0.01953125f, -0.185546875f, -0.3515625f, -0.517578125f, -0.68359375f, -0.849609375f, -1.015625f },
+		{ -1.18164062f, -1.34765625f, -1.51367188f, -1.6796875f, -1.84570312f, 1.89648438f, 1.73046875f, 1.56445312f, 1.3984375f, 1.23242188f },
+		{ 1.06640625f, 0.900390625f, 0.734375f, 0.568359375f, 0.40234375f, 0.236328125f, 0.0703125f, -0.095703125f, -0.26171875f, -0.427734375f },
+		{ -0.59375f, -0.759765625f, -0.92578125f, -1.09179688f, -1.2578125f, -1.42382812f, -1.58984375f, -1.75585938f, -1.921875f, 1.8203125f },
+		{ 1.65429688f, 1.48828125f, 1.32226562f, 1.15625f, 0.990234375f, 0.82421875f, 0.658203125f, 0.4921875f, 0.326171875f, 0.16015625f },
+		{ -0.005859375f, -0.171875f, -0.337890625f, -0.50390625f, -0.669921875f, -0.8359375f, -1.00195312f, -1.16796875f, -1.33398438f, -1.5f },
+		{ -1.66601562f, -1.83203125f, 1.91015625f, 1.74414062f, 1.578125f, 1.41210938f, 1.24609375f, 1.08007812f, 0.9140625f, 0.748046875f },
+		{ 0.58203125f, 0.416015625f, 0.25f, 0.083984375f, -0.08203125f, -0.248046875f, -0.4140625f, -0.580078125f, -0.74609375f, -0.912109375f },
+		{ -1.078125f, -1.24414062f, -1.41015625f, -1.57617188f, -1.7421875f, -1.90820312f, 1.83398438f, 1.66796875f, 1.50195312f, 1.3359375f },
+		{ 1.16992188f, 1.00390625f, 0.837890625f, 0.671875f, 0.505859375f, 0.33984375f, 0.173828125f, 0.0078125f, -0.158203125f, -0.32421875f },
+		{ -0.490234375f, -0.65625f, -0.822265625f, -0.98828125f, -1.15429688f, -1.3203125f, -1.48632812f, -1.65234375f, -1.81835938f, 1.92382812f }
+	}
+	};
+
+	//layer 2: dense, 10 inputs, 4 outputs
+	inline constexpr float LAYER2_BIASES[1][4] = {
+		{ 1.7578125f, 1.59179688f, 1.42578125f, 1.25976562f }
+	};
+	inline constexpr float LAYER2_WEIGHTS[1][10][4] = {
+	{
+		{ 1.09375f, 0.927734375f, 0.76171875f, 0.595703125f },
+		{ 0.4296875f, 0.263671875f, 0.09765625f, -0.068359375f },
+		{ -0.234375f, -0.400390625f, -0.56640625f, -0.732421875f },
+		{ -0.8984375f, -1.06445312f, -1.23046875f, -1.39648438f },
+		{ -1.5625f, -1.72851562f, -1.89453125f, 1.84765625f },
+		{ 1.68164062f, 1.515625f, 1.34960938f, 1.18359375f },
+		{ 1.01757812f, 0.8515625f, 0.685546875f, 0.51953125f },
+		{ 0.353515625f, 0.1875f, 0.021484375f, -0.14453125f },
+		{ -0.310546875f, -0.4765625f, -0.642578125f, -0.80859375f },
+		{ -0.974609375f, -1.140625f, -1.30664062f, -1.47265625f }
+	}
+	};
+
+	// input: INPUT_COUNT floats
+	// output: OUTPUT_COUNT floats that the output activations (values between 0 and 1) are written into
+	inline void Evaluate(const float* input, float* output)
+	{
+		float layer0[16];
+		detail::Dense(input, LAYER0_BIASES[0], LAYER0_WEIGHTS[0], layer0);
+		float layer1[10];
+		detail::Dense(layer0, LAYER1_BIASES[0], LAYER1_WEIGHTS[0], layer1);
+		float layer2[4];
+		detail::Dense(layer1, LAYER2_BIASES[0], LAYER2_WEIGHTS[0], layer2);
+		for (uint32_t n = 0; n < OUTPUT_COUNT; n++)
+			output[n] = layer2[n];
+	}
+}
@@ -0,0 +1,176 @@
+#pragma once
+//generated by nlv from a network with 5 inputs and layers of 6 (gru) 3 (elman) 2 (dense)
+#include <cmath>
+#include <cstdint>
+
+namespace recurrent_check
+{
+	constexpr uint32_t INPUT_COUNT = 5;
+	constexpr uint32_t OUTPUT_COUNT = 2;
+	//the number of floats of hidden state recurrent layers keep between evaluations
+	constexpr uint32_t STATE_COUNT = 9;
+
+	namespace detail
+	{
+		inline float Activate(float weightedInput)
+		{
+			return 1.0f / (1 + std::exp(weightedInput));
+		}
+
+		//adds input * weights into sums
+		template<uint32_t IN, uint32_t OUT>
+		inline void AddWeighted(const float* input, const float (&weights)[IN][OUT], float (&sums)[OUT])
+		{
+			for (uint32_t i = 0; i < IN; i++)
+				for (uint32_t n = 0; n < OUT; n++)
+					sums[n] += input[i] * weights[i][n];
+		}
+
+		//outputs = Activate(biases + input * weights)
+		template<uint32_t IN, uint32_t OUT>
+		inline void Dense(const float* input, const float (&biases)[OUT], const float (&weights)[IN][OUT], float (&outputs)[OUT])
+		{
+			for (uint32_t n = 0; n < OUT; n++)
+				outputs[n] = biases[n];
+			AddWeighted(input, weights, outputs);
+			for (uint32_t n = 0; n < OUT; n++)
+				outputs[n] = Activate(outputs[n]);
+		}
+
+		//outputs = Activate(biases + input * weights + hiddenInput * hiddenWeights), a gate of a recurrent layer
+		template<uint32_t IN, uint32_t OUT>
+		inline void Gate(const float* input, const float* hiddenInput, const float (&biases)[OUT], const float (&weights)[IN][OUT],
+			const float (&hiddenWeights)[OUT][OUT], float (&outputs)[OUT])
+		{
+			for (uint32_t n = 0; n < OUT; n++)
+				outputs[n] = biases[n];
+			AddWeighted(input, weights, outputs);
+			AddWeighted(hiddenInput, hiddenWeights, outputs);
+			for (uint32_t n = 0; n < OUT; n++)
+				outputs[n] = Activate(outputs[n]);
+		}
+	}
+
+	//layer 0: gru, 5 inputs, 6 outputs (update, reset and candidate gates)
+	inline constexpr float LAYER0_BIASES[3][6] = {
+		{ -1.9296875f, 1.8125f, 1.6484375f, 1.484375f, 1.3125f, 1.1484375f },
+		{ 1.75f, 1.5859375f, 1.421875f, 1.25f, 1.0859375f, 0.921875f },
+		{ 1.5234375f, 1.359375f, 1.1875f, 1.0234375f, 0.859375f, 0.6953125f }
+	};
+	inline constexpr float LAYER0_WEIGHTS[3][5][6] = {
+	{
+		{ 0.984375f, 0.8203125f, 0.65234375f, 0.486328125f, 0.3203125f, 0.154296875f },
+		{ -0.01171875f, 0.0f, -0.34375f, -0.5078125f, -0.67578125f, -0.84375f },
+		{ -1.0078125f, -1.171875f, -1.34375f, -1.5078125f, -1.671875f, -1.8359375f },
+		{ 1.90625f, 1.734375f, 1.5703125f, 1.40625f, 1.2421875f, 1.078125f },
+		{ 0.90625f, 0.7421875f, 0.578125f, 0.41015625f, 0.244140625f, 0.078125f }
+	},
+	{
+		{ 0.7578125f, 0.58984375f, 0.423828125f, 0.2578125f, 0.091796875f, -0.07421875f },
+		{ -0.240234375f, -0.40625f, -0.5703125f, -0.73828125f, -0.90625f, -1.0703125f },
+		{ -1.234375f, -1.40625f, -1.5703125f, -1.734375f, -1.8984375f, 1.84375f },
+		{ 1.671875f, 1.5078125f, 1.34375f, 1.1796875f, 1.015625f, 0.84375f },
+		{ 0.6796875f, 0.515625f, 0.34765625f, 0.181640625f, 0.015625f, -0.150390625f }
+	},
+	{
+		{ 0.52734375f, 0.361328125f, 0.1953125f, 0.029296875f, -0.13671875f, -0.302734375f },
+		{ -0.46875f, -0.6328125f, -0.80078125f, -0.96875f, -1.1328125f, -1.296875f },
+		{ -1.46875f, -1.6328125f, -1.796875f, 1.9453125f, 1.78125f, 1.609375f },
+		{ 1.4453125f, 1.28125f, 1.1171875f, 0.94921875f, 0.78125f, 0.6171875f },
+		{ 0.451171875f, 0.28515625f, 0.119140625f, -0.046875f, -0.212890625f, -0.37890625f }
+	}
+	};
+	inline constexpr float LAYER0_HIDDEN_WEIGHTS[3][6][6] = {
+	{
+		{ -0.087890625f, -0.25390625f, -0.419921875f, -0.5859375f, -0.75f, -0.91796875f },
+		{ -1.0859375f, -1.25f, -1.4140625f, -1.578125f, -1.75f, -1.9140625f },
+		{ 1.828125f, 1.6640625f, 1.5f, 1.328125f, 1.1640625f, 1.0f },
+		{ 0.83203125f, 0.6640625f, 0.5f, 0.333984375f, 0.16796875f, 0.001953125f },
+		{ -0.1640625f, -0.330078125f, -0.49609375f, -0.6640625f, -0.828125f, -0.9921875f },
+		{ -1.15625f, -1.328125f, -1.4921875f, -1.65625f, -1.828125f, 1.921875f }
+	},
+	{
+		{ -0.31640625f, -0.482421875f, -0.6484375f, -0.8125f, -0.98046875f, -1.1484375f },
+		{ -1.3125f, -1.4765625f, -1.640625f, -1.8125f, 1.9296875f, 1.765625f },
+		{ 1.6015625f, 1.4375f, 1.265625f, 1.1015625f, 0.9375f, 0.76953125f },
+		{ 0.6015625f, 0.4375f, 0.271484375f, 0.10546875f, -0.060546875f, -0.2265625f },
+		{ -0.392578125f, -0.55859375f, -0.7265625f, -0.890625f, -1.0546875f, -1.21875f },
+		{ -1.390625f, -1.5546875f, -1.71875f, -1.890625f, 1.859375f, 1.6875f }
+	},
+	{
+		{ -0.546875f, -0.7109375f, -0.875f, -1.046875f, -1.2109375f, -1.375f },
+		{ -1.5390625f, -1.703125f, -1.875f, 1.8671875f, 1.703125f, 1.5390625f },
+		{ 1.375f, 1.203125f, 1.0390625f, 0.875f, 0.70703125f, 0.5390625f },
+		{ 0.375f, 0.208984375f, 0.04296875f, -0.123046875f, -0.2890625f, -0.455078125f },
+		{ -0.62109375f, -0.7890625f, -0.953125f, -1.1171875f, -1.28125f, -1.453125f },
+		{ -1.6171875f, -1.78125f, -1.953125f, 1.796875f, 1.625f, 1.4609375f }
+	}
+	};
+
+	//layer 1: elman, 6 inputs, 3 outputs
+	inline constexpr float LAYER1_BIASES[1][3] = {
+		{ 1.296875f, 1.125f, 0.9609375f }
+	};
+	inline constexpr float LAYER1_WEIGHTS[1][6][3] = {
+	{
+		{ 0.796875f, 0.6328125f, 0.46484375f },
+		{ 0.298828125f, 0.1328125f, -0.033203125f },
+		{ -0.19921875f, -0.365234375f, -0.53125f },
+		{ -0.6953125f, -0.86328125f, -1.03125f },
+		{ -1.1953125f, -1.359375f, 0.0f },
+		{ -1.6953125f, -1.859375f, 1.8828125f }
+	}
+	};
+	inline constexpr float LAYER1_HIDDEN_WEIGHTS[1][3][3] = {
+	{
+		{ 1.71875f, 1.546875f, 1.3828125f },
+		{ 1.21875f, 1.0546875f, 0.88671875f },
+		{ 0.71875f, 0.5546875f, 0.388671875f }
+	}
+	};
+
+	//layer 2: dense, 3 inputs, 2 outputs
+	inline constexpr float LAYER2_BIASES[1][2] = {
+		{ 0.22265625f, 0.056640625f }
+	};
+	inline constexpr float LAYER2_WEIGHTS[1][3][2] = {
+	{
+		{ -0.109375f, -0.275390625f },
+		{ -0.44140625f, -0.609375f },
+		{ -0.7734375f, -0.9375f }
+	}
+	};
+
+	// input: INPUT_COUNT floats
+	// output: OUTPUT_COUNT floats that the output activations (values between 0 and 1) are written into
+	// state: STATE_COUNT floats of hidden state that is read and updated (start it at 0s)
+	inline void Evaluate(const float* input, float* output, float* state)
+	{
+		float layer0[6];
+		{
+			float* hidden = state + 0;
+			float update[6];
+			float resetHidden[6];
+			detail::Gate(input, hidden, LAYER0_BIASES[0], LAYER0_WEIGHTS[0], LAYER0_HIDDEN_WEIGHTS[0], update);
+			detail::Gate(input, hidden, LAYER0_BIASES[1], LAYER0_WEIGHTS[1], LAYER0_HIDDEN_WEIGHTS[1], resetHidden);
+			for (uint32_t n = 0; n < 6; n++)
+				resetHidden[n] *= hidden[n];
+			detail::Gate(input, resetHidden, LAYER0_BIASES[2], LAYER0_WEIGHTS[2], LAYER0_HIDDEN_WEIGHTS[2], layer0);
+			for (uint32_t n = 0; n < 6; n++)
+				layer0[n] = (1 - update[n]) * hidden[n] + update[n] * layer0[n];
+			for (uint32_t n = 0; n < 6; n++)
+				hidden[n] = layer0[n];
+		}
+		float layer1[3];
+		{
+			float* hidden = state + 6;
+			detail::Gate(layer0, hidden, LAYER1_BIASES[0], LAYER1_WEIGHTS[0], LAYER1_HIDDEN_WEIGHTS[0], layer1);
+			for (uint32_t n = 0; n < 3; n++)
+				hidden[n] = layer1[n];
+		}
+		float layer2[2];
+		detail::Dense(layer1, LAYER2_BIASES[0], LAYER2_WEIGHTS[0], layer2);
+		for (uint32_t n = 0; n < OUTPUT_COUNT; n++)
+			output[n] = layer2[n];
+	}
+}
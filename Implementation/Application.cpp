@@ -57,15 +57,15 @@ Application::~Application()
 	ClearEvolver();
 	if (gameSystem)
 	{
+		//the datapack has to be deleted by the system that made it
+		if (currentSolution.dataPack)
+		{
+			gameSystem->DeleteDataPack(currentSolution.dataPack);
+			currentSolution.dataPack = nullptr;
+		}
 		delete gameSystem;
 		gameSystem = nullptr;
 	}
-	
-	if (currentSolution.dataPack)
-	{
-		delete currentSolution.dataPack;
-		currentSolution.dataPack = nullptr;
-	}
 	renderer.UnSetup();
 }
 
@@ -76,7 +76,7 @@ void Application::RunGeneration()
 		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
 		gameSystem->OnStartEndGeneration(true);
 		evolverIsRunning = true;
-		evolver.EvaluateGeneration();
+		EvaluateGeneration();
 		evolverIsRunning = false;
 		gameSystem->OnStartEndGeneration(false);
 
@@ -101,7 +101,7 @@ void Application::RunGenerations()
 	{
 		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
 
-		evolver.EvaluateGeneration();
+		EvaluateGeneration();
 
 		std::chrono::high_resolution_clock::time_point e = std::chrono::high_resolution_clock::now();
 		timeToComplete = (float)std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
@@ -141,7 +141,7 @@ void Application::DrawEvolverWindow()
 	ImGui::InputScalarN("Nodes per layer", ImGuiDataType_S32, nodesPerLayer.data(), hiddenLayers);
 
 	ImGui::Text("Output nodes: %i", gameSystem->GetOutputCount());
-	ImGui::SliderInt("Population", &populationSize, 100, 5000, "%d", ImGuiSliderFlags_Logarithmic);
+	ImGui::SliderInt("Replicas", &replicaCount, 1, 16);
 	ImGui::Spacing();
 
 	if (ImGui::Button("Reset to default"))
@@ -149,15 +149,20 @@ void Application::DrawEvolverWindow()
 		hiddenLayers = 1;
 		nodesPerLayer = { gameSystem->GetDefaultHiddenNodes()};
 		populationSize = DEFAULT_POPULATION;
+		adaptivePopulation = DEFAULT_ADAPTIVE_POPULATION;
 		maxTime = DEFAULT_MAX_TIME;
 		maxSteps = DEFAULT_MAX_TIME / TIME_STEP;
 		elitePercent = DEFAULT_ELITE;
 		multithread = DEFAULT_THREADED;
 		staticEpisodes = DEFAULT_STATIC;
+		quantizedInference = DEFAULT_QUANTIZED;
 		mutationType = 0;
 		crossoverType = 0;
 		selectionType = 0;
 		mutationRate = DEFAULT_MUTATION_RATE;
+		replicaCount = DEFAULT_REPLICAS;
+		fitnessReduction = 0;
+		fitnessPercentile = 0.5f;
 
 		ClearEvolver();
 		ConfigureEvolver();
@@ -220,6 +225,21 @@ void Application::DrawEvolverWindow()
 			evolver.SetIsThreadedEpisodes(multithread);
 		if (ImGui::Checkbox("Constant seed", &staticEpisodes))
 			evolver.SetStaticEpisodes(staticEpisodes);
+		if (ImGui::Checkbox("Quantized inference", &quantizedInference))
+			evolver.SetQuantizedInference(quantizedInference);
+		if (ImGui::Checkbox("Packed inference", &packedInference))
+			evolver.SetPackedInference(packedInference);
+
+		//(population size changes take effect next generation)
+		if (ImGui::SliderInt("Population", &populationSize, 100, 5000, "%d", ImGuiSliderFlags_Logarithmic))
+			evolver.SetPopulationSize(populationSize);
+		if (ImGui::Checkbox("Adaptive population", &adaptivePopulation))
+		{
+			if (adaptivePopulation)
+				evolver.SetAdaptivePopulation(ADAPTIVE_MIN_POPULATION, ADAPTIVE_MAX_POPULATION);
+			else
+				evolver.ClearAdaptivePopulation();
+		}
 
 		if (ImGui::SliderFloat("Max time", &maxTime, 10, 180, "%0.2f"))
 		{
@@ -241,6 +261,15 @@ void Application::DrawEvolverWindow()
 		//Selection
 		if (ImGui::Combo("Selection Type", &selectionType, "Proportional\0Ranked\0\0"))
 			evolver.SetSelectionType((EvolverSelectionType)selectionType);
+		//Replicas
+		if (replicaCount > 1)
+		{
+			if (ImGui::Combo("Replica Fitness", &fitnessReduction, "Mean\0Min\0Percentile\0\0"))
+				evolver.SetFitnessReduction((EvolverFitnessReduction)fitnessReduction, fitnessPercentile);
+			if ((EvolverFitnessReduction)fitnessReduction == EvolverFitnessReduction::Percentile 
+				&& ImGui::SliderFloat("Percentile", &fitnessPercentile, 0, 1, "%0.2f"))
+				evolver.SetFitnessReduction((EvolverFitnessReduction)fitnessReduction, fitnessPercentile);
+		}
 
 	}
 	if (disabledWhileRunning)
@@ -294,8 +323,15 @@ void Application::DrawDataWindow()
 	if (disableRunning)
 		ImGui::EndDisabled();
 
-	ImGui::ProgressBar(progress);
+	//(the evolver counts finished organisms itself, so this can be read while it runs)
+	ImGui::ProgressBar(evolverIsSetup ? evolver.GetProgress() : 0.0f);
 	ImGui::Text("Completion Time: %0.2f", timeToComplete);
+	if (evolverIsSetup && evolver.GetPopulationStatsCount() > 0)
+	{
+		const EvolverPopulationStats& stats = evolver.GetPopulationStats();
+		ImGui::Text("Median Fitness: %0.2f  Diversity: %0.3f  Ended Early: %0.0f%%", stats.fitnessQuantiles[2], stats.diversity, stats.earlyTerminationRate * 100);
+		ImGui::Text("Population: %u", stats.populationSize);
+	}
 
 	ImGui::Separator();
 	
@@ -338,18 +374,7 @@ void Application::DrawPlayWindow()
 	ImGui::SameLine();
 	if (ImGui::Button("Best"))
 	{
-		const NetworkOrganism* organisms = evolver.GetPopulationArray();
-		float fitness = organisms[0].fitness;
-		int orgIndex = 0;
-		for (size_t i = 1; i < evolver.GetPopulationSize(); i++)
-		{
-			if (organisms[i].fitness > fitness)
-			{
-				fitness = organisms[i].fitness;
-				orgIndex = i;
-			}
-		}
-		SetCurrentSolution(orgIndex);
+		SetCurrentSolution(evolver.GetPopulationStatsCount() > 0 ? evolver.GetPopulationStats().bestIndex : 0);
 	}
 	ImGui::SameLine();
 	if (ImGui::Button("Choose"))
@@ -358,22 +383,24 @@ void Application::DrawPlayWindow()
 	}
 	if (ImGui::BeginPopup("Choose Index"))
 	{
-		auto pop = evolver.GetPopulationArray();
+		//the snapshot can't change under the popup
+		auto snapshot = evolver.GetSnapshot();
 		float width = 500;
 		ImVec2 size = ImVec2(50, 25);
 		int xSize = width / size.x;
 		
-		for (int i = 0; i < evolver.GetPopulationSize(); i++)
+		int count = snapshot ? (int)snapshot->fitness.size() : 0;
+		for (int i = 0; i < count; i++)
 		{
-			for (int x = 0; x < xSize && i < evolver.GetPopulationSize(); x++, i++)
+			for (int x = 0; x < xSize && i < count; x++, i++)
 			{
 				if (x > 0)
 					ImGui::SameLine();
 				ImGui::PushID(i);
 
-				auto formatted = std::format("{:.1f}\n", pop[i].GetFitness());
+				auto formatted = std::format("{:.1f}\n", snapshot->fitness[i]);
 
-				float success = (pop[i].GetFitness() - minEver)/ (maxEver - minEver);
+				float success = (snapshot->fitness[i] - minEver)/ (maxEver - minEver);
 				ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1 - success, success, 0, 1.0f));
 				if (ImGui::Selectable(formatted.c_str(), false, 0, size))
 				{
@@ -462,17 +489,11 @@ void Application::DrawGame()
 
 void Application::GetEvolverValues()
 {
-	float average = 0;
-	float min = 10000000000.0f;
-	float max = -10000000000.0f;
-	const NetworkOrganism* organisms = evolver.GetPopulationArray();
-	for (int i = 0; i < evolver.GetPopulationSize(); i++)
-	{
-		average += organisms[i].fitness;
-		min = std::min(organisms[i].fitness, min);
-		max = std::max(organisms[i].fitness, max);
-	}
-	average /= evolver.GetPopulationSize();
+	//the evolver already summarized the population
+	const EvolverPopulationStats& stats = evolver.GetPopulationStats();
+	float average = stats.meanFitness;
+	float min = stats.minFitness;
+	float max = stats.maxFitness;
 
 	averages.push_back(average);
 	maximums.push_back(max);
@@ -488,46 +509,114 @@ void Application::OnStartGeneration(const NetworkEvolver& evolver, NetworkOrgani
 	//only set the default system once if static
 	if (!ptr->staticEpisodes || evolver.GetGeneration() == 0)
 		ptr->SetupDefaultSystem();
-	auto* ts = ptr->gameSystem->GetDefaultDataPack();
-	
-	for (size_t i = 0; i < evolver.GetPopulationSize(); i++)
+
+	//the population size can change between generations, the game system needs a datapack for every organism
+	int size = evolver.GetPopulationSize();
+	if (size != ptr->systemPopulationSize)
 	{
-		ptr->gameSystem->CopyDataPack(ptr->dataPacks[i], ts);
-		ptr->gameSystem->SetNetworkInputs(ptr->dataPacks[i], organisms[i].GetNetworkInputArray());
+		if (evolver.GetBatchStepCallback())
+			ptr->gameSystem->SetupBatch(size);
+		else
+			ptr->gameSystem->SetupDataPacks(size);
+		ptr->systemPopulationSize = size;
 	}
-
-	ptr->progress = 0;
+	
+	if (evolver.GetBatchStepCallback())
+		ptr->gameSystem->ResetBatch(organisms, evolver.GetPopulationSize());
+	//with replicas every organism's datapack is reset before each replica instead
+	else if (evolver.GetReplicaCount() <= 1)
+		ptr->gameSystem->ResetDataPacks(organisms, evolver.GetPopulationSize());
 }
 
-void Application::OnEndGeneration(const NetworkEvolver& evolver, NetworkOrganism* organisms)
+template<typename System>
+void Application::StepFunction(const NetworkEvolver& evolver, NetworkOrganism& organism, int organismIndex)
 {
 	Application* ptr = (Application*)evolver.GetUserPointer();
-	ptr->progress = 1;
+	//the game system always matches the game type this was picked for (see GetStepFunction)
+	System* system = static_cast<System*>(ptr->gameSystem);
+	system->StepOrganismAt(organismIndex, organism.GetNetworkOutputActivations(), organism.fitness, organism.continueStepping, organism.GetNetworkInputArray());
 }
 
-void Application::StepFunction(const NetworkEvolver& evolver, NetworkOrganism& organism, int organismIndex)
+void Application::ReplicaFunction(const NetworkEvolver& evolver, NetworkOrganism& organism, int organismIndex, uint32_t replicaIndex)
 {
 	Application* ptr = (Application*)evolver.GetUserPointer();
-	ptr->gameSystem->StepOrganism(ptr->dataPacks[organismIndex], organism.GetNetworkOutputActivations(), organism.fitness, organism.continueStepping);
-	ptr->gameSystem->SetNetworkInputs(ptr->dataPacks[organismIndex], organism.GetNetworkInputArray());
+	ptr->gameSystem->ResetDataPack(organism, organismIndex, replicaIndex);
+}
+
+EvolverStepCallback Application::GetStepFunction() const
+{
+	switch (gameType)
+	{
+	case Application::GameType::SNAKE:
+		return StepFunction<SnakeSystem>;
+	case Application::GameType::POLE_BALANCER:
+		return StepFunction<BalancerSystem>;
+	case Application::GameType::FLAPPY_BIRD:
+		return StepFunction<FlappyBirdSystem>;
+	case Application::GameType::RACER:
+		return StepFunction<RacerSystem>;
+	default:
+		throw std::runtime_error("No game system set");
+	}
+}
 
-	if (organism.GetStepsTaken() >= evolver.GetMaxSteps() - 1 || !organism.continueStepping)
+void Application::EvaluateGeneration()
+{
+	//batched systems are stepped through the batch step callback
+	if (evolver.GetBatchStepCallback())
 	{
-		//r-r-r-race condition!
-		//but this is just a progress bar sooo whatever it dont matter
-		ptr->progress += 1.0f / ptr->populationSize;
+		evolver.EvaluateGeneration();
+		return;
+	}
+
+	switch (gameType)
+	{
+	case Application::GameType::SNAKE:
+		EvaluateSystemGeneration<SnakeSystem>();
+		break;
+	case Application::GameType::POLE_BALANCER:
+		EvaluateSystemGeneration<BalancerSystem>();
+		break;
+	case Application::GameType::FLAPPY_BIRD:
+		EvaluateSystemGeneration<FlappyBirdSystem>();
+		break;
+	case Application::GameType::RACER:
+		EvaluateSystemGeneration<RacerSystem>();
+		break;
+	default:
+		evolver.EvaluateGeneration();
+		break;
 	}
 }
 
+template<typename System>
+void Application::EvaluateSystemGeneration()
+{
+	//StepFunction is called directly here instead of through a function pointer, so it can be inlined
+	evolver.EvaluateGeneration([this](NetworkOrganism& organism, uint32_t organismIndex) { StepFunction<System>(evolver, organism, organismIndex); });
+}
+
+void Application::BatchStepFunction(const NetworkEvolver& evolver, NetworkOrganism* organisms, uint32_t startIndex, uint32_t endIndex)
+{
+	Application* ptr = (Application*)evolver.GetUserPointer();
+	ptr->gameSystem->StepOrganismBatch(organisms, startIndex, endIndex, evolver.GetMaxSteps());
+}
+
 void Application::SetupDefaultSystem()
 {
-	gameSystem->SetDefaultDataPack(random);
+	//every replica gets its own default datapack (the last one is left as the default datapack)
+	if (replicaCount > 1)
+		gameSystem->SetupReplicas(random, replicaCount);
+	else
+		gameSystem->SetDefaultDataPack(random);
 }
 
 void Application::SetCurrentSolution(int organismIndex)
 {
 	const NetworkOrganism& org = evolver.GetPopulationArray()[organismIndex];
 	currentSolution.network = org.GetNetwork();
+	currentSolution.scratch.resize(currentSolution.network.GetScratchSize());
+	currentSolution.hiddenState.assign(currentSolution.network.GetStateCount(), 0.0f);
 	gameSystem->CopyDataPack(currentSolution.dataPack, gameSystem->GetDefaultDataPack());
 	currentSolution.fitness = 0;
 	currentSolution.steps = 0;
@@ -580,8 +669,9 @@ void Application::RunCurrentSolution()
 
 			if (currentSolution.isAI)
 			{
-				currentSolution.network.Evaluate(currentSolution.inputs.data(), gameSystem->GetInputCount());
-				gameSystem->StepOrganism(currentSolution.dataPack, currentSolution.network.GetPreviousActivations(), currentSolution.fitness, currentSolution.running);
+				const nlv::Network& network = currentSolution.network;
+				const float* outputs = network.Evaluate(currentSolution.inputs.data(), gameSystem->GetInputCount(), currentSolution.scratch.data(), currentSolution.hiddenState.data());
+				gameSystem->StepOrganism(currentSolution.dataPack, outputs, currentSolution.fitness, currentSolution.running);
 				gameSystem->SetNetworkInputs(currentSolution.dataPack, currentSolution.inputs.data());
 
 				currentSolution.steps++;
@@ -605,20 +695,29 @@ void Application::RunCurrentSolution()
 void Application::ConfigureEvolver()
 {
 	Network network(gameSystem->GetInputCount(), nodesPerLayer, gameSystem->GetOutputCount());
-	NetworkEvolverBuilder def = NetworkEvolverBuilder(network, StepFunction, populationSize, maxSteps, seed)
+	NetworkEvolverBuilder def = NetworkEvolverBuilder(network, GetStepFunction(), populationSize, maxSteps, seed)
 		.SetMutation((EvolverMutationType)mutationType, mutationRate, 1.0f)
 		.SetCrossover((EvolverCrossoverType)crossoverType)
 		.SetSelection((EvolverSelectionType)selectionType)
-		.SetCallbacks(OnStartGeneration, OnEndGeneration)
+		.SetCallbacks(OnStartGeneration, nullptr)
 		.SetElitePercent(elitePercent)
-		.SetEpisodeParameters(staticEpisodes, multithread, THREAD_COUNT);
-	evolver = def.Build();
-	dataPacks = new GameSystem::DataPack*[populationSize];
-	
-	for (size_t i = 0; i < populationSize; i++)
+		.SetEpisodeParameters(staticEpisodes, multithread, THREAD_COUNT)
+		.SetQuantizedInference(quantizedInference)
+		.SetPackedInference(packedInference)
+		.SetPopulationStats(1)
+		.SetReplicas(replicaCount, ReplicaFunction, (EvolverFitnessReduction)fitnessReduction, fitnessPercentile);
+	//systems that can step many organisms at once are stepped in batches (batches step every organism in lockstep, so they don't work with replicas)
+	if (gameSystem->GetSupportsBatchStepping() && replicaCount <= 1)
 	{
-		dataPacks[i] = gameSystem->NewDataPack();
+		gameSystem->SetupBatch(populationSize);
+		def.SetBatchStepCallback(BatchStepFunction);
 	}
+	else
+		gameSystem->SetupDataPacks(populationSize);
+	systemPopulationSize = populationSize;
+	if (adaptivePopulation)
+		def.SetAdaptivePopulation(ADAPTIVE_MIN_POPULATION, ADAPTIVE_MAX_POPULATION);
+	evolver = def.Build();
 	SetupDefaultSystem();
 	SetCurrentSolution(0);
 	evolver.SetUserPointer(this);
@@ -643,15 +742,6 @@ void Application::ClearEvolver()
 	maxEver = 0;
 	minEver = 0;
 	currentSolution.running = false;
-	if (dataPacks)
-	{
-		for (size_t i = 0; i < populationSize; i++)
-		{
-			delete dataPacks[i];
-		}
-		delete dataPacks;
-		dataPacks = nullptr;
-	}
 }
 
 void Application::SetGame(GameType type)
@@ -662,9 +752,11 @@ void Application::SetGame(GameType type)
 
 	gameType = type;
 	if (gameSystem)
+	{
+		if (currentSolution.dataPack)
+			gameSystem->DeleteDataPack(currentSolution.dataPack);
 		delete gameSystem;
-	if (currentSolution.dataPack)
-		delete currentSolution.dataPack;
+	}
 
 	switch (type)
 	{
@@ -26,11 +26,17 @@ constexpr int THREAD_COUNT = 10;
 
 constexpr int DEFAULT_HIDDEN_NODES = 6;
 constexpr int DEFAULT_POPULATION = 1000;
+constexpr bool DEFAULT_ADAPTIVE_POPULATION = false;
+constexpr int ADAPTIVE_MIN_POPULATION = 100;
+constexpr int ADAPTIVE_MAX_POPULATION = 5000;
 constexpr float DEFAULT_MAX_TIME = 60;
 constexpr float DEFAULT_ELITE = 0.05f;
 constexpr bool DEFAULT_THREADED = true;
 constexpr bool DEFAULT_STATIC = true;
+constexpr bool DEFAULT_QUANTIZED = false;
+constexpr bool DEFAULT_PACKED = false;
 constexpr float DEFAULT_MUTATION_RATE = 0.2f;
+constexpr int DEFAULT_REPLICAS = 1;
 
 class Application
 {
@@ -49,8 +55,17 @@ private:
 	void DrawGame();
 	void GetEvolverValues();
 	static void OnStartGeneration(const nlv::NetworkEvolver& evolver, nlv::NetworkOrganism* organisms);
-	static void OnEndGeneration(const nlv::NetworkEvolver& evolver, nlv::NetworkOrganism* organisms);
+	//templated on the game system so stepping an organism doesn't go through any virtual calls
+	template<typename System>
 	static void StepFunction(const nlv::NetworkEvolver& evolver, nlv::NetworkOrganism& organism, int organismIndex);
+	//returns the StepFunction for the current game type
+	nlv::EvolverStepCallback GetStepFunction() const;
+	//evaluates a generation, with StepFunction inlined into the evolver's episode loop when possible
+	void EvaluateGeneration();
+	template<typename System>
+	void EvaluateSystemGeneration();
+	static void ReplicaFunction(const nlv::NetworkEvolver& evolver, nlv::NetworkOrganism& organism, int organismIndex, uint32_t replicaIndex);
+	static void BatchStepFunction(const nlv::NetworkEvolver& evolver, nlv::NetworkOrganism* organisms, uint32_t startIndex, uint32_t endIndex);
 	void SetupDefaultSystem();
 	void SetCurrentSolution(int organismIndex);
 	void SetCurrentSolutionToPlayMode();
@@ -62,7 +77,6 @@ private:
 	nlv::NetworkEvolver evolver;
 	GameSystem* gameSystem = nullptr;
 	std::minstd_rand random;
-	GameSystem::DataPack** dataPacks = nullptr;
 	float deltaTime;		
 	std::chrono::high_resolution_clock::time_point lastTime;
 
@@ -82,17 +96,24 @@ private:
 	int hiddenLayers = 1;
 	std::vector<int> nodesPerLayer { 0 };
 	int populationSize = DEFAULT_POPULATION;
+	bool adaptivePopulation = DEFAULT_ADAPTIVE_POPULATION;
+	//the population size the game system's datapacks were set up for
+	int systemPopulationSize = 0;
 	float maxTime = DEFAULT_MAX_TIME;
 	int maxSteps = DEFAULT_MAX_TIME / TIME_STEP;
 	float elitePercent = DEFAULT_ELITE;
 	bool multithread = DEFAULT_THREADED;
 	bool staticEpisodes = DEFAULT_STATIC;
+	bool quantizedInference = DEFAULT_QUANTIZED;
+	bool packedInference = DEFAULT_PACKED;
 	float mutationRate = DEFAULT_MUTATION_RATE;
 	int mutationType = 0;
 	int selectionType = 0;
 	int crossoverType = 0;
+	int replicaCount = DEFAULT_REPLICAS;
+	int fitnessReduction = 0;
+	float fitnessPercentile = 0.5f;
 	float timeToComplete = 0;
-	float progress = 0;
 	bool evolverIsRunning = false;
 	bool runGenerations = false;
 	unsigned int seed = 0;
@@ -107,8 +128,12 @@ private:
 		int playSpeed = 0;
 		bool isAI = false;
 		unsigned int orgIndex = 0;
+		//a copy, since the evolver thread reuses the organism's network for the next generation while the preview plays
 		nlv::Network network;
-		GameSystem::DataPack* dataPack;
+		//the preview evaluates the const way, so its network is only read after it is copied
+		std::vector<float> scratch;
+		std::vector<float> hiddenState;
+		GameSystem::DataPack* dataPack = nullptr;
 		float fitness = 0;
 		float continueTimer = 0;
 		unsigned int steps = 0;
@@ -19,9 +19,8 @@ void BalancerSystem::SetDefaultDataPack(std::minstd_rand& random)
 	defaultDataPack.cartPosition = 0;
 }
 
-void BalancerSystem::StepOrganism(DataPack* data, const float* networkOutputs, float& fitness, bool& continueStepping)
+void BalancerSystem::StepPack(BalancerDataPack& info, const float* networkOutputs, float& fitness, bool& continueStepping)
 {
-	BalancerDataPack& info = *(BalancerDataPack*)data;
 	float networkOutput = *networkOutputs;
 	//fitness += TIME_STEP; //fitness == time
 	//fitness += (POLE_FAILURE_ANGLE - glm::abs( system.poleAngle); //just to remove the spice, the less wobbly the sticks the better
@@ -56,10 +55,8 @@ void BalancerSystem::StepOrganism(DataPack* data, const float* networkOutputs, f
 	}
 }
 
-void BalancerSystem::SetNetworkInputs(DataPack* data, float* networkInputArray)
+void BalancerSystem::SetPackNetworkInputs(const BalancerDataPack& info, float* networkInputArray)
 {
-	BalancerDataPack& info = *(BalancerDataPack*)data;
-
 	networkInputArray[0] = info.cartPosition;
 	networkInputArray[1] = info.poleAngle;
 	networkInputArray[2] = info.pole2Angle;
@@ -133,18 +130,172 @@ void BalancerSystem::DrawGame(DataPack* data, Renderer& renderer)
 	renderer.DrawLine(start, start + glm::vec2(-failOffset.x, failOffset.y), red);
 }
 
-GameSystem::DataPack* BalancerSystem::GetDefaultDataPack()
+void BalancerSystem::SetupBatch(int populationSize)
+{
+	batchStride = populationSize;
+	batchState = std::vector<float>(BATCH_FIELD_COUNT * batchStride);
+}
+
+void BalancerSystem::ResetBatch(nlv::NetworkOrganism* organisms, int populationSize)
 {
-    return &defaultDataPack;
+	const float defaultValues[BATCH_FIELD_COUNT] = {
+		defaultDataPack.poleAngle, defaultDataPack.poleVelocity, defaultDataPack.poleAcceleration,
+		defaultDataPack.pole2Angle, defaultDataPack.pole2Velocity, defaultDataPack.pole2Acceleration,
+		defaultDataPack.cartPosition, defaultDataPack.cartVelocity, defaultDataPack.cartAcceleration
+	};
+	for (int f = 0; f < BATCH_FIELD_COUNT; f++)
+		std::fill_n(batchState.data() + f * batchStride, populationSize, defaultValues[f]);
+
+	for (int i = 0; i < populationSize; i++)
+		SetBatchNetworkInputs(batchState.data() + i, batchStride, organisms[i].GetNetworkInputArray());
 }
 
-GameSystem::DataPack* BalancerSystem::NewDataPack() const
+int BalancerSystem::StepOrganismBatch(nlv::NetworkOrganism* organisms, int startIndex, int endIndex, uint32_t maxSteps)
 {
-    return new BalancerDataPack();
+	int finished = 0;
+	for (int i = startIndex; i < endIndex; i += simd::WIDTH)
+	{
+		int laneCount = std::min(simd::WIDTH, endIndex - i);
+
+		//gather values from the organisms
+		alignas(16) float outputs[simd::WIDTH] = {};
+		alignas(16) float fitnesses[simd::WIDTH] = {};
+		int activeBits = 0;
+		for (int lane = 0; lane < laneCount; lane++)
+		{
+			const nlv::NetworkOrganism& organism = organisms[i + lane];
+			if (organism.continueStepping && organism.GetStepsTaken() < maxSteps)
+				activeBits |= 1 << lane;
+			outputs[lane] = organism.GetNetworkOutputActivations()[0];
+			fitnesses[lane] = organism.fitness;
+		}
+		if (!activeBits)
+			continue;
+
+		//a partial group (at the end of the range) is stepped in a local copy,
+		//since the lanes after the range might be getting stepped by another thread
+		float localState[BATCH_FIELD_COUNT * simd::WIDTH];
+		float* state = batchState.data() + i;
+		size_t stride = batchStride;
+		if (laneCount < simd::WIDTH)
+		{
+			for (int f = 0; f < BATCH_FIELD_COUNT; f++)
+				for (int lane = 0; lane < simd::WIDTH; lane++)
+					localState[f * simd::WIDTH + lane] = lane < laneCount ? state[f * stride + lane] : 0.0f;
+			state = localState;
+			stride = simd::WIDTH;
+		}
+
+		__m128 fitness = _mm_load_ps(fitnesses);
+		int failedBits = simd::MaskBits(StepLanes(state, stride, _mm_load_ps(outputs), simd::MaskFromBits(activeBits), fitness));
+		_mm_store_ps(fitnesses, fitness);
+
+		if (laneCount < simd::WIDTH)
+		{
+			for (int f = 0; f < BATCH_FIELD_COUNT; f++)
+				for (int lane = 0; lane < laneCount; lane++)
+					batchState[f * batchStride + i + lane] = localState[f * simd::WIDTH + lane];
+		}
+
+		//scatter results back into the organisms
+		for (int lane = 0; lane < laneCount; lane++)
+		{
+			if (!(activeBits & (1 << lane)))
+				continue;
+
+			nlv::NetworkOrganism& organism = organisms[i + lane];
+			organism.fitness = fitnesses[lane];
+			if (failedBits & (1 << lane))
+			{
+				organism.continueStepping = false;
+				finished++;
+			}
+			else if (organism.GetStepsTaken() >= maxSteps - 1)
+				finished++;
+			SetBatchNetworkInputs(state + lane, stride, organism.GetNetworkInputArray());
+		}
+	}
+	return finished;
 }
 
-void BalancerSystem::CopyDataPack(DataPack* dest, DataPack* src) const
+__m128 BalancerSystem::StepLanes(float* state, size_t stride, __m128 output, __m128 active, __m128& fitness)
 {
-	auto destt = (BalancerDataPack*)dest;
-	*destt = *(BalancerDataPack*)src;
-}
\ No newline at end of file
+	using namespace simd;
+	float* poleAnglePtr = state + POLE_ANGLE * stride;
+	float* poleVelocityPtr = state + POLE_VELOCITY * stride;
+	float* poleAccelerationPtr = state + POLE_ACCELERATION * stride;
+	float* pole2AnglePtr = state + POLE_2_ANGLE * stride;
+	float* pole2VelocityPtr = state + POLE_2_VELOCITY * stride;
+	float* pole2AccelerationPtr = state + POLE_2_ACCELERATION * stride;
+	float* cartPositionPtr = state + CART_POSITION * stride;
+	float* cartVelocityPtr = state + CART_VELOCITY * stride;
+	float* cartAccelerationPtr = state + CART_ACCELERATION * stride;
+
+	__m128 poleAngle = _mm_loadu_ps(poleAnglePtr);
+	__m128 poleVelocity = _mm_loadu_ps(poleVelocityPtr);
+	__m128 poleAcceleration = _mm_loadu_ps(poleAccelerationPtr);
+	__m128 pole2Angle = _mm_loadu_ps(pole2AnglePtr);
+	__m128 pole2Velocity = _mm_loadu_ps(pole2VelocityPtr);
+	__m128 pole2Acceleration = _mm_loadu_ps(pole2AccelerationPtr);
+	__m128 cartPosition = _mm_loadu_ps(cartPositionPtr);
+	__m128 cartVelocity = _mm_loadu_ps(cartVelocityPtr);
+	__m128 cartAcceleration = _mm_loadu_ps(cartAccelerationPtr);
+
+	__m128 newFitness = _mm_add_ps(fitness, _mm_add_ps(Abs(poleAngle), Abs(pole2Angle)));
+	__m128 force = _mm_mul_ps(Sign(_mm_sub_ps(output, Set(0.5f))), Set(MOVEMENT_SPEED));
+
+	__m128 timeStep = Set(TIME_STEP);
+	cartPosition = _mm_add_ps(cartPosition, _mm_mul_ps(timeStep, cartVelocity));
+	cartVelocity = _mm_add_ps(cartVelocity, _mm_mul_ps(timeStep, cartAcceleration));
+	poleAngle = _mm_add_ps(poleAngle, _mm_mul_ps(timeStep, poleVelocity));
+	pole2Angle = _mm_add_ps(pole2Angle, _mm_mul_ps(timeStep, pole2Velocity));
+	poleVelocity = _mm_add_ps(poleVelocity, _mm_mul_ps(timeStep, poleAcceleration));
+	pole2Velocity = _mm_add_ps(pole2Velocity, _mm_mul_ps(timeStep, pole2Acceleration));
+
+	__m128 iMass = Set(1.0f / (SPACE_MAX_HEIGHT + POLE_MAX_HEIGHT));
+	__m128 sinAngle, cosAngle;
+	SinCos(poleAngle, sinAngle, cosAngle);
+	__m128 cosSq = _mm_mul_ps(cosAngle, cosAngle);
+
+	//(uses the acceleration from the last step, same as StepOrganism)
+	__m128 poleSwing = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(poleVelocity, poleVelocity), sinAngle), _mm_mul_ps(poleAcceleration, cosAngle));
+	cartAcceleration = _mm_mul_ps(_mm_add_ps(force, _mm_mul_ps(Set(POLE_MAX_HEIGHT * SPACE_MIN_HEIGHT), poleSwing)), iMass);
+
+	__m128 gravity = _mm_mul_ps(Set(GRAVITY), sinAngle);
+	__m128 poleTerm = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(Set(POLE_MAX_HEIGHT * SPACE_MIN_HEIGHT), _mm_mul_ps(poleVelocity, poleVelocity)), sinAngle), iMass);
+	poleAcceleration = _mm_add_ps(gravity, _mm_mul_ps(cosAngle, _mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), force), poleTerm)));
+	poleAcceleration = _mm_div_ps(poleAcceleration, _mm_mul_ps(Set(SPACE_MIN_HEIGHT), _mm_sub_ps(Set(4.0f / 3.0f), _mm_mul_ps(_mm_mul_ps(Set(POLE_MAX_HEIGHT), cosSq), iMass))));
+
+	__m128 pole2Term = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(Set(BAR_MIN_HEIGHT * POLE_2_LENGTH), _mm_mul_ps(pole2Velocity, pole2Velocity)), sinAngle), iMass);
+	pole2Acceleration = _mm_add_ps(gravity, _mm_mul_ps(cosAngle, _mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), force), pole2Term)));
+	pole2Acceleration = _mm_div_ps(pole2Acceleration, _mm_mul_ps(Set(POLE_2_LENGTH), _mm_sub_ps(Set(4.0f / 3.0f), _mm_mul_ps(_mm_mul_ps(Set(BAR_MIN_HEIGHT), cosSq), iMass))));
+
+	__m128 failed = _mm_or_ps(_mm_or_ps(
+		_mm_cmpge_ps(Abs(poleAngle), Set(POLE_FAILURE_ANGLE)),
+		_mm_cmpge_ps(Abs(pole2Angle), Set(POLE_FAILURE_ANGLE))),
+		_mm_cmpge_ps(Abs(cartPosition), Set(TRACK_LIMIT)));
+
+	//only write back lanes that are stepping
+	_mm_storeu_ps(poleAnglePtr, Select(active, poleAngle, _mm_loadu_ps(poleAnglePtr)));
+	_mm_storeu_ps(poleVelocityPtr, Select(active, poleVelocity, _mm_loadu_ps(poleVelocityPtr)));
+	_mm_storeu_ps(poleAccelerationPtr, Select(active, poleAcceleration, _mm_loadu_ps(poleAccelerationPtr)));
+	_mm_storeu_ps(pole2AnglePtr, Select(active, pole2Angle, _mm_loadu_ps(pole2AnglePtr)));
+	_mm_storeu_ps(pole2VelocityPtr, Select(active, pole2Velocity, _mm_loadu_ps(pole2VelocityPtr)));
+	_mm_storeu_ps(pole2AccelerationPtr, Select(active, pole2Acceleration, _mm_loadu_ps(pole2AccelerationPtr)));
+	_mm_storeu_ps(cartPositionPtr, Select(active, cartPosition, _mm_loadu_ps(cartPositionPtr)));
+	_mm_storeu_ps(cartVelocityPtr, Select(active, cartVelocity, _mm_loadu_ps(cartVelocityPtr)));
+	_mm_storeu_ps(cartAccelerationPtr, Select(active, cartAcceleration, _mm_loadu_ps(cartAccelerationPtr)));
+	fitness = Select(active, newFitness, fitness);
+
+	return _mm_and_ps(failed, active);
+}
+
+void BalancerSystem::SetBatchNetworkInputs(const float* state, size_t stride, float* networkInputArray)
+{
+	networkInputArray[0] = state[CART_POSITION * stride];
+	networkInputArray[1] = state[POLE_ANGLE * stride];
+	networkInputArray[2] = state[POLE_2_ANGLE * stride];
+	networkInputArray[3] = state[CART_VELOCITY * stride];
+	networkInputArray[4] = state[POLE_VELOCITY * stride];
+	networkInputArray[5] = state[POLE_2_VELOCITY * stride];
+}
@@ -1,8 +1,22 @@
 #pragma once
-#include "GameSystem.h"
+#include "TypedGameSystem.h"
 #include "Texture.h"
+#include "SimdMath.h"
 
-class BalancerSystem : public GameSystem
+struct BalancerDataPack : public GameSystem::DataPack
+{
+	float poleAngle;
+	float poleVelocity;
+	float poleAcceleration;
+	float pole2Angle;
+	float pole2Velocity;
+	float pole2Acceleration;
+	float cartPosition;
+	float cartVelocity;
+	float cartAcceleration;
+};
+
+class BalancerSystem : public TypedGameSystem<BalancerSystem, BalancerDataPack>
 {
 public:
 	static constexpr int INPUT_COUNT = 6;
@@ -20,41 +34,53 @@ public:
 	static constexpr float POLE_FAILURE_ANGLE = 0.209f; // degrees: 12.0f;
 	static constexpr float TIME_STEP = 1.0f / 50.0f;
 
-	struct BalancerDataPack : public GameSystem::DataPack
-	{
-		float poleAngle;
-		float poleVelocity;
-		float poleAcceleration;
-		float pole2Angle;
-		float pole2Velocity;
-		float pole2Acceleration;
-		float cartPosition;
-		float cartVelocity;
-		float cartAcceleration;
-
-		virtual ~BalancerDataPack() = default;
-
-	};
-
 	BalancerSystem();
 	virtual ~BalancerSystem() override = default;
+
+	// Used by TypedGameSystem
+	void StepPack(BalancerDataPack& info, const float* networkOutputs, float& fitness, bool& continueStepping);
+	void SetPackNetworkInputs(const BalancerDataPack& info, float* networkInputArray);
+
 	// Inherited via GameSystem
 	virtual void SetDefaultDataPack(std::minstd_rand& random) override;
-	virtual void StepOrganism(DataPack* data, const float* networkOutputs, float& fitness, bool& continueStepping) override;
-	virtual void SetNetworkInputs(DataPack* data, float* networkInputArray) override;
 	virtual void ResetManualOutput() override;
 	virtual void StartOrganismPreview(bool manual, Renderer& renderer) override;
 	virtual void OnKeyPressed(Renderer& renderer, int keycode, int action, bool manual) override;
 	virtual void DrawGame(DataPack* data, Renderer& renderer) override;
-	virtual DataPack* GetDefaultDataPack() override;
-	virtual DataPack* NewDataPack() const override;
-	virtual void CopyDataPack(DataPack* dest, DataPack* src) const override;
 	virtual int GetInputCount() const override { return INPUT_COUNT; }
 	virtual int GetOutputCount() const override { return OUTPUT_COUNT; }
 	virtual int GetDefaultHiddenNodes() const override { return DEFAULT_NODE_COUNT; }
 
+	// Batched stepping
+	virtual bool GetSupportsBatchStepping() const override { return true; }
+	virtual void SetupBatch(int populationSize) override;
+	virtual void ResetBatch(nlv::NetworkOrganism* organisms, int populationSize) override;
+	virtual int StepOrganismBatch(nlv::NetworkOrganism* organisms, int startIndex, int endIndex, uint32_t maxSteps) override;
+
 private:
-	BalancerDataPack defaultDataPack;
+	//the values of BalancerDataPack, in the order they are stored in the batch state
+	enum BatchField : int
+	{
+		POLE_ANGLE,
+		POLE_VELOCITY,
+		POLE_ACCELERATION,
+		POLE_2_ANGLE,
+		POLE_2_VELOCITY,
+		POLE_2_ACCELERATION,
+		CART_POSITION,
+		CART_VELOCITY,
+		CART_ACCELERATION,
+		BATCH_FIELD_COUNT
+	};
+	//same logic as StepOrganism, but for simd::WIDTH organisms at once. field f of lane i is at state[f * stride + i]
+	//only lanes in the active mask are modified. returns a mask of the lanes that failed
+	static __m128 StepLanes(float* state, size_t stride, __m128 output, __m128 active, __m128& fitness);
+	//same as SetNetworkInputs, but reading from batch state
+	static void SetBatchNetworkInputs(const float* state, size_t stride, float* networkInputArray);
+
+	//structure of arrays version of every organism's datapack, field f of organism i is at batchState[f * batchStride + i]
+	std::vector<float> batchState;
+	size_t batchStride = 0;
 	Texture minecart;
 };
 
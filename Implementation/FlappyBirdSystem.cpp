@@ -13,25 +13,22 @@ FlappyBirdSystem::~FlappyBirdSystem()
 
 void FlappyBirdSystem::SetDefaultDataPack(std::minstd_rand& random)
 {
-	std::uniform_real_distribution<float> dist(0.0f, 1.0f);
 	defaultDataPack.yVelocity = 0;
 	defaultDataPack.yPos = SCREEN_HALF_HEIGHT;
 	//SCREEN_WIDTH is on the absolute rightmost end of the screen, 0 is where the bird is
 	defaultDataPack.barXPos = BAR_DISTANCE;
+	std::uniform_real_distribution<float> dist(0.0f, 1.0f);
 	defaultDataPack.barHeight = dist(random) * (BAR_MAX_HEIGHT - BAR_MIN_HEIGHT) + BAR_MIN_HEIGHT;
 	defaultDataPack.spaceHeight = dist(random) * (SPACE_MAX_HEIGHT - SPACE_MIN_HEIGHT) + SPACE_MIN_HEIGHT;
 	defaultDataPack.random = random;
 
 }
 
-void FlappyBirdSystem::StepOrganism(DataPack* data, const float* networkOutputs, float& fitness, bool& continueStepping)
+void FlappyBirdSystem::StepPack(FlappyBirdDataPack& dP, const float* networkOutputs, float& fitness, bool& continueStepping)
 {
 	//fitness is basically distance
 	fitness += EXIST_GAIN * TIME_STEP * MOVEMENT_SPEED;
 
-	std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-	FlappyBirdDataPack& dP = *(FlappyBirdDataPack*)data;
-	
 	dP.yPos += TIME_STEP * dP.yVelocity;
 	if (*networkOutputs > 0.5f)
 	{
@@ -48,6 +45,7 @@ void FlappyBirdSystem::StepOrganism(DataPack* data, const float* networkOutputs,
 	{
 		//go to next bar
 		fitness += BAR_GAIN;
+		std::uniform_real_distribution<float> dist(0.0f, 1.0f);
 		dP.barHeight = dist(dP.random) * (BAR_MAX_HEIGHT - BAR_MIN_HEIGHT) + BAR_MIN_HEIGHT;
 		dP.spaceHeight = dist(dP.random) * (SPACE_MAX_HEIGHT - SPACE_MIN_HEIGHT) + SPACE_MIN_HEIGHT;
 		dP.barXPos = BAR_DISTANCE + BAR_HALF_WIDTH;
@@ -78,10 +76,8 @@ void FlappyBirdSystem::StepOrganism(DataPack* data, const float* networkOutputs,
 	}
 }
 
-void FlappyBirdSystem::SetNetworkInputs(DataPack* data, float* networkInputArray)
+void FlappyBirdSystem::SetPackNetworkInputs(const FlappyBirdDataPack& dP, float* networkInputArray)
 {
-	FlappyBirdDataPack& dP = *(FlappyBirdDataPack*)data;
-
 	networkInputArray[0] = dP.barXPos;
 	networkInputArray[1] = dP.barHeight;
 	networkInputArray[2] = dP.spaceHeight;
@@ -122,13 +118,186 @@ void FlappyBirdSystem::DrawGame(DataPack* data, Renderer& renderer)
 
 }
 
-GameSystem::DataPack* FlappyBirdSystem::NewDataPack() const
+void FlappyBirdSystem::SetupBatch(int populationSize)
+{
+	batchStride = populationSize;
+	batchState = std::vector<float>(BATCH_FIELD_COUNT * batchStride);
+	batchRandom = std::vector<std::minstd_rand>(populationSize);
+}
+
+void FlappyBirdSystem::ResetBatch(nlv::NetworkOrganism* organisms, int populationSize)
+{
+	const float defaultValues[BATCH_FIELD_COUNT] = {
+		defaultDataPack.yVelocity, defaultDataPack.yPos, defaultDataPack.barXPos,
+		defaultDataPack.barHeight, defaultDataPack.spaceHeight
+	};
+	for (int f = 0; f < BATCH_FIELD_COUNT; f++)
+		std::fill_n(batchState.data() + f * batchStride, populationSize, defaultValues[f]);
+	std::fill_n(batchRandom.begin(), populationSize, defaultDataPack.random);
+
+	for (int i = 0; i < populationSize; i++)
+		SetBatchNetworkInputs(batchState.data() + i, batchStride, organisms[i].GetNetworkInputArray());
+}
+
+int FlappyBirdSystem::StepOrganismBatch(nlv::NetworkOrganism* organisms, int startIndex, int endIndex, uint32_t maxSteps)
+{
+	int finished = 0;
+	for (int i = startIndex; i < endIndex; i += simd::WIDTH)
+	{
+		int laneCount = std::min(simd::WIDTH, endIndex - i);
+
+		//gather values from the organisms
+		alignas(16) float outputs[simd::WIDTH] = {};
+		alignas(16) float fitnesses[simd::WIDTH] = {};
+		int activeBits = 0;
+		for (int lane = 0; lane < laneCount; lane++)
+		{
+			const nlv::NetworkOrganism& organism = organisms[i + lane];
+			if (organism.continueStepping && organism.GetStepsTaken() < maxSteps)
+				activeBits |= 1 << lane;
+			outputs[lane] = organism.GetNetworkOutputActivations()[0];
+			fitnesses[lane] = organism.fitness;
+		}
+		if (!activeBits)
+			continue;
+
+		//a partial group (at the end of the range) is stepped in a local copy,
+		//since the lanes after the range might be getting stepped by another thread
+		float localState[BATCH_FIELD_COUNT * simd::WIDTH];
+		float* state = batchState.data() + i;
+		size_t stride = batchStride;
+		if (laneCount < simd::WIDTH)
+		{
+			for (int f = 0; f < BATCH_FIELD_COUNT; f++)
+				for (int lane = 0; lane < simd::WIDTH; lane++)
+					localState[f * simd::WIDTH + lane] = lane < laneCount ? state[f * stride + lane] : 0.0f;
+			state = localState;
+			stride = simd::WIDTH;
+		}
+
+		__m128 fitness = _mm_load_ps(fitnesses);
+		int passedBits = simd::MaskBits(MoveLanes(state, stride, _mm_load_ps(outputs), simd::MaskFromBits(activeBits), fitness));
+		_mm_store_ps(fitnesses, fitness);
+
+		//new bars are generated one at a time since every organism has its own random engine
+		for (int lane = 0; lane < laneCount; lane++)
+		{
+			if (passedBits & (1 << lane))
+			{
+				std::minstd_rand& random = batchRandom[i + lane];
+				std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+				state[BAR_HEIGHT * stride + lane] = dist(random) * (BAR_MAX_HEIGHT - BAR_MIN_HEIGHT) + BAR_MIN_HEIGHT;
+				state[SPACE_HEIGHT * stride + lane] = dist(random) * (SPACE_MAX_HEIGHT - SPACE_MIN_HEIGHT) + SPACE_MIN_HEIGHT;
+			}
+		}
+
+		int failedBits = simd::MaskBits(CollideLanes(state, stride)) & activeBits;
+
+		if (laneCount < simd::WIDTH)
+		{
+			for (int f = 0; f < BATCH_FIELD_COUNT; f++)
+				for (int lane = 0; lane < laneCount; lane++)
+					batchState[f * batchStride + i + lane] = localState[f * simd::WIDTH + lane];
+		}
+
+		//scatter results back into the organisms
+		for (int lane = 0; lane < laneCount; lane++)
+		{
+			if (!(activeBits & (1 << lane)))
+				continue;
+
+			nlv::NetworkOrganism& organism = organisms[i + lane];
+			organism.fitness = fitnesses[lane];
+			if (failedBits & (1 << lane))
+			{
+				organism.continueStepping = false;
+				finished++;
+			}
+			else if (organism.GetStepsTaken() >= maxSteps - 1)
+				finished++;
+			SetBatchNetworkInputs(state + lane, stride, organism.GetNetworkInputArray());
+		}
+	}
+	return finished;
+}
+
+__m128 FlappyBirdSystem::MoveLanes(float* state, size_t stride, __m128 output, __m128 active, __m128& fitness)
 {
-	return new FlappyBirdDataPack();
+	using namespace simd;
+	float* yVelocityPtr = state + Y_VELOCITY * stride;
+	float* yPosPtr = state + Y_POS * stride;
+	float* barXPosPtr = state + BAR_X_POS * stride;
+
+	__m128 yVelocity = _mm_loadu_ps(yVelocityPtr);
+	__m128 yPos = _mm_loadu_ps(yPosPtr);
+	__m128 barXPos = _mm_loadu_ps(barXPosPtr);
+
+	//fitness is basically distance
+	__m128 newFitness = _mm_add_ps(fitness, Set(EXIST_GAIN * TIME_STEP * MOVEMENT_SPEED));
+
+	yPos = _mm_add_ps(yPos, _mm_mul_ps(Set(TIME_STEP), yVelocity));
+	__m128 flap = _mm_cmpgt_ps(output, Set(0.5f));
+	yVelocity = Select(flap, Set(JUMP_FORCE), yVelocity);
+	newFitness = Select(flap, _mm_sub_ps(newFitness, Set(FLAP_LOSS)), newFitness);
+	yVelocity = _mm_add_ps(yVelocity, Set(TIME_STEP * GRAVITY));
+
+	//bar moves towards bird
+	barXPos = _mm_sub_ps(barXPos, Set(TIME_STEP * MOVEMENT_SPEED));
+	__m128 passed = _mm_and_ps(_mm_cmplt_ps(_mm_add_ps(barXPos, Set(BAR_HALF_WIDTH + BIRD_RADIUS)), _mm_setzero_ps()), active);
+	newFitness = Select(passed, _mm_add_ps(newFitness, Set(BAR_GAIN)), newFitness);
+	barXPos = Select(passed, Set(BAR_DISTANCE + BAR_HALF_WIDTH), barXPos);
+
+	//only write back lanes that are stepping
+	_mm_storeu_ps(yVelocityPtr, Select(active, yVelocity, _mm_loadu_ps(yVelocityPtr)));
+	_mm_storeu_ps(yPosPtr, Select(active, yPos, _mm_loadu_ps(yPosPtr)));
+	_mm_storeu_ps(barXPosPtr, Select(active, barXPos, _mm_loadu_ps(barXPosPtr)));
+	fitness = Select(active, newFitness, fitness);
+
+	return passed;
+}
+
+__m128 FlappyBirdSystem::CollideLanes(const float* state, size_t stride)
+{
+	using namespace simd;
+	__m128 yPos = _mm_loadu_ps(state + Y_POS * stride);
+	__m128 barXPos = _mm_loadu_ps(state + BAR_X_POS * stride);
+	__m128 barHeight = _mm_loadu_ps(state + BAR_HEIGHT * stride);
+	__m128 spaceHeight = _mm_loadu_ps(state + SPACE_HEIGHT * stride);
+	__m128 zero = _mm_setzero_ps();
+	__m128 radius = Set(BIRD_RADIUS);
+	__m128 radiusSq = Set(BIRD_RADIUS * BIRD_RADIUS);
+
+	//if at the bottom or top of the screen
+	__m128 outOfScreen = _mm_or_ps(
+		_mm_cmpge_ps(_mm_add_ps(yPos, radius), Set(SCREEN_HALF_HEIGHT * 2)),
+		_mm_cmple_ps(_mm_sub_ps(yPos, radius), zero));
+
+	//if collide with bar
+	__m128 yDelta = _mm_sub_ps(yPos, barHeight);
+	__m128 yDelta2 = _mm_sub_ps(yPos, _mm_add_ps(barHeight, spaceHeight));
+	__m128 xDelta = _mm_sub_ps(barXPos, Set(BAR_HALF_WIDTH));
+	__m128 xDelta2 = _mm_add_ps(barXPos, Set(BAR_HALF_WIDTH));
+	__m128 xDeltaSq = _mm_mul_ps(xDelta, xDelta);
+	__m128 xDelta2Sq = _mm_mul_ps(xDelta2, xDelta2);
+	__m128 yDeltaSq = _mm_mul_ps(yDelta, yDelta);
+	__m128 yDelta2Sq = _mm_mul_ps(yDelta2, yDelta2);
+
+	__m128 collideWithPoints = _mm_or_ps(
+		_mm_or_ps(_mm_cmplt_ps(_mm_add_ps(xDeltaSq, yDeltaSq), radiusSq), _mm_cmplt_ps(_mm_add_ps(xDeltaSq, yDelta2Sq), radiusSq)),
+		_mm_or_ps(_mm_cmplt_ps(_mm_add_ps(xDelta2Sq, yDeltaSq), radiusSq), _mm_cmplt_ps(_mm_add_ps(xDelta2Sq, yDelta2Sq), radiusSq)));
+	__m128 collideX = _mm_and_ps(_mm_cmplt_ps(xDelta, zero),
+		_mm_or_ps(_mm_cmplt_ps(yDelta, radius), _mm_cmpgt_ps(yDelta2, _mm_sub_ps(zero, radius))));
+	__m128 collideY = _mm_and_ps(_mm_or_ps(_mm_cmplt_ps(yDelta, zero), _mm_cmpgt_ps(yDelta2, zero)),
+		_mm_cmplt_ps(xDelta, radius));
+
+	return _mm_or_ps(outOfScreen, _mm_or_ps(collideWithPoints, _mm_or_ps(collideX, collideY)));
 }
 
-void FlappyBirdSystem::CopyDataPack(DataPack* dest, DataPack* src) const
+void FlappyBirdSystem::SetBatchNetworkInputs(const float* state, size_t stride, float* networkInputArray)
 {
-	auto destt = (FlappyBirdDataPack*)dest;
-	*destt = *(FlappyBirdDataPack*)src;
+	networkInputArray[0] = state[BAR_X_POS * stride];
+	networkInputArray[1] = state[BAR_HEIGHT * stride];
+	networkInputArray[2] = state[SPACE_HEIGHT * stride];
+	networkInputArray[3] = state[Y_POS * stride];
+	networkInputArray[4] = state[Y_VELOCITY * stride];
 }
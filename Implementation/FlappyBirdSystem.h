@@ -1,8 +1,19 @@
 #pragma once
-#include "GameSystem.h"
+#include "TypedGameSystem.h"
 #include "glm.hpp"
+#include "SimdMath.h"
 
-class FlappyBirdSystem : public GameSystem
+struct FlappyBirdDataPack : public GameSystem::DataPack
+{
+	float yVelocity;
+	float yPos;
+	float barXPos;
+	float barHeight;
+	float spaceHeight;
+	std::minstd_rand random;
+};
+
+class FlappyBirdSystem : public TypedGameSystem<FlappyBirdSystem, FlappyBirdDataPack>
 {
 public:
 	static constexpr float BAR_GAIN = 1.0f;
@@ -28,40 +39,52 @@ public:
 	FlappyBirdSystem();
 	virtual ~FlappyBirdSystem();
 
-	struct FlappyBirdDataPack : public DataPack 
-	{
-		float yVelocity;
-		float yPos;
-		float barXPos;
-		float barHeight;
-		float spaceHeight;
-		std::minstd_rand random;
-
-		virtual ~FlappyBirdDataPack() = default;
-	};
+	// Used by TypedGameSystem
+	void StepPack(FlappyBirdDataPack& dP, const float* networkOutputs, float& fitness, bool& continueStepping);
+	void SetPackNetworkInputs(const FlappyBirdDataPack& dP, float* networkInputArray);
 
 	// Inherited via GameSystem
 	virtual void SetDefaultDataPack(std::minstd_rand& random) override;
 
-	virtual void StepOrganism(DataPack* data, const float* networkOutputs, float& fitness, bool& continueStepping) override;
-
-	virtual void SetNetworkInputs(DataPack* data, float* networkInputArray) override;
-
 	virtual void ResetManualOutput() override;
 
 	virtual void OnKeyPressed(Renderer& renderer, int keycode, int action, bool manual) override;
 
 	virtual void DrawGame(DataPack* data, Renderer& renderer) override;
 
-	virtual DataPack* NewDataPack() const override;
-	virtual void CopyDataPack(DataPack* dest, DataPack* src) const override;
-
 	virtual int GetInputCount() const override { return INPUT_NODES; }
 	virtual int GetOutputCount() const override { return OUTPUT_NODES; }
 	virtual int GetDefaultHiddenNodes() const override { return DEFAULT_HIDDEN_NODES; }
-	virtual DataPack* GetDefaultDataPack() override { return &defaultDataPack; }
+
+	// Batched stepping
+	virtual bool GetSupportsBatchStepping() const override { return true; }
+	virtual void SetupBatch(int populationSize) override;
+	virtual void ResetBatch(nlv::NetworkOrganism* organisms, int populationSize) override;
+	virtual int StepOrganismBatch(nlv::NetworkOrganism* organisms, int startIndex, int endIndex, uint32_t maxSteps) override;
 private:
-	FlappyBirdDataPack defaultDataPack;
+	//the float values of FlappyBirdDataPack, in the order they are stored in the batch state
+	enum BatchField : int
+	{
+		Y_VELOCITY,
+		Y_POS,
+		BAR_X_POS,
+		BAR_HEIGHT,
+		SPACE_HEIGHT,
+		BATCH_FIELD_COUNT
+	};
+	//moves simd::WIDTH birds and bars at once. field f of lane i is at state[f * stride + i]
+	//only lanes in the active mask are modified. returns a mask of the lanes that passed a bar and need a new one
+	static __m128 MoveLanes(float* state, size_t stride, __m128 output, __m128 active, __m128& fitness);
+	//returns a mask of the lanes that hit the screen edges or a bar
+	static __m128 CollideLanes(const float* state, size_t stride);
+	//same as SetNetworkInputs, but reading from batch state
+	static void SetBatchNetworkInputs(const float* state, size_t stride, float* networkInputArray);
+
+	//structure of arrays version of every organism's datapack, field f of organism i is at batchState[f * batchStride + i]
+	std::vector<float> batchState;
+	//random engine for every organism (not a float so not part of batchState)
+	std::vector<std::minstd_rand> batchRandom;
+	size_t batchStride = 0;
 
 	Texture bird;
 };
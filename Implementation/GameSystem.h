@@ -16,10 +16,8 @@ public:
 	
 	//contains information specific to individual organisms.
 	//e.g for pole balancer it will hold velocity, position, pole angle
-	struct DataPack {
-
-		virtual ~DataPack() = default;
-	};
+	//(no virtual destructor so datapacks can be trivially copied, delete them with DeleteDataPack)
+	struct DataPack {};
 
 	//set the default datapack to values on the start of a generation
 	virtual void SetDefaultDataPack(std::minstd_rand& random) = 0;
@@ -40,9 +38,31 @@ public:
 	//called when starting and ending rungeneration();
 	virtual void OnStartEndGeneration(bool start) {};
 
+	//batched stepping (optional): steps a whole range of organisms at once instead of one at a time through StepOrganism
+	//the state used for this is owned by the system, not by the datapacks
+	virtual bool GetSupportsBatchStepping() const { return false; }
+	//allocate batch state for every organism in the population
+	virtual void SetupBatch(int populationSize) {};
+	//set every organism's batch state to the default datapack and set their network inputs
+	virtual void ResetBatch(nlv::NetworkOrganism* organisms, int populationSize) {};
+	//step every organism in [startIndex, endIndex) that is still stepping. returns the number of organisms that finished their episode
+	virtual int StepOrganismBatch(nlv::NetworkOrganism* organisms, int startIndex, int endIndex, uint32_t maxSteps) { return 0; };
+
+	//datapacks of every organism (used when the system is not batch stepped), stored by the system
+	//allocate a datapack for every organism in the population
+	virtual void SetupDataPacks(int populationSize) = 0;
+	//set every organism's datapack to the default datapack and set their network inputs
+	virtual void ResetDataPacks(nlv::NetworkOrganism* organisms, int populationSize) = 0;
+	//replicas (used when every organism is evaluated over more than one episode)
+	//set a default datapack for every replica, each with SetDefaultDataPack so every replica gets different random values
+	virtual void SetupReplicas(std::minstd_rand& random, int replicaCount) = 0;
+	//set an organism's datapack to the default datapack of a replica and set its network inputs
+	virtual void ResetDataPack(nlv::NetworkOrganism& organism, int organismIndex, int replicaIndex) = 0;
+
 	inline std::vector<float>& GetManualOutput() { return manualOutput; }
 	virtual DataPack* GetDefaultDataPack() = 0;
 	virtual DataPack* NewDataPack() const = 0;
+	virtual void DeleteDataPack(DataPack* data) const = 0;
 	virtual void CopyDataPack(DataPack* dest, DataPack* src) const = 0;
 	virtual int GetInputCount() const  = 0;
 	virtual int GetOutputCount() const = 0;
@@ -28,10 +28,8 @@ void RacerSystem::SetDefaultDataPack(std::minstd_rand& random)
 	defaultDataPack.velocity = glm::vec2(0);
 }
 
-void RacerSystem::StepOrganism(DataPack* data, const float* networkOutputs, float& fitness, bool& continueStepping)
+void RacerSystem::StepPack(RacerDataPack& info, const float* networkOutputs, float& fitness, bool& continueStepping)
 {
-	RacerDataPack& info = *(RacerDataPack*)data;
-
 	//Outputs are:
 	//acceleration force, rotational acceleration force
 
@@ -110,10 +108,8 @@ void RacerSystem::StepOrganism(DataPack* data, const float* networkOutputs, floa
 		fitness = glm::floor(fitness) + t;
 }
 
-void RacerSystem::SetNetworkInputs(DataPack* data, float* networkInputArray)
+void RacerSystem::SetPackNetworkInputs(const RacerDataPack& info, float* networkInputArray)
 {
-	RacerDataPack& info = *(RacerDataPack*)data;
-
 	//Inputs are:
 	// raycast values for forward, left-forward, right-forward, left, right
 	// current speed forward + speed sideward
@@ -380,22 +376,6 @@ void RacerSystem::DrawGame(DataPack* data, Renderer& renderer)
 
 }
 
-GameSystem::DataPack* RacerSystem::GetDefaultDataPack()
-{
-	return &defaultDataPack;
-}
-
-GameSystem::DataPack* RacerSystem::NewDataPack() const
-{
-    return new RacerDataPack();
-}
-
-void RacerSystem::CopyDataPack(DataPack* dest, DataPack* src) const
-{
-	auto destt = (RacerDataPack*)dest;
-	*destt = *(RacerDataPack*)src;
-}
-
 bool RacerSystem::RaycastLine(std::vector<glm::vec2>& line, glm::vec2 origin, glm::vec2 dir, float raycastDistance, float* hitDistance)
 {
 	//just line-line (cool version against the function that defines the walls was interesting but too slow)
@@ -1,9 +1,18 @@
 #pragma once
-#include "GameSystem.h"
+#include "TypedGameSystem.h"
 #include "glm.hpp"
 #include "Spline.h"
 
-class RacerSystem : public GameSystem
+struct RacerDataPack : public GameSystem::DataPack
+{
+	glm::vec2 position;
+	float rotation;
+	glm::vec2 velocity;
+	//(how long it has been stopped for)
+	float stoppedTime;
+};
+
+class RacerSystem : public TypedGameSystem<RacerSystem, RacerDataPack>
 {
 public:
 	static constexpr int INPUT_COUNT = 7;
@@ -23,23 +32,15 @@ public:
 	static constexpr float RAYCAST_DISTANCE = 13.0f;
 	static constexpr glm::vec2 CAR_DIMENSIONS = { 6, 3 };
 	
-	struct RacerDataPack : public GameSystem::DataPack
-	{
-		glm::vec2 position;
-		float rotation;
-		glm::vec2 velocity;
-		//(how long it has been stopped for)
-		float stoppedTime;
-		virtual ~RacerDataPack() = default;
-	};
-
 	RacerSystem();
 	virtual ~RacerSystem() = default;
 
+	// Used by TypedGameSystem
+	void StepPack(RacerDataPack& info, const float* networkOutputs, float& fitness, bool& continueStepping);
+	void SetPackNetworkInputs(const RacerDataPack& info, float* networkInputArray);
+
 	// Inherited via GameSystem
 	virtual void SetDefaultDataPack(std::minstd_rand& random) override;
-	virtual void StepOrganism(DataPack* data, const float* networkOutputs, float& fitness, bool& continueStepping) override;
-	virtual void SetNetworkInputs(DataPack* data, float* networkInputArray) override;
 	virtual void StartOrganismPreview(bool manual, Renderer& renderer) override;
 	virtual void OnStartEndGeneration(bool start) override;
 	virtual void ResetManualOutput() override;
@@ -47,16 +48,11 @@ public:
 	virtual void OnMousePressed(Renderer& renderer, int button, int action, bool manual) override;
 	virtual void OnMouseScrolled(Renderer& renderer, float amount, bool manual) override;
 	virtual void DrawGame(DataPack* data, Renderer& renderer) override;
-	virtual DataPack* GetDefaultDataPack() override;
-	virtual DataPack* NewDataPack() const override;
-	virtual void CopyDataPack(DataPack* dest, DataPack* src) const override;
 	virtual int GetInputCount() const override { return INPUT_COUNT; }
 	virtual int GetOutputCount() const override { return OUTPUT_COUNT; }
 	virtual int GetDefaultHiddenNodes() const override { return DEFAULT_NODE_COUNT; }
 
 private:
-	RacerDataPack defaultDataPack;
-
 	//used raycast
 	bool RaycastLine(std::vector<glm::vec2>& line, glm::vec2 origin, glm::vec2 dir, float raycastDistance, float* hitDistance);
 	bool RaycastWalls(glm::vec2 origin, glm::vec2 dir, float raycastDistance, float* hitDistance);
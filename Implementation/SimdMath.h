@@ -0,0 +1,70 @@
+#pragma once
+#include <emmintrin.h>
+
+//small set of SSE2 helpers used by the batched game system kernels
+//SSE2 is always available on x64, so no runtime checks are needed
+namespace simd
+{
+	//the number of floats processed at once
+	constexpr int WIDTH = 4;
+
+	inline __m128 Set(float value) { return _mm_set1_ps(value); }
+	//returns a where mask is set, b otherwise
+	inline __m128 Select(__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	inline __m128 Abs(__m128 x) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), x); }
+	//same as glm::sign (returns 0 for 0)
+	inline __m128 Sign(__m128 x)
+	{
+		__m128 zero = _mm_setzero_ps();
+		__m128 one = _mm_set1_ps(1.0f);
+		return _mm_sub_ps(_mm_and_ps(_mm_cmpgt_ps(x, zero), one), _mm_and_ps(_mm_cmplt_ps(x, zero), one));
+	}
+	// Returns the lanes set in a mask as the lowest 4 bits of an int
+	inline int MaskBits(__m128 mask) { return _mm_movemask_ps(mask); }
+	// Creates a mask from the lowest 4 bits of an int
+	inline __m128 MaskFromBits(int bits)
+	{
+		__m128i lanes = _mm_set_epi32(8, 4, 2, 1);
+		__m128i set = _mm_and_si128(_mm_set1_epi32(bits), lanes);
+		return _mm_castsi128_ps(_mm_cmpeq_epi32(set, lanes));
+	}
+
+	//sine and cosine of x at once (cephes style, reduced into [-pi/4, pi/4] then approximated with polynomials)
+	//accurate to a couple ulp for the range of values the game systems use
+	inline void SinCos(__m128 x, __m128& sinOut, __m128& cosOut)
+	{
+		//j = the closest multiple of pi/2
+		__m128i j = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772367581f)));
+		__m128 y = _mm_cvtepi32_ps(j);
+
+		//extended precision x - y * pi/2
+		x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(1.5703125f)));
+		x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(4.837512969970703125e-4f)));
+		x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(7.54978995489188216e-8f)));
+
+		__m128 z = _mm_mul_ps(x, x);
+
+		//sin polynomial
+		__m128 s = _mm_set1_ps(-1.9515295891e-4f);
+		s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(8.3321608736e-3f));
+		s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(-1.6666654611e-1f));
+		s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), x), x);
+
+		//cos polynomial
+		__m128 c = _mm_set1_ps(2.443315711809948e-5f);
+		c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(-1.388731625493765e-3f));
+		c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(4.166664568298827e-2f));
+		c = _mm_mul_ps(_mm_mul_ps(c, z), z);
+		c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+		//the quadrant (j mod 4) decides which polynomial is used and the sign of the result
+		//quadrant 0: (s, c), 1: (c, -s), 2: (-s, -c), 3: (-c, s)
+		__m128i quadrant = _mm_and_si128(j, _mm_set1_epi32(3));
+		__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+		__m128 sinNegative = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+		__m128 cosNegative = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+		sinOut = _mm_xor_ps(Select(swap, c, s), sinNegative);
+		cosOut = _mm_xor_ps(Select(swap, s, c), cosNegative);
+	}
+}
@@ -7,33 +7,22 @@ SnakeSystem::SnakeSystem()
 
 void SnakeSystem::SetDefaultDataPack(std::minstd_rand& random)
 {
-	//something here causes a memory leak??
-	//its the body vector, it is not being destructed
-
-	defaultDataPack.body.clear();
+	defaultDataPack.ClearBody();
 	defaultDataPack.movementDirection = Direction::DOWN;
-	defaultDataPack.body.emplace_back(GRID_SIZE / 2, GRID_SIZE / 2);
-	defaultDataPack.body.push_back(defaultDataPack.body[0] + Coord(0, 1));
-	defaultDataPack.body.push_back(defaultDataPack.body[0] + Coord(0, 2));
+	//pushed tail first, the head ends up at the center of the grid
+	defaultDataPack.PushHead(Coord(GRID_SIZE / 2, GRID_SIZE / 2 + 2));
+	defaultDataPack.PushHead(Coord(GRID_SIZE / 2, GRID_SIZE / 2 + 1));
+	defaultDataPack.PushHead(Coord(GRID_SIZE / 2, GRID_SIZE / 2));
 	defaultDataPack.stepsLeft = STARTING_STEPS;
 	defaultDataPack.amountToAdd = 0;
 	defaultDataPack.random = random;
 
-	bool appleIntersecting = false;
-	//loop apple placement until it isn't on body
-	do {
-		appleIntersecting = false;
-		//not the same every time
-		defaultDataPack.appleCoord = Coord{ dist(random), dist(random) };
-		for (Coord pos : defaultDataPack.body)
-			appleIntersecting |= pos == defaultDataPack.appleCoord;
-	} while (appleIntersecting);
+	//not the same every time
+	PlaceApple(defaultDataPack, random);
 }
 
-void SnakeSystem::StepOrganism(DataPack* data, const float* networkOutputs, float& fitness, bool& continueStepping)
+void SnakeSystem::StepPack(SnakeDataPack& info, const float* networkOutputs, float& fitness, bool& continueStepping)
 {
-	SnakeDataPack& info = *(SnakeDataPack*)data;
-
 	//read output actions
 	char maxIndex = 0;
 	if (networkOutputs[1] > networkOutputs[0])
@@ -70,7 +59,7 @@ void SnakeSystem::StepOrganism(DataPack* data, const float* networkOutputs, floa
 		info.stepsLeft = std::min(info.stepsLeft + APPLE_GAIN, MAX_REMAINING_STEPS);
 		break;
 	}
-	fitness = info.body.size();
+	fitness = info.bodyLength;
 
 	info.stepsLeft--;
 	if (info.stepsLeft <= 0)
@@ -79,26 +68,17 @@ void SnakeSystem::StepOrganism(DataPack* data, const float* networkOutputs, floa
 	}
 }
 
-void SnakeSystem::SetNetworkInputs(DataPack* data, float* networkInputArray)
+void SnakeSystem::SetPackNetworkInputs(const SnakeDataPack& info, float* networkInputArray)
 {
-	SnakeDataPack& info = *(SnakeDataPack*)data;
-
-	Coord head = info.body[0];
+	Coord head = info.GetBodyPart(0);
 	auto left = AddDirectionToCoord(head, GetLocalDirection(info.movementDirection, Direction::LEFT));
 	auto right = AddDirectionToCoord(head, GetLocalDirection(info.movementDirection, Direction::RIGHT));
 	auto forward = AddDirectionToCoord(head, info.movementDirection);
 
-	//if wall is in any of the directions
-	bool isOnLeft = left.x < 0 || left.x >= GRID_SIZE || left.y < 0 || left.y >= GRID_SIZE;
-	bool isOnRight = right.x < 0 || right.x >= GRID_SIZE || right.y < 0 || right.y >= GRID_SIZE;
-	bool isInFront = forward.x < 0 || forward.x >= GRID_SIZE || forward.y < 0 || forward.y >= GRID_SIZE;
-	//if body is in any of the directions
-	for (Coord bodyPart : info.body)
-	{
-		isOnLeft |= left == bodyPart;
-		isOnRight |= right == bodyPart;
-		isInFront |= forward == bodyPart;
-	}
+	//if wall or body is in any of the directions (the bitboard is only read when inside of the grid)
+	bool isOnLeft = IsOutOfBounds(left) || info.IsOccupied(left);
+	bool isOnRight = IsOutOfBounds(right) || info.IsOccupied(right);
+	bool isInFront = IsOutOfBounds(forward) || info.IsOccupied(forward);
 
 	//if there is a bodypart or wall on left side of head
 	networkInputArray[0] = (float)isOnLeft;
@@ -169,14 +149,16 @@ void SnakeSystem::DrawGame(DataPack* data, Renderer& renderer)
 	renderer.DrawBox(glm::vec2(cellSize * (GRID_SIZE/2), cellSize * -1 ) + bottomLeft,
 		cellSize, cellSize, 0, gray);
 
-	for (auto bodyPart : info.body)
+	for (int i = 0; i < info.bodyLength; i++)
 	{
+		Coord bodyPart = info.GetBodyPart(i);
 		renderer.DrawBox(glm::vec2(cellSize * bodyPart.x, cellSize * bodyPart.y) + bottomLeft,
 			cellSize, cellSize, 0, glm::vec3(0.3f, 0.8f, 0.3f));
 	}
-	if (info.body.size() > 0)
+	if (info.bodyLength > 0)
 	{
-		renderer.DrawBox(glm::vec2(cellSize * info.body[0].x, cellSize * info.body[0].y) + bottomLeft,
+		Coord head = info.GetBodyPart(0);
+		renderer.DrawBox(glm::vec2(cellSize * head.x, cellSize * head.y) + bottomLeft,
 			cellSize, cellSize, 0, glm::vec3(0.25f, 0.7f, 0.25f));
 
 		glm::vec2 dir = { 0,0 };
@@ -198,82 +180,65 @@ void SnakeSystem::DrawGame(DataPack* data, Renderer& renderer)
 
 		float mouthSize = cellSize / 6;
 		glm::vec2 mouthAddition = { dir.x * (cellSize / 2 - mouthSize / 2), dir.y * (cellSize / 2 - mouthSize / 2) };
-		renderer.DrawBox(glm::vec2(cellSize * info.body[0].x, cellSize * info.body[0].y) + mouthAddition + bottomLeft,
+		renderer.DrawBox(glm::vec2(cellSize * head.x, cellSize * head.y) + mouthAddition + bottomLeft,
 			std::max(mouthSize, cellSize * glm::abs(dir.y)), std::max(mouthSize, cellSize * glm::abs(dir.x)), 0, glm::vec3(0.0f, 0.3f, 0.0f));
 
 		float eyeSize = cellSize / 3;
 		glm::vec2 eyeAddition = { dir.y * (cellSize/2 - eyeSize/2), dir.x * (cellSize/2 - eyeSize/2) };
-		renderer.DrawBox(glm::vec2(cellSize * info.body[0].x + eyeAddition.x, cellSize * info.body[0].y + eyeAddition.y) + bottomLeft,
+		renderer.DrawBox(glm::vec2(cellSize * head.x + eyeAddition.x, cellSize * head.y + eyeAddition.y) + bottomLeft,
 			eyeSize, eyeSize, 0, glm::vec3(0.9f, 0.9f, 0.9f));
-		renderer.DrawBox(glm::vec2(cellSize * info.body[0].x - eyeAddition.x, cellSize * info.body[0].y - eyeAddition.y) + bottomLeft,
+		renderer.DrawBox(glm::vec2(cellSize * head.x - eyeAddition.x, cellSize * head.y - eyeAddition.y) + bottomLeft,
 			eyeSize, eyeSize, 0, glm::vec3(0.9f, 0.9f, 0.9f));
 		
 		float pupilSize= cellSize / 3.3f;
 		glm::vec2 pupilAddition = { dir.y * (cellSize/2 - pupilSize /2), dir.x * (cellSize/2 - pupilSize /2) };
-		renderer.DrawBox(glm::vec2(cellSize * info.body[0].x + eyeAddition.x, cellSize * info.body[0].y + eyeAddition.y) + bottomLeft,
+		renderer.DrawBox(glm::vec2(cellSize * head.x + eyeAddition.x, cellSize * head.y + eyeAddition.y) + bottomLeft,
 			pupilSize, pupilSize, 0, glm::vec3(0,0,0));
-		renderer.DrawBox(glm::vec2(cellSize * info.body[0].x - eyeAddition.x, cellSize * info.body[0].y - eyeAddition.y) + bottomLeft,
+		renderer.DrawBox(glm::vec2(cellSize * head.x - eyeAddition.x, cellSize * head.y - eyeAddition.y) + bottomLeft,
 			pupilSize, pupilSize, 0, glm::vec3(0,0,0));
 	}
 }
 
-GameSystem::DataPack* SnakeSystem::GetDefaultDataPack()
-{
-    return &defaultDataPack;
-}
-
-GameSystem::DataPack* SnakeSystem::NewDataPack() const
-{
-    return new SnakeDataPack();
-}
-
-void SnakeSystem::CopyDataPack(DataPack* dest, DataPack* src) const
-{
-	auto destt = (SnakeDataPack*)dest;
-	*destt = *(SnakeDataPack*)src;
-}
-
 SnakeSystem::SystemState SnakeSystem::StepSystem(SnakeDataPack& system)
 {
 	//move snake in the movement direction
-	Coord newCoord = AddDirectionToCoord(system.body[0], system.movementDirection);
-
-	//if head intersects with body pos, game over
-	for (Coord pos : system.body)
-		if (pos == newCoord)
-			return SystemState::GAME_OVER;
+	Coord newCoord = AddDirectionToCoord(system.GetBodyPart(0), system.movementDirection);
 
 	//if head outside of bounds, game over
-	if (newCoord.x >= GRID_SIZE || newCoord.x < 0 || newCoord.y >= GRID_SIZE || newCoord.y < 0)
+	if (IsOutOfBounds(newCoord))
 		return SystemState::GAME_OVER;
 
+	//if head intersects with body pos, game over
+	//(the tail hasn't moved yet, so moving into it is still a collision)
+	if (system.IsOccupied(newCoord))
+		return SystemState::GAME_OVER;
 
 	//if no die add head to body
-	system.body.insert(system.body.begin(), newCoord);
+	system.PushHead(newCoord);
 	//if head intersects with apple place apple in new place
 	if (newCoord.x == system.appleCoord.x && newCoord.y == system.appleCoord.y)
 	{
 		system.amountToAdd += SIZE_GAIN;
-
-		//place apple in new place
-		bool appleIntersecting = false;
-		//loop apple placement until it isn't on body
-		do {
-			appleIntersecting = false;
-			system.appleCoord = Coord(dist(system.random), dist(system.random));
-			for (Coord pos : system.body)
-				appleIntersecting |= pos == system.appleCoord;
-		} while (appleIntersecting);
+		PlaceApple(system, system.random);
 		return SystemState::APPLE_GET;
 	}
 
 	if (system.amountToAdd <= 0)
-		system.body.pop_back();
+		system.PopTail();
 	else
 		system.amountToAdd--;
 	return SystemState::NOTHING;
 }
 
+void SnakeSystem::PlaceApple(SnakeDataPack& system, std::minstd_rand& random)
+{
+	//loop apple placement until it isn't on body
+	//each attempt is a single bitboard lookup instead of a scan through the body
+	do {
+		system.appleCoord = Coord(dist(random), dist(random));
+	} while (system.IsOccupied(system.appleCoord));
+}
+
 SnakeSystem::Direction SnakeSystem::GetLocalDirection(Direction direction, Direction relativeDirection)
 {
 	char dir = (char)direction;
@@ -314,4 +279,32 @@ SnakeSystem::Coord SnakeSystem::AddDirectionToCoord(Coord coord, Direction direc
 		break;
 	}
 	return coord;
+}
+
+bool SnakeSystem::IsOutOfBounds(Coord coord)
+{
+	return coord.x < 0 || coord.x >= GRID_SIZE || coord.y < 0 || coord.y >= GRID_SIZE;
+}
+
+void SnakeDataPack::ClearBody()
+{
+	bodyStart = 0;
+	bodyLength = 0;
+	memset(occupied, 0, sizeof(occupied));
+}
+
+void SnakeDataPack::PushHead(SnakeCoord coord)
+{
+	//the ring buffer grows backwards, so the head moves one index down
+	bodyStart = bodyStart == 0 ? MAX_BODY_SIZE - 1 : bodyStart - 1;
+	body[bodyStart] = coord;
+	bodyLength++;
+	occupied[coord.y] |= 1u << coord.x;
+}
+
+void SnakeDataPack::PopTail()
+{
+	SnakeCoord tail = GetBodyPart(bodyLength - 1);
+	occupied[tail.y] &= ~(1u << tail.x);
+	bodyLength--;
 }
\ No newline at end of file
@@ -1,8 +1,80 @@
 #pragma once
-#include "GameSystem.h"
+#include "TypedGameSystem.h"
 
+//the snake types are declared outside of SnakeSystem so it can be templated on its datapack
+struct SnakeCoord
+{
+	SnakeCoord() = default;
+	SnakeCoord(short x, short y) : x(x), y(y) {}
+	SnakeCoord operator* (const int val) {
+		return { (short)(x * val), (short)(y * val) };
+	}
+	SnakeCoord operator/ (const int val) {
+		return { (short)(x / val), (short)(y / val) };
+	}
+	SnakeCoord operator* (const float val) {
+		return { (short)(x * val), (short)(y * val) };
+	}
+	SnakeCoord operator/ (const float val) {
+		return { (short)(x / val), (short)(y / val) };
+	}
+	SnakeCoord operator+ (const SnakeCoord& other) {
+		return { x + other.x, y + other.y };
+	}
+	SnakeCoord operator- (const SnakeCoord& other) {
+		return { x - other.x, y - other.y };
+
+	}
+	bool operator== (const SnakeCoord& other) {
+		return x == other.x && y == other.y;
+	}
+	short x, y;
+};
+
+enum class SnakeDirection : char
+{
+	LEFT,
+	UP,
+	RIGHT,
+	DOWN,
+	COUNT
+};
 
-class SnakeSystem : public GameSystem
+struct SnakeDataPack : public GameSystem::DataPack
+{
+	static constexpr int GRID_SIZE = 30;
+	//the snake can never be longer than the amount of cells in the grid
+	static constexpr int MAX_BODY_SIZE = GRID_SIZE * GRID_SIZE;
+	//the occupancy bitboard uses one 32 bit row per grid row
+	static_assert(GRID_SIZE <= 32, "Grid rows must fit inside of the occupancy bitboard");
+
+	std::minstd_rand random;
+	SnakeCoord appleCoord;
+	//ring buffer of body parts, the head is at body[bodyStart] and the tail is bodyLength - 1 parts after it
+	//(fixed size so the datapack never allocates and copying it is just a memcpy)
+	SnakeCoord body[MAX_BODY_SIZE];
+	//one bit per grid cell (occupied[y] bit x), set if a body part is on that cell
+	uint32_t occupied[GRID_SIZE];
+	int bodyStart;
+	int bodyLength;
+	SnakeDirection movementDirection;
+	int stepsLeft;
+	int amountToAdd;
+
+	// index: the index of the body part (0 is the head)
+	// Returns the coordinate of the body part
+	inline SnakeCoord GetBodyPart(int index) const { return body[(bodyStart + index) % MAX_BODY_SIZE]; }
+	// Returns whether a body part is on the cell (coord must be inside of the grid)
+	inline bool IsOccupied(SnakeCoord coord) const { return (occupied[coord.y] >> coord.x) & 1u; }
+	//removes every body part
+	void ClearBody();
+	//adds a new head to the front of the body
+	void PushHead(SnakeCoord coord);
+	//removes the last body part
+	void PopTail();
+};
+
+class SnakeSystem : public TypedGameSystem<SnakeSystem, SnakeDataPack>
 {
 public:
 	static constexpr int INPUT_NODES = 4;
@@ -10,72 +82,27 @@ public:
 	static constexpr int OUTPUT_NODES = 3;
 	
 	static constexpr int APPLE_GAIN = 75;
-	static constexpr int GRID_SIZE = 30;
+	static constexpr int GRID_SIZE = SnakeDataPack::GRID_SIZE;
+	static constexpr int MAX_BODY_SIZE = SnakeDataPack::MAX_BODY_SIZE;
 	static constexpr int SIZE_GAIN = 4;
 	static constexpr int MAX_REMAINING_STEPS = 300;
 	static constexpr int STARTING_STEPS = 200;
 
-	struct Coord
-	{
-		Coord() = default;
-		Coord(short x, short y) : x(x), y(y) {}
-		Coord&& operator* (const int val) {
-			return { (short)(x * val), (short)(y * val) };
-		}
-		Coord&& operator/ (const int val) {
-			return { (short)(x / val), (short)(y / val) };
-		}
-		Coord&& operator* (const float val) {
-			return { (short)(x * val), (short)(y * val) };
-		}
-		Coord&& operator/ (const float val) {
-			return { (short)(x / val), (short)(y / val) };
-		}
-		Coord&& operator+ (const Coord& other) {
-			return { x + other.x, y + other.y };
-		}
-		Coord&& operator- (const Coord& other) {
-			return { x - other.x, y - other.y };
-
-		}
-		bool operator== (const Coord& other) {
-			return x == other.x && y == other.y;
-		}
-		short x, y;
-	};
-	enum class Direction : char
-	{
-		LEFT,
-		UP,
-		RIGHT,
-		DOWN,
-		COUNT
-	};
-	struct SnakeDataPack : public DataPack
-	{
-		std::minstd_rand random;
-		Coord appleCoord;
-		std::vector<Coord> body;
-		Direction movementDirection;
-		int stepsLeft;
-		int amountToAdd;
-
-		virtual ~SnakeDataPack() = default;
-	};
+	using Coord = SnakeCoord;
+	using Direction = SnakeDirection;
 
 	SnakeSystem();
 	virtual ~SnakeSystem() = default;
 
+	// Used by TypedGameSystem
+	void StepPack(SnakeDataPack& info, const float* networkOutputs, float& fitness, bool& continueStepping);
+	void SetPackNetworkInputs(const SnakeDataPack& info, float* networkInputArray);
+
 	// Inherited via GameSystem
 	virtual void SetDefaultDataPack(std::minstd_rand& random) override;
-	virtual void StepOrganism(DataPack* data, const float* networkOutputs, float& fitness, bool& continueStepping) override;
-	virtual void SetNetworkInputs(DataPack* data, float* networkInputArray) override;
 	virtual void ResetManualOutput() override;
 	virtual void OnKeyPressed(Renderer& renderer, int keycode, int action, bool manual) override;
 	virtual void DrawGame(DataPack* data, Renderer& renderer) override;
-	virtual DataPack* GetDefaultDataPack() override;
-	virtual DataPack* NewDataPack() const override;
-	virtual void CopyDataPack(DataPack* dest, DataPack* src) const override;
 	virtual int GetInputCount() const override { return INPUT_NODES; }
 	virtual int GetOutputCount() const override { return OUTPUT_NODES; }
 	virtual int GetDefaultHiddenNodes() const override { return DEFAULT_HIDDEN_NODES; }
@@ -91,9 +118,11 @@ private:
 	SystemState StepSystem(SnakeDataPack& system);
 	static Direction GetLocalDirection(Direction direction, Direction relativeDirection);
 	static Coord AddDirectionToCoord(Coord coord, Direction direction);
+	static bool IsOutOfBounds(Coord coord);
+	//places the apple on a random cell that isn't occupied by the body
+	void PlaceApple(SnakeDataPack& system, std::minstd_rand& random);
 
 	std::minstd_rand random;
 	std::uniform_int_distribution<short> dist = std::uniform_int_distribution<short>(0, GRID_SIZE - 1);
-	SnakeDataPack defaultDataPack;
 };
 
@@ -0,0 +1,89 @@
+#pragma once
+#include "GameSystem.h"
+#include <type_traits>
+#include <cstring>
+
+//game system base templated on the system (Derived) and its datapack type (Pack)
+//every organism's datapack is stored in one contiguous array, and StepOrganismAt steps them without any virtual calls
+//the DataPack* functions from GameSystem are implemented here as a type erased version, used by the ui
+//
+//Derived needs to implement:
+//	void StepPack(Pack& data, const float* networkOutputs, float& fitness, bool& continueStepping);
+//	void SetPackNetworkInputs(const Pack& data, float* networkInputArray);
+template<typename Derived, typename Pack>
+class TypedGameSystem : public GameSystem
+{
+public:
+	// Steps the datapack of an organism and then sets its network inputs
+	// organismIndex: the index of the organism's datapack (set up with SetupDataPacks)
+	inline void StepOrganismAt(int organismIndex, const float* networkOutputs, float& fitness, bool& continueStepping, float* networkInputArray)
+	{
+		Pack& data = dataPacks[organismIndex];
+		Self().StepPack(data, networkOutputs, fitness, continueStepping);
+		Self().SetPackNetworkInputs(data, networkInputArray);
+	}
+
+	//copies src into dest (just a memcpy if the datapack is trivially copyable)
+	static inline void CopyPack(Pack& dest, const Pack& src)
+	{
+		if constexpr (std::is_trivially_copyable_v<Pack>)
+			memcpy(&dest, &src, sizeof(Pack));
+		else
+			dest = src;
+	}
+
+	// Inherited via GameSystem
+	virtual void StepOrganism(DataPack* data, const float* networkOutputs, float& fitness, bool& continueStepping) override final
+	{
+		Self().StepPack(*static_cast<Pack*>(data), networkOutputs, fitness, continueStepping);
+	}
+	virtual void SetNetworkInputs(DataPack* data, float* networkInputArray) override final
+	{
+		Self().SetPackNetworkInputs(*static_cast<Pack*>(data), networkInputArray);
+	}
+	virtual void SetupDataPacks(int populationSize) override
+	{
+		dataPacks = std::vector<Pack>(populationSize);
+	}
+	virtual void ResetDataPacks(nlv::NetworkOrganism* organisms, int populationSize) override
+	{
+		for (int i = 0; i < populationSize; i++)
+		{
+			CopyPack(dataPacks[i], defaultDataPack);
+			Self().SetPackNetworkInputs(dataPacks[i], organisms[i].GetNetworkInputArray());
+		}
+	}
+	virtual void SetupReplicas(std::minstd_rand& random, int replicaCount) override
+	{
+		replicaDataPacks.resize(replicaCount);
+		for (int i = 0; i < replicaCount; i++)
+		{
+			SetDefaultDataPack(random);
+			CopyPack(replicaDataPacks[i], defaultDataPack);
+		}
+	}
+	virtual void ResetDataPack(nlv::NetworkOrganism& organism, int organismIndex, int replicaIndex) override
+	{
+		Pack& data = dataPacks[organismIndex];
+		CopyPack(data, replicaDataPacks[replicaIndex]);
+		Self().SetPackNetworkInputs(data, organism.GetNetworkInputArray());
+	}
+	virtual DataPack* GetDefaultDataPack() override final { return &defaultDataPack; }
+	virtual DataPack* NewDataPack() const override final { return new Pack(); }
+	virtual void DeleteDataPack(DataPack* data) const override final { delete static_cast<Pack*>(data); }
+	virtual void CopyDataPack(DataPack* dest, DataPack* src) const override final
+	{
+		CopyPack(*static_cast<Pack*>(dest), *static_cast<const Pack*>(src));
+	}
+
+protected:
+	//the datapack every organism starts an episode with
+	Pack defaultDataPack;
+	//the datapack of every organism in the population
+	std::vector<Pack> dataPacks;
+	//the default datapack of every replica
+	std::vector<Pack> replicaDataPacks;
+
+private:
+	inline Derived& Self() { return static_cast<Derived&>(*this); }
+};
@@ -0,0 +1,228 @@
+#include "EvolutionStrategy.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nlv
+{
+	//std::normal_distribution isn't the same on every compiler, so noise is made with a splitmix generator and box-muller instead
+	//that way a perturbation made from a seed is always the same
+	static inline uint64_t SplitMix(uint64_t& state)
+	{
+		uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	//between 0 (exclusive) and 1
+	static inline double UniformOpen(uint64_t& state)
+	{
+		return ((SplitMix(state) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+	}
+
+	void EvolutionStrategy::Initialize(EvolverOptimizerType type, const float* mean, uint32_t geneCount, uint32_t populationSize, float sigma, float learningRate, uint32_t seed)
+	{
+		if (type == EvolverOptimizerType::Genetic)
+			throw std::runtime_error("Evolution strategy needs to be a strategy type");
+		if (populationSize < 2)
+			throw std::runtime_error("Evolution strategies need a population of at least 2");
+
+		this->type = type;
+		this->geneCount = geneCount;
+		this->populationSize = populationSize;
+		this->sigma = sigma;
+		this->learningRate = learningRate;
+		generation = 0;
+		uint64_t seedState = seed;
+		generationSeed = SplitMix(seedState);
+
+		this->mean.assign(mean, mean + geneCount);
+		noise.resize(geneCount);
+		genes.resize(geneCount);
+		accumulator.resize(geneCount);
+		ranks.resize(populationSize);
+		utilities.resize(populationSize);
+
+		if (type == EvolverOptimizerType::SeparableCMAES)
+		{
+			variances.assign(geneCount, 1.0f);
+			sigmaPath.assign(geneCount, 0.0f);
+			covariancePath.assign(geneCount, 0.0f);
+			squareAccumulator.resize(geneCount);
+
+			//log weights for the best half of the population
+			uint32_t mu = populationSize / 2;
+			weights.resize(mu);
+			float weightSum = 0;
+			for (uint32_t i = 0; i < mu; i++)
+			{
+				weights[i] = std::log(mu + 0.5f) - std::log(i + 1.0f);
+				weightSum += weights[i];
+			}
+			for (auto& weight : weights)
+				weight /= weightSum;
+		}
+	}
+
+	void EvolutionStrategy::GenerateNoise(uint64_t seed, float* noise) const
+	{
+		uint64_t state = seed;
+		for (uint32_t i = 0; i < geneCount; i += 2)
+		{
+			double radius = std::sqrt(-2.0 * std::log(UniformOpen(state)));
+			double angle = 6.283185307179586 * UniformOpen(state);
+			noise[i] = (float)(radius * std::cos(angle));
+			if (i + 1 < geneCount)
+				noise[i + 1] = (float)(radius * std::sin(angle));
+		}
+	}
+
+	void EvolutionStrategy::Sample(NetworkOrganism* organisms)
+	{
+		switch (type)
+		{
+		case EvolverOptimizerType::NaturalEvolutionStrategy:
+		{
+			//antithetic pairs: organism 2k is mean + sigma * noise and organism 2k + 1 is mean - sigma * noise, with the same noise
+			uint32_t pairCount = populationSize / 2;
+			for (uint32_t k = 0; k < pairCount; k++)
+			{
+				GenerateNoise(GetPerturbationSeed(k), noise.data());
+				for (uint32_t i = 0; i < geneCount; i++)
+					genes[i] = mean[i] + sigma * noise[i];
+				organisms[2 * k].network.SetGenes(genes.data());
+				for (uint32_t i = 0; i < geneCount; i++)
+					genes[i] = mean[i] - sigma * noise[i];
+				organisms[2 * k + 1].network.SetGenes(genes.data());
+			}
+			//with an odd population the last organism is the unperturbed mean, so its fitness can be watched
+			if (populationSize % 2 != 0)
+				organisms[populationSize - 1].network.SetGenes(mean.data());
+			break;
+		}
+		case EvolverOptimizerType::SeparableCMAES:
+			for (uint32_t k = 0; k < populationSize; k++)
+			{
+				GenerateNoise(GetPerturbationSeed(k), noise.data());
+				for (uint32_t i = 0; i < geneCount; i++)
+					genes[i] = mean[i] + sigma * std::sqrt(variances[i]) * noise[i];
+				organisms[k].network.SetGenes(genes.data());
+			}
+			break;
+		default:
+			throw std::runtime_error("Evolution strategy was not initialized");
+		}
+	}
+
+	void EvolutionStrategy::Update(const NetworkOrganism* organisms)
+	{
+		switch (type)
+		{
+		case EvolverOptimizerType::NaturalEvolutionStrategy:
+			UpdateNaturalEvolutionStrategy(organisms);
+			break;
+		case EvolverOptimizerType::SeparableCMAES:
+			UpdateSeparableCMAES(organisms);
+			break;
+		default:
+			throw std::runtime_error("Evolution strategy was not initialized");
+		}
+
+		//the next generation gets new perturbations
+		uint64_t seedState = generationSeed;
+		generationSeed = SplitMix(seedState);
+		generation++;
+	}
+
+	void EvolutionStrategy::UpdateNaturalEvolutionStrategy(const NetworkOrganism* organisms)
+	{
+		uint32_t pairCount = populationSize / 2;
+		uint32_t sampleCount = pairCount * 2;
+
+		//rank based fitness shaping: fitness is replaced by its centered rank between -0.5 and 0.5, so the update doesn't depend on the scale of fitness
+		for (uint32_t i = 0; i < sampleCount; i++)
+			ranks[i] = i;
+		std::sort(ranks.begin(), ranks.begin() + sampleCount, [organisms](uint32_t a, uint32_t b) { return organisms[a].fitness < organisms[b].fitness; });
+		for (uint32_t r = 0; r < sampleCount; r++)
+			utilities[ranks[r]] = (float)r / (sampleCount - 1) - 0.5f;
+
+		//gradient estimate: sum of (utility of + noise - utility of - noise) * noise, with the noise regenerated from each pair's seed
+		std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+		for (uint32_t k = 0; k < pairCount; k++)
+		{
+			float difference = utilities[2 * k] - utilities[2 * k + 1];
+			if (difference == 0)
+				continue;
+			GenerateNoise(GetPerturbationSeed(k), noise.data());
+			for (uint32_t i = 0; i < geneCount; i++)
+				accumulator[i] += difference * noise[i];
+		}
+
+		float scale = learningRate / (sampleCount * sigma);
+		for (uint32_t i = 0; i < geneCount; i++)
+			mean[i] += scale * accumulator[i];
+	}
+
+	void EvolutionStrategy::UpdateSeparableCMAES(const NetworkOrganism* organisms)
+	{
+		//constants from the separable CMA-ES paper (Ros and Hansen, 2008)
+		double n = geneCount;
+		uint32_t mu = (uint32_t)weights.size();
+		double weightSquareSum = 0;
+		for (float weight : weights)
+			weightSquareSum += (double)weight * weight;
+		double mueff = 1.0 / weightSquareSum;
+		double cs = (mueff + 2) / (n + mueff + 5);
+		double ds = 1 + 2 * std::max(0.0, std::sqrt((mueff - 1) / (n + 1)) - 1) + cs;
+		double cc = (4 + mueff / n) / (n + 4 + 2 * mueff / n);
+		//the learning rates can be (n + 2) / 3 times bigger than full CMA-ES since only the diagonal is learned
+		double c1 = 2 / ((n + 1.3) * (n + 1.3) + mueff) * (n + 2) / 3;
+		double cmu = std::min(1 - c1, 2 * (mueff - 2 + 1 / mueff) / ((n + 2) * (n + 2) + mueff) * (n + 2) / 3);
+		//expected length of a standard normal vector
+		double chiN = std::sqrt(n) * (1 - 1 / (4 * n) + 1 / (21 * n * n));
+
+		//the best mu organisms, best first
+		for (uint32_t i = 0; i < populationSize; i++)
+			ranks[i] = i;
+		std::partial_sort(ranks.begin(), ranks.begin() + mu, ranks.end(), [organisms](uint32_t a, uint32_t b) { return organisms[a].fitness > organisms[b].fitness; });
+
+		//weighted mean of the best noise (accumulator) and of the best squared steps (squareAccumulator)
+		std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+		std::fill(squareAccumulator.begin(), squareAccumulator.end(), 0.0f);
+		for (uint32_t r = 0; r < mu; r++)
+		{
+			GenerateNoise(GetPerturbationSeed(ranks[r]), noise.data());
+			for (uint32_t i = 0; i < geneCount; i++)
+			{
+				accumulator[i] += weights[r] * noise[i];
+				squareAccumulator[i] += weights[r] * variances[i] * noise[i] * noise[i];
+			}
+		}
+
+		double sigmaPathScale = std::sqrt(cs * (2 - cs) * mueff);
+		double sigmaPathLength = 0;
+		for (uint32_t i = 0; i < geneCount; i++)
+		{
+			//(for a diagonal covariance C^-1/2 * step is just the weighted noise)
+			sigmaPath[i] = (float)((1 - cs) * sigmaPath[i] + sigmaPathScale * accumulator[i]);
+			sigmaPathLength += (double)sigmaPath[i] * sigmaPath[i];
+		}
+		sigmaPathLength = std::sqrt(sigmaPathLength);
+
+		//stops the covariance path from growing while the step size is increasing quickly
+		bool stalled = sigmaPathLength / std::sqrt(1 - std::pow(1 - cs, 2.0 * (generation + 1))) >= (1.4 + 2 / (n + 1)) * chiN;
+		double covariancePathScale = stalled ? 0 : std::sqrt(cc * (2 - cc) * mueff);
+		double stalledCorrection = stalled ? c1 * cc * (2 - cc) : 0;
+
+		for (uint32_t i = 0; i < geneCount; i++)
+		{
+			float step = std::sqrt(variances[i]) * accumulator[i];
+			mean[i] += sigma * step;
+			covariancePath[i] = (float)((1 - cc) * covariancePath[i] + covariancePathScale * step);
+			variances[i] = (float)((1 - c1 - cmu + stalledCorrection) * variances[i] + c1 * covariancePath[i] * covariancePath[i] + cmu * squareAccumulator[i]);
+		}
+
+		sigma *= (float)std::exp(cs / ds * (sigmaPathLength / chiN - 1));
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "EvolverEnums.h"
+#include <vector>
+
+namespace nlv
+{
+	//the state of an evolution strategy used by NetworkEvolver instead of selection, crossover and mutation
+	//only the mean (and for CMA-ES the variances and evolution paths) are stored, so the state is O(genes)
+	//the perturbation of every organism is regenerated from a seed whenever it is needed instead of being stored
+	class EvolutionStrategy
+	{
+	public:
+		EvolutionStrategy() = default;
+
+		// type: NaturalEvolutionStrategy or SeparableCMAES
+		// mean: the genes the search starts from
+		// sigma: the starting standard deviation of perturbations
+		// learningRate: how far the mean moves along the estimated gradient every generation (only used by NaturalEvolutionStrategy)
+		// seed: used to make the seeds of every generation
+		void Initialize(EvolverOptimizerType type, const float* mean, uint32_t geneCount, uint32_t populationSize, float sigma, float learningRate, uint32_t seed);
+
+		// Sets the genes of every organism to a new perturbation of the mean
+		void Sample(NetworkOrganism* organisms);
+		// Moves the mean (and adapts the distribution) based on the fitness of the organisms from the last Sample
+		void Update(const NetworkOrganism* organisms);
+
+		inline const std::vector<float>& GetMean() const { return mean; }
+		inline float GetSigma() const { return sigma; }
+		inline float GetLearningRate() const { return learningRate; }
+		inline void SetSigma(float value) { sigma = value; }
+		inline void SetLearningRate(float rate) { learningRate = rate; }
+
+	private:
+		//fills noise with the perturbation made from the seed (a standard normal value for every gene)
+		void GenerateNoise(uint64_t seed, float* noise) const;
+		// Returns the seed of a perturbation in the current generation
+		inline uint64_t GetPerturbationSeed(uint32_t index) const { return generationSeed + (index + 1) * 0x9E3779B97F4A7C15ULL; }
+		void UpdateNaturalEvolutionStrategy(const NetworkOrganism* organisms);
+		void UpdateSeparableCMAES(const NetworkOrganism* organisms);
+
+		EvolverOptimizerType type = EvolverOptimizerType::Genetic;
+		uint32_t geneCount = 0;
+		uint32_t populationSize = 0;
+		float sigma = 0;
+		float learningRate = 0;
+		//the seed every perturbation in the current generation is made from
+		uint64_t generationSeed = 0;
+		uint32_t generation = 0;
+
+		std::vector<float> mean;
+		//separable CMA-ES: the diagonal of the covariance matrix and the evolution paths
+		std::vector<float> variances;
+		std::vector<float> sigmaPath;
+		std::vector<float> covariancePath;
+		//recombination weights of the best half of the population
+		std::vector<float> weights;
+		//reused every generation so updates don't allocate
+		std::vector<float> noise;
+		std::vector<float> genes;
+		std::vector<float> accumulator;
+		std::vector<float> squareAccumulator;
+		std::vector<uint32_t> ranks;
+		std::vector<float> utilities;
+	};
+}
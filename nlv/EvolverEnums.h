@@ -5,10 +5,22 @@ namespace nlv
 {
 	//callback that is called every episode for each organism in a loop until organism.continueStepping evaluates to false
 	typedef void(*EvolverStepCallback)(const NetworkEvolver& evolver, NetworkOrganism& organism, int organismIndex);
+	//callback that is called every step of an episode with a range of organisms [startIndex, endIndex), used instead of EvolverStepCallback when set
+	//organisms in the range are stepped in lockstep, organisms where continueStepping is false or the steps taken is at least maxSteps should be ignored
+	typedef void(*EvolverBatchStepCallback)(const NetworkEvolver& evolver, NetworkOrganism* organisms, uint32_t startIndex, uint32_t endIndex);
+	//callback that is called before every replica of an organism's episode when the evolver uses more than one replica
+	//allows the user to set up the organism's environment for that replica (e.g. using a different seed for every replicaIndex) and set its network inputs
+	typedef void(*EvolverReplicaCallback)(const NetworkEvolver& evolver, NetworkOrganism& organism, int organismIndex, uint32_t replicaIndex);
+	//callback called before an organism created during steady state evolution is evaluated, allows the user to reset its environment and set its network inputs
+	typedef void(*EvolverOrganismCallback)(const NetworkEvolver& evolver, NetworkOrganism& organism, int organismIndex);
+	//callback used by NetworkRemoteWorker to run a whole episode for one organism in a worker process
+	//network already has the organism's genes, the callback should set fitness and steps (which should be at most maxSteps)
+	typedef void(*EvolverRemoteEpisodeCallback)(Network& network, uint32_t organismIndex, uint32_t generation, uint32_t maxSteps, float& fitness, uint32_t& steps, void* userPointer);
 	//used for two callbacks, one called at the start of an episode and one called at the end of an episode
 	typedef void(*EvolverGenerationCallback)(const NetworkEvolver& evolver, NetworkOrganism* organisms);
 	//used for custom crossover implementations
-	typedef void(*EvolverCustomCrossoverCallback)(float* childGenes, const NetworkOrganism& p1, const NetworkOrganism& p2, float* p1Genes, float* p2Genes);
+	//childGenes starts as a copy of p1's genes. the parent genes are read only, they can point at the parents' own genes or at the evolver's widened gene buffer
+	typedef void(*EvolverCustomCrossoverCallback)(float* childGenes, const NetworkOrganism& p1, const NetworkOrganism& p2, const float* p1Genes, const float* p2Genes);
 	//used for custom mutation implementations
 	typedef void(*EvolverCustomMutationCallback)(float* genes, const NetworkOrganism& organism);
 	//used for custom selection implementations
@@ -41,6 +53,26 @@ namespace nlv
 		Custom
 	};
 
+	// The algorithm used to create new generations
+	enum class EvolverOptimizerType : char
+	{
+		// Selection, crossover and mutation
+		Genetic,
+		// OpenAI style evolution strategy: the mean genome moves along a gradient estimated from antithetic gaussian perturbations, with rank based fitness shaping
+		NaturalEvolutionStrategy,
+		// CMA-ES that only adapts the diagonal of the covariance matrix, so it stays O(genes)
+		SeparableCMAES
+	};
+
+	// Which organism a new child replaces during steady state evolution
+	enum class EvolverReplacementType : char
+	{
+		// The child replaces the organism with the lowest fitness
+		Worst,
+		// A tournament is performed on the population, the child replaces the loser
+		Tournament
+	};
+
 	// How two parents from the previous generation are crossed over to create a child network
 	enum class EvolverCrossoverType : char
 	{
@@ -58,4 +90,24 @@ namespace nlv
 		// Calls a custom crossover function
 		Custom
 	};
+
+	// When every organism is evaluated over multiple replicas (episodes with different seeds), this decides how their fitness values are combined
+	enum class EvolverFitnessReduction : char
+	{
+		// The average fitness of the replicas
+		Mean,
+		// The lowest fitness of the replicas (organisms are only as good as their unluckiest episode)
+		Min,
+		// The fitness at a percentile of the replicas (0.5 is the median)
+		Percentile
+	};
+
+	// Which islands migrants are sent to in an island evolver
+	enum class EvolverMigrationTopology : char
+	{
+		// Every island sends migrants to the next island (the last island sends to the first)
+		Ring,
+		// Every island sends migrants to every other island
+		FullyConnected
+	};
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <chrono>
+
+//NetworkEvolver only collects stats if NLV_STATS is defined (add it to the preprocessor definitions of everything that includes nlv)
+//without it the timing code is compiled out and GetStats() is always empty
+#ifdef NLV_STATS
+#define NLV_STATS_ONLY(...) __VA_ARGS__
+#else
+#define NLV_STATS_ONLY(...)
+#endif
+
+namespace nlv
+{
+	//how a thread running episodes spent the generation
+	struct EvolverThreadStats
+	{
+		// Time spent running episodes
+		uint64_t busyNanoseconds = 0;
+		// Time spent waiting for the other threads to finish (or for the steady state lock)
+		uint64_t idleNanoseconds = 0;
+		// The number of organisms the thread ran episodes for
+		uint32_t organisms = 0;
+	};
+
+	//counters collected by NetworkEvolver over the last generation (or the last EvaluateSteadyState call)
+	//times summed over threads can add up to more than the time the generation took
+	struct EvolverStats
+	{
+		//CreateNewGen phases
+		// Sorting organisms by fitness
+		uint64_t sortNanoseconds = 0;
+		// Copying the elite, selecting parents and crossover
+		uint64_t selectionNanoseconds = 0;
+		// Mutating children (and their connection masks)
+		uint64_t mutationNanoseconds = 0;
+		// Allocating the new organism array and destroying the last one
+		uint64_t allocationNanoseconds = 0;
+		// Updating and sampling the evolution strategy (instead of the phases above)
+		uint64_t strategyNanoseconds = 0;
+
+		//Episode
+		// The time the whole episode took
+		uint64_t episodeNanoseconds = 0;
+		// Time spent evaluating networks (summed over threads)
+		uint64_t forwardPassNanoseconds = 0;
+		// Time spent in the step callback (summed over threads)
+		uint64_t stepNanoseconds = 0;
+		// The number of times a network was evaluated
+		uint64_t forwardPasses = 0;
+		// The number of steps organisms took
+		uint64_t steps = 0;
+		// The number of organisms that ran an episode
+		uint32_t organismsEvaluated = 0;
+		// The number of organisms that didn't need to (the elite when episodes are static)
+		uint32_t organismsSkipped = 0;
+		// One for every thread that ran episodes
+		std::vector<EvolverThreadStats> threads;
+	};
+
+	//a summary of the population after a generation's episode, kept by NetworkEvolver in a bounded history (see NetworkEvolver::SetPopulationStatsHistory)
+	struct EvolverPopulationStats
+	{
+		// The generation the stats are for
+		uint32_t generation = 0;
+		// The number of organisms in the generation (it can change between generations, see NetworkEvolver::SetPopulationSize)
+		uint32_t populationSize = 0;
+		// The index of the organism with the highest fitness
+		uint32_t bestIndex = 0;
+		float minFitness = 0;
+		float maxFitness = 0;
+		float meanFitness = 0;
+		float fitnessVariance = 0;
+		// The 10th, 25th, 50th, 75th and 90th percentile of fitness
+		float fitnessQuantiles[5] = {};
+		float meanSteps = 0;
+		// The percentage of organisms that stopped stepping before maxSteps
+		float earlyTerminationRate = 0;
+		// The mean standard deviation of every gene over the population (0 if every organism has the same genes)
+		float diversity = 0;
+	};
+
+	//a copy of the population's results that is published after every generation (see NetworkEvolver::GetSnapshot)
+	//snapshots never change once they are published, so other threads can read them while the evolver keeps running
+	struct EvolverSnapshot
+	{
+		// The generation the snapshot was taken after
+		uint32_t generation = 0;
+		uint32_t geneCount = 0;
+		// The fitness and steps taken of every organism
+		std::vector<float> fitness;
+		std::vector<uint32_t> steps;
+		// The indexes of the best organisms, highest fitness first
+		std::vector<uint32_t> bestIndexes;
+		// The genes of the best organisms, geneCount floats for each one in the same order as bestIndexes
+		std::vector<float> bestGenes;
+
+		// rank: 0 is the best organism, 1 the second best and so on
+		inline const float* GetBestGenes(uint32_t rank) const { return bestGenes.data() + (size_t)rank * geneCount; }
+	};
+
+	//what a range of organisms adds to EvolverStats, kept by the thread running it and added once the range is done
+	struct EvolverEpisodeCounters
+	{
+		uint64_t forwardPassNanoseconds = 0;
+		uint64_t stepNanoseconds = 0;
+		uint64_t forwardPasses = 0;
+		uint64_t steps = 0;
+		uint32_t organisms = 0;
+	};
+
+	namespace timing
+	{
+		inline uint64_t Now()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		// Returns the time since start and moves start to now
+		inline uint64_t Lap(uint64_t& start)
+		{
+			uint64_t now = Now();
+			uint64_t elapsed = now - start;
+			start = now;
+			return elapsed;
+		}
+	}
+}
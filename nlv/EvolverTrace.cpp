@@ -0,0 +1,94 @@
+#include "EvolverTrace.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+namespace nlv
+{
+	thread_local uint32_t EvolverTrace::currentLane = 0;
+
+	EvolverTrace::EvolverTrace(size_t reserveEvents)
+		: reserveEvents(reserveEvents), startTime(timing::Now())
+	{
+		PrepareLanes(0);
+	}
+
+	void EvolverTrace::Clear()
+	{
+		//(keeps the lanes' memory around for the next run)
+		for (auto& lane : lanes)
+			lane.clear();
+		startTime = timing::Now();
+	}
+
+	size_t EvolverTrace::GetEventCount() const
+	{
+		size_t count = 0;
+		for (auto& lane : lanes)
+			count += lane.size();
+		return count;
+	}
+
+	void EvolverTrace::PrepareLanes(uint32_t threadCount)
+	{
+		while (lanes.size() < (size_t)threadCount + 1)
+		{
+			lanes.emplace_back();
+			lanes.back().reserve(reserveEvents);
+		}
+	}
+
+	bool EvolverTrace::SaveToFile(std::string filename) const
+	{
+		std::ofstream file(filename);
+		if (!file.is_open())
+			return false;
+
+		bool success = Save(file);
+
+		file.close();
+		return success;
+	}
+
+	std::string EvolverTrace::SaveToString() const
+	{
+		std::stringstream ss;
+		Save(ss);
+		return ss.str();
+	}
+
+	bool EvolverTrace::Save(std::ostream& stream) const
+	{
+		//chrome trace times are in microseconds
+		stream << std::fixed << std::setprecision(3);
+		stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+		//name the lanes
+		for (size_t l = 0; l < lanes.size(); l++)
+		{
+			if (l != 0)
+				stream << ",\n";
+			stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << l << ",\"args\":{\"name\":\"";
+			if (l == 0)
+				stream << "Evolver";
+			else
+				stream << "Episode thread " << l - 1;
+			stream << "\"}}";
+		}
+
+		//every event is a complete event (with a duration) so begin and end can't be mismatched
+		for (size_t l = 0; l < lanes.size(); l++)
+		{
+			for (const Event& event : lanes[l])
+			{
+				stream << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << l
+					<< ",\"ts\":" << (event.start - startTime) * 0.001 << ",\"dur\":" << (event.end - event.start) * 0.001;
+				if (event.startIndex != NO_INDEX)
+					stream << ",\"args\":{\"start\":" << event.startIndex << ",\"end\":" << event.endIndex << "}";
+				stream << "}";
+			}
+		}
+		stream << "\n]}\n";
+		return stream.good();
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "EvolverStats.h"
+#include <string>
+#include <ostream>
+#include <stdexcept>
+
+namespace nlv
+{
+	class NetworkEvolver;
+
+	//records what a NetworkEvolver's threads were doing (generation phases, organism ranges, organism episodes and user callbacks)
+	//and saves it as chrome trace json, which can be opened in chrome://tracing or ui.perfetto.dev to see load imbalance between threads
+	//every thread writes into its own lane, so recording doesn't lock. a trace should only be used by one evolver at a time
+	class EvolverTrace
+	{
+	public:
+		// reserveEvents: the number of events each lane reserves space for (lanes still grow past it)
+		EvolverTrace(size_t reserveEvents = 1 << 14);
+		EvolverTrace(const EvolverTrace& other) = delete;
+		EvolverTrace& operator=(const EvolverTrace& other) = delete;
+
+		// Removes every event and restarts the trace's clock
+		void Clear();
+
+		// Saves the trace as chrome trace json
+		// Returns whether the save succeeded or failed
+		bool SaveToFile(std::string filename) const;
+		// Returns a string containing the chrome trace json
+		std::string SaveToString() const;
+
+		// Returns the number of events recorded over every lane
+		size_t GetEventCount() const;
+
+	private:
+		friend NetworkEvolver;
+
+		static constexpr uint32_t NO_INDEX = UINT32_MAX;
+
+		struct Event
+		{
+			//always a string literal, so events don't copy names
+			const char* name;
+			uint64_t start;
+			uint64_t end;
+			//the organisms the event was for [startIndex, endIndex), NO_INDEX if it wasn't for organisms
+			uint32_t startIndex;
+			uint32_t endIndex;
+		};
+
+		//records an event for the time a scope was alive (does nothing if the trace is nullptr)
+		struct Scope
+		{
+			inline Scope(EvolverTrace* trace, const char* name, uint32_t startIndex = NO_INDEX, uint32_t endIndex = NO_INDEX)
+				: trace(trace), name(name), startIndex(startIndex), endIndex(endIndex), start(trace ? timing::Now() : 0) {}
+			inline ~Scope() { if (trace) trace->Add(name, start, timing::Now(), startIndex, endIndex); }
+			Scope(const Scope& other) = delete;
+			Scope& operator=(const Scope& other) = delete;
+
+			EvolverTrace* trace;
+			const char* name;
+			uint32_t startIndex;
+			uint32_t endIndex;
+			uint64_t start;
+		};
+
+		// Makes sure there is a lane for the evolver thread and every one of threadCount episode threads
+		// Lanes are only added here, so this can't be called while episode threads are running
+		void PrepareLanes(uint32_t threadCount);
+		// Sets the lane events from the calling thread go into (0 is the evolver thread, episode threads start at 1)
+		static inline void SetLane(uint32_t lane) { currentLane = lane; }
+		inline void Add(const char* name, uint64_t start, uint64_t end, uint32_t startIndex = NO_INDEX, uint32_t endIndex = NO_INDEX)
+		{
+#ifdef _DEBUG
+			if (currentLane >= lanes.size())
+				throw std::runtime_error("Trace lane was not prepared");
+#endif
+			lanes[currentLane].push_back({ name, start, end, startIndex, endIndex });
+		}
+		// Records an event from start to now and moves start to now
+		inline void Lap(const char* name, uint64_t& start)
+		{
+			uint64_t now = timing::Now();
+			Add(name, start, now);
+			start = now;
+		}
+
+		bool Save(std::ostream& stream) const;
+
+		std::vector<std::vector<Event>> lanes;
+		size_t reserveEvents;
+		//event times are saved relative to this
+		uint64_t startTime;
+		//the lane of the calling thread
+		static thread_local uint32_t currentLane;
+	};
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+
+namespace nlv
+{
+	//genes can be stored in pages that networks share until one of them writes to a page (copy on write)
+	//copying a network then only copies its page pointers, and changing a gene only copies the page it is on if another network still uses it
+	namespace pages
+	{
+		//1024 genes (4KB) per page
+		constexpr uint32_t PAGE_SHIFT = 10;
+		constexpr uint32_t PAGE_GENES = 1 << PAGE_SHIFT;
+		constexpr uint32_t PAGE_MASK = PAGE_GENES - 1;
+
+		struct GenePage
+		{
+			//the number of networks using the page (atomic, networks sharing it can be copied or changed on different threads)
+			std::atomic<uint32_t> references;
+			float genes[PAGE_GENES];
+		};
+
+		// Returns the number of pages geneCount genes are stored in (the last page can be partly unused)
+		inline uint32_t GetPageCount(uint32_t geneCount)
+		{
+			return (geneCount + PAGE_MASK) >> PAGE_SHIFT;
+		}
+
+		// Returns a new page that only the caller uses (its genes aren't set)
+		inline GenePage* Allocate()
+		{
+			GenePage* page = new GenePage;
+			page->references.store(1, std::memory_order_relaxed);
+			return page;
+		}
+
+		// Adds a user to the page and returns it
+		inline GenePage* Share(GenePage* page)
+		{
+			page->references.fetch_add(1, std::memory_order_relaxed);
+			return page;
+		}
+
+		// Removes a user from the page, deleting it when it was the last one (does nothing for nullptr)
+		inline void Release(GenePage* page)
+		{
+			if (page && page->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				delete page;
+		}
+
+		// Returns a page with the same genes that only the caller uses, copying the page if anyone else uses it
+		inline GenePage* Unshare(GenePage* page)
+		{
+			if (page->references.load(std::memory_order_acquire) == 1)
+				return page;
+			GenePage* copy = Allocate();
+			memcpy(copy->genes, page->genes, sizeof(page->genes));
+			Release(page);
+			return copy;
+		}
+	}
+}
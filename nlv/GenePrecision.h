@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+namespace nlv
+{
+	//how a network stores its genes
+	//16 bit genes halve the memory (and memory bandwidth) used by a population, values are widened to floats when they are read and rounded when they are written
+	enum class GenePrecision : uint8_t
+	{
+		// 32 bit floats
+		Float32,
+		// IEEE half precision floats (10 bit mantissa, but the largest value is 65504)
+		Float16,
+		// brain floats (the top 16 bits of a float, so the range of a float with an 8 bit mantissa)
+		BFloat16
+	};
+
+	namespace precision
+	{
+		inline uint32_t FloatBits(float value)
+		{
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		inline float BitsFloat(uint32_t bits)
+		{
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		inline uint16_t FloatToBFloat16(float value)
+		{
+			uint32_t bits = FloatBits(value);
+			//keep nans as nans (rounding could turn them into infinity)
+			if ((bits & 0x7FFFFFFF) > 0x7F800000)
+				return (uint16_t)((bits >> 16) | 0x40);
+			//round to nearest even
+			bits += 0x7FFF + ((bits >> 16) & 1);
+			return (uint16_t)(bits >> 16);
+		}
+
+		inline float BFloat16ToFloat(uint16_t value)
+		{
+			return BitsFloat((uint32_t)value << 16);
+		}
+
+		inline uint16_t FloatToFloat16(float value)
+		{
+			uint32_t bits = FloatBits(value);
+			uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+			uint32_t absolute = bits & 0x7FFFFFFF;
+
+			//nan and infinity
+			if (absolute >= 0x7F800000)
+				return sign | (absolute > 0x7F800000 ? 0x7E00 : 0x7C00);
+			//too big, becomes infinity
+			if (absolute >= 0x477FF000)
+				return sign | 0x7C00;
+			//too small for a normal half, becomes subnormal (or 0)
+			if (absolute < 0x38800000)
+			{
+				if (absolute < 0x33000000)
+					return sign;
+				uint32_t exponent = absolute >> 23;
+				uint32_t mantissa = (absolute & 0x7FFFFF) | 0x800000;
+				uint32_t shift = 126 - exponent;
+				uint32_t result = mantissa >> shift;
+				uint32_t remainder = mantissa & ((1u << shift) - 1);
+				uint32_t half = 1u << (shift - 1);
+				if (remainder > half || (remainder == half && (result & 1)))
+					result++;
+				return sign | (uint16_t)result;
+			}
+			//normal, rebias the exponent and round the mantissa to nearest even
+			absolute += ((uint32_t)(15 - 127) << 23) + 0xFFF + ((absolute >> 13) & 1);
+			return sign | (uint16_t)(absolute >> 13);
+		}
+
+		inline float Float16ToFloat(uint16_t value)
+		{
+			uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+			uint32_t exponent = (value >> 10) & 0x1F;
+			uint32_t mantissa = value & 0x3FF;
+
+			if (exponent == 0x1F)
+				return BitsFloat(sign | 0x7F800000 | (mantissa << 13));
+			if (exponent == 0)
+			{
+				//subnormal, the value is mantissa * 2^-24
+				float subnormal = (float)mantissa * (1.0f / 16777216.0f);
+				return sign ? -subnormal : subnormal;
+			}
+			return BitsFloat(sign | ((exponent + 127 - 15) << 23) | (mantissa << 13));
+		}
+
+		// Widens a 16 bit gene to a float
+		inline float Widen(GenePrecision precision, uint16_t value)
+		{
+			return precision == GenePrecision::BFloat16 ? BFloat16ToFloat(value) : Float16ToFloat(value);
+		}
+
+		// Rounds a float to a 16 bit gene
+		inline uint16_t Narrow(GenePrecision precision, float value)
+		{
+			return precision == GenePrecision::BFloat16 ? FloatToBFloat16(value) : FloatToFloat16(value);
+		}
+	}
+}
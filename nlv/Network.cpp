@@ -2,6 +2,10 @@
 #include <cmath>
 #include <stdexcept>
 #include <sstream>
+#include <algorithm>
+#include <thread>
+#include <xmmintrin.h>
+#include <emmintrin.h>
 
 namespace nlv 
 {
@@ -18,12 +22,19 @@ namespace nlv
 	}
 
 	Network::Network(int inputNeurons, std::vector<int> hiddenLayerNeurons, int outputNeurons)
+		: Network(inputNeurons, hiddenLayerNeurons, outputNeurons, std::vector<LayerType>(hiddenLayerNeurons.size(), LayerType::Dense))
+	{
+	}
+
+	Network::Network(int inputNeurons, std::vector<int> hiddenLayerNeurons, int outputNeurons, std::vector<LayerType> hiddenLayerTypes)
 		: inputCount(inputNeurons)
 	{
 		//literal copy paste but with vector instead of initializer list
 
 		if (inputNeurons <= 0 || outputNeurons <= 0)
 			throw std::runtime_error("Neuron count cannot be less than or equal to 0");
+		if (hiddenLayerTypes.size() != hiddenLayerNeurons.size())
+			throw std::runtime_error("Every hidden layer needs a layer type");
 
 		layerCount = hiddenLayerNeurons.size() + 1;
 
@@ -45,7 +56,8 @@ namespace nlv
 			//setup layer values
 			layers[i].geneIndex = geneCount;
 			layers[i].outputCount = layerOutputs;
-			geneCount += (inputCount + 1) * layerOutputs;
+			layers[i].type = hiddenLayerTypes[i];
+			geneCount += GetLayerGeneCount(layers[i].type, inputCount, layerOutputs);
 
 			//find max neurons
 			maxNeurons = std::max(maxNeurons, layerOutputs);
@@ -55,7 +67,8 @@ namespace nlv
 		//setup output layer values
 		layers[i].geneIndex = geneCount;
 		layers[i].outputCount = outputNeurons;
-		geneCount += (inputCount + 1) * outputNeurons;
+		layers[i].type = LayerType::Dense;
+		geneCount += GetLayerGeneCount(LayerType::Dense, inputCount, outputNeurons);
 		maxNeurons = std::max(maxNeurons, outputNeurons);
 
 		//with the max amount of neurons, create an activations array that can hold any layer's activations
@@ -64,6 +77,7 @@ namespace nlv
 		activations = new float[maxNeurons * 2];
 		activationsTranslation = maxNeurons;
 		genes = new float[geneCount];
+		InitializeState();
 
 		initialized = true;
 	}
@@ -75,7 +89,7 @@ namespace nlv
 
 	Network::Network(const Network& other)
 		: layerCount(other.layerCount), inputCount(other.inputCount), geneCount(other.geneCount), activationsTranslation(other.activationsTranslation),
-		initialized(other.initialized)
+		initialized(other.initialized), genePrecision(other.genePrecision), sparseThreshold(other.sparseThreshold)
 	{
 		layers = (Network::Layer*)malloc(sizeof(Network::Layer) * layerCount);
 		if (!layers)
@@ -85,18 +99,38 @@ namespace nlv
 		activations = new float[activationsTranslation * 2];
 		memcpy(activations, other.activations, sizeof(float) * activationsTranslation * 2);
 
-		genes = new float[geneCount];
-		memcpy(genes, other.genes, sizeof(float) * geneCount);
+		genes = nullptr;
+		//(shared genes stay shared, the copy uses the same pages)
+		AllocateGenes(other.genePages != nullptr);
+		SetGenes(other);
+		InitializeState();
+		if (stateCount > 0)
+			memcpy(state, other.state, sizeof(float) * stateCount);
 	}
 
 	Network::Network(Network&& other)
 		: layerCount(other.layerCount), inputCount(other.inputCount), geneCount(other.geneCount), activationsTranslation(other.activationsTranslation),
-		initialized(other.initialized), layers(other.layers), activations(other.activations), genes(other.genes)
+		initialized(other.initialized), layers(other.layers), activations(other.activations), genes(other.genes),
+		compactGenes(other.compactGenes), genePages(other.genePages), genePrecision(other.genePrecision), connectionMask(other.connectionMask), sparseThreshold(other.sparseThreshold),
+		sparseDirty(other.sparseDirty), sparse(other.sparse), sparseRows(std::move(other.sparseRows)), sparseConnections(std::move(other.sparseConnections)),
+		state(other.state), ownedState(other.ownedState), stateCount(other.stateCount), recurrentScratch(std::move(other.recurrentScratch)),
+		packedWeights(std::move(other.packedWeights))
 	{
+		quantizedWeights = other.quantizedWeights;
+		quantizedScales = other.quantizedScales;
+		other.connectionMask = nullptr;
+		other.state = nullptr;
+		other.ownedState = nullptr;
+		other.stateCount = 0;
+
 		other.layerCount = 0;
 		other.layers = nullptr;
 		other.genes = nullptr;
+		other.compactGenes = nullptr;
+		other.genePages = nullptr;
 		other.activations = nullptr;
+		other.quantizedWeights = nullptr;
+		other.quantizedScales = nullptr;
 		other.initialized = false;
 	}
 
@@ -107,9 +141,23 @@ namespace nlv
 			free(layers);
 			delete[] activations;
 			delete[] genes;
+			delete[] compactGenes;
+			delete[] connectionMask;
+			delete[] ownedState;
+			ReleasePages();
+			genes = nullptr;
+			compactGenes = nullptr;
+			connectionMask = nullptr;
+			ownedState = nullptr;
 		}
+		ClearQuantized();
+		packedWeights.clear();
 
 		initialized = other.initialized;
+		genePrecision = other.genePrecision;
+		sparseThreshold = other.sparseThreshold;
+		sparseDirty = true;
+		sparse = false;
 		layerCount = other.layerCount;
 		activationsTranslation = other.activationsTranslation;
 		inputCount = other.inputCount;
@@ -120,8 +168,11 @@ namespace nlv
 		memcpy(layers, other.layers, sizeof(Network::Layer) * layerCount);
 		activations = new float[activationsTranslation * 2];
 		memcpy(activations, other.activations, sizeof(float) * activationsTranslation * 2);
-		genes = new float[geneCount];
-		memcpy(genes, other.genes, sizeof(float) * geneCount);
+		AllocateGenes(other.genePages != nullptr);
+		SetGenes(other);
+		InitializeState();
+		if (stateCount > 0)
+			memcpy(state, other.state, sizeof(float) * stateCount);
 		return *this;
 	}
 
@@ -132,7 +183,12 @@ namespace nlv
 			free(layers);
 			delete[] activations;
 			delete[] genes;
+			delete[] compactGenes;
+			delete[] connectionMask;
+			delete[] ownedState;
+			ReleasePages();
 		}
+		ClearQuantized();
 
 		layerCount = other.layerCount;
 		activationsTranslation = other.activationsTranslation;
@@ -141,12 +197,36 @@ namespace nlv
 		layers = other.layers;
 		activations = other.activations;
 		genes = other.genes;
+		compactGenes = other.compactGenes;
+		genePages = other.genePages;
+		genePrecision = other.genePrecision;
+		connectionMask = other.connectionMask;
+		sparseThreshold = other.sparseThreshold;
+		sparseDirty = other.sparseDirty;
+		sparse = other.sparse;
+		sparseRows = std::move(other.sparseRows);
+		sparseConnections = std::move(other.sparseConnections);
+		state = other.state;
+		ownedState = other.ownedState;
+		stateCount = other.stateCount;
+		recurrentScratch = std::move(other.recurrentScratch);
+		packedWeights = std::move(other.packedWeights);
+		quantizedWeights = other.quantizedWeights;
+		quantizedScales = other.quantizedScales;
 		initialized = other.initialized;
 
 		other.layerCount = 0;
 		other.layers = nullptr;
 		other.genes = nullptr;
+		other.compactGenes = nullptr;
+		other.genePages = nullptr;
+		other.connectionMask = nullptr;
+		other.state = nullptr;
+		other.ownedState = nullptr;
+		other.stateCount = 0;
 		other.activations = nullptr;
+		other.quantizedWeights = nullptr;
+		other.quantizedScales = nullptr;
 		other.initialized = false;
 		return *this;
 	}
@@ -202,40 +282,778 @@ namespace nlv
 #ifdef _DEBUG
 		if (input == nullptr)
 			throw std::runtime_error("Cannot pass a null value as input");
-		if (inputCount != inputCount)
+		if (inputCount != this->inputCount)
+			throw std::runtime_error("Incorrect number of inputs");
+		if (!initialized)
+			throw std::runtime_error("Can not evaluate an uninitialized network");
+#endif
+		if (connectionMask && sparseDirty)
+			UpdateSparse();
+		return Evaluate(input, inputCount, { activations, recurrentScratch.data(), state });
+	}
+
+	float const* Network::Evaluate(const float* input, uint32_t inputCount, float* scratch, float* hiddenState) const
+	{
+#ifdef _DEBUG
+		if (input == nullptr || scratch == nullptr)
+			throw std::runtime_error("Cannot pass a null value as input or scratch");
+		if (inputCount != this->inputCount)
 			throw std::runtime_error("Incorrect number of inputs");
 		if (!initialized)
 			throw std::runtime_error("Can not evaluate an uninitialized network");
+		if (stateCount > 0 && hiddenState == nullptr)
+			throw std::runtime_error("Networks with recurrent layers need a hidden state to evaluate");
 #endif
+		//(the gate scratch of GRU layers goes after the activations)
+		return Evaluate(input, inputCount, { scratch, scratch + activationsTranslation * 2, hiddenState });
+	}
+
+	uint32_t Network::GetScratchSize() const
+	{
+		return activationsTranslation * 2 + (uint32_t)recurrentScratch.size();
+	}
+
+	//the number of rows of a batch that go through the layers together (their layer outputs have to fit in cache)
+	static constexpr uint32_t BATCH_ROWS = 64;
+	//the number of inputs whose weights are used by every row of a block before moving on to the next ones
+	static constexpr uint32_t BATCH_INPUTS = 128;
+
+	//adds input * weights into output for ROWS rows and inputs [inputStart, inputEnd), 4 neurons at a time with SSE
+	//each weight load is used by every row, and the sums stay in registers over the inputs
+	template<uint32_t ROWS>
+	static inline void MultiplyRows(const float* input, uint32_t inputCount, uint32_t inputStart, uint32_t inputEnd,
+		const float* weights, uint32_t outputCount, float* output)
+	{
+		uint32_t n = 0;
+		for (; n + 4 <= outputCount; n += 4)
+		{
+			__m128 sums[ROWS];
+			for (uint32_t r = 0; r < ROWS; r++)
+				sums[r] = _mm_loadu_ps(output + r * outputCount + n);
+			for (uint32_t i = inputStart; i < inputEnd; i++)
+			{
+				__m128 weight = _mm_loadu_ps(weights + (size_t)i * outputCount + n);
+				for (uint32_t r = 0; r < ROWS; r++)
+					sums[r] = _mm_add_ps(sums[r], _mm_mul_ps(_mm_set1_ps(input[r * inputCount + i]), weight));
+			}
+			for (uint32_t r = 0; r < ROWS; r++)
+				_mm_storeu_ps(output + r * outputCount + n, sums[r]);
+		}
+		//the neurons left over
+		for (; n < outputCount; n++)
+		{
+			for (uint32_t r = 0; r < ROWS; r++)
+			{
+				float sum = output[r * outputCount + n];
+				for (uint32_t i = inputStart; i < inputEnd; i++)
+					sum += input[r * inputCount + i] * weights[(size_t)i * outputCount + n];
+				output[r * outputCount + n] = sum;
+			}
+		}
+	}
+
+	//output = input * weights + biases for a block of rows (row major, weights are inputCount x outputCount like the genes)
+	static void MultiplyBlock(const float* input, uint32_t rowCount, uint32_t inputCount,
+		const float* weights, const float* biases, uint32_t outputCount, float* output)
+	{
+		for (uint32_t r = 0; r < rowCount; r++)
+			std::copy(biases, biases + outputCount, output + (size_t)r * outputCount);
+
+		//(the sums are done in the same order as Evaluate, so the outputs are the same)
+		for (uint32_t i = 0; i < inputCount; i += BATCH_INPUTS)
+		{
+			uint32_t inputEnd = std::min(i + BATCH_INPUTS, inputCount);
+			uint32_t r = 0;
+			for (; r + 4 <= rowCount; r += 4)
+				MultiplyRows<4>(input + (size_t)r * inputCount, inputCount, i, inputEnd, weights, outputCount, output + (size_t)r * outputCount);
+			for (; r < rowCount; r++)
+				MultiplyRows<1>(input + (size_t)r * inputCount, inputCount, i, inputEnd, weights, outputCount, output + (size_t)r * outputCount);
+		}
+	}
+
+	void Network::EvaluateBatch(const float* inputs, uint32_t rowCount, float* outputs, uint32_t threadCount, float* hiddenStates) const
+	{
+#ifdef _DEBUG
+		if (inputs == nullptr || outputs == nullptr)
+			throw std::runtime_error("Cannot pass a null value as inputs or outputs");
+		if (!initialized)
+			throw std::runtime_error("Can not evaluate an uninitialized network");
+		if (stateCount > 0 && hiddenStates == nullptr)
+			throw std::runtime_error("Networks with recurrent layers need a hidden state for every row to evaluate a batch");
+#endif
+		if (rowCount == 0)
+			return;
+
+		//the kernel reads the weights as floats, so compact or masked genes are widened once for the whole batch
+		std::vector<float> widened;
+		const float* weights = genes;
+		if (stateCount == 0 && (!genes || connectionMask))
+		{
+			widened.resize(geneCount);
+			CopyGenes(widened.data(), true);
+			weights = widened.data();
+		}
+
+		auto evaluateRows = [&](uint32_t start, uint32_t end)
+		{
+			if (stateCount == 0)
+			{
+				EvaluateBatchRows(weights, inputs, start, end, outputs);
+				return;
+			}
+
+			std::vector<float> scratch(GetScratchSize());
+			uint32_t outputCount = GetOutputCount();
+			for (uint32_t r = start; r < end; r++)
+			{
+				const float* output = Evaluate(inputs + (size_t)r * inputCount, inputCount, scratch.data(), hiddenStates + (size_t)r * stateCount);
+				std::copy(output, output + outputCount, outputs + (size_t)r * outputCount);
+			}
+		};
+
+		//every thread gets at least a whole block of rows
+		threadCount = std::clamp(threadCount, 1u, (rowCount + BATCH_ROWS - 1) / BATCH_ROWS);
+		if (threadCount == 1)
+		{
+			evaluateRows(0, rowCount);
+			return;
+		}
+
+		//the calling thread does the first range
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount - 1);
+		for (uint32_t t = 1; t < threadCount; t++)
+			threads.emplace_back(evaluateRows, (uint32_t)((uint64_t)rowCount * t / threadCount), (uint32_t)((uint64_t)rowCount * (t + 1) / threadCount));
+		evaluateRows(0, rowCount / threadCount);
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	void Network::EvaluateBatchRows(const float* weights, const float* inputs, uint32_t start, uint32_t end, float* outputs) const
+	{
+		//two blocks of layer outputs that layers are juggled between (like activations)
+		std::vector<float> blocks((size_t)BATCH_ROWS * activationsTranslation * 2);
+		uint32_t outputCount = GetOutputCount();
+		for (uint32_t r = start; r < end; r += BATCH_ROWS)
+		{
+			uint32_t rowCount = std::min(BATCH_ROWS, end - r);
+			const float* input = inputs + (size_t)r * inputCount;
+			uint32_t previousCount = inputCount;
+			for (uint32_t l = 0; l < layerCount; l++)
+			{
+				const Layer& layer = layers[l];
+				//the last layer is written straight into outputs
+				float* output = l == layerCount - 1 ? outputs + (size_t)r * outputCount : blocks.data() + (l % 2) * (size_t)BATCH_ROWS * activationsTranslation;
+				MultiplyBlock(input, rowCount, previousCount, weights + layer.geneIndex + layer.outputCount, weights + layer.geneIndex, layer.outputCount, output);
+				for (size_t i = 0; i < (size_t)rowCount * layer.outputCount; i++)
+					output[i] = Activate(output[i]);
+
+				input = output;
+				previousCount = layer.outputCount;
+			}
+		}
+	}
+
+	float const* Network::Evaluate(const float* input, uint32_t inputCount, const Buffers& buffers) const
+	{
+		if (connectionMask)
+		{
+			//(the sparse connections can only be used if they are up to date, const evaluation can't rebuild them)
+			if (sparse && !sparseDirty)
+				return ReadGenes([&](auto read) { return EvaluateSparse(input, inputCount, read, buffers); });
+			//disabled connections are read as 0
+			return ReadGenes([&](auto read) { return EvaluateDense(input, inputCount, [&](uint32_t i) { return connectionMask[i] ? read(i) : 0.0f; }, buffers); });
+		}
+		if (!genes)
+			return ReadGenes([&](auto read) { return EvaluateDense(input, inputCount, read, buffers); });
+
 		//make sure the final layer output isn't offset from the activations array
-		uint32_t t = layerCount % 2 == 0 ? 0 : activationsTranslation;
+		uint32_t t = layerCount % 2 == 0 ? activationsTranslation : 0;
 
 		//iterate over the layers, each layer taking the previous layer's output as input
 		//both input and output are stored in the activations array
-		float* output = activations + t;
+		float* output = buffers.activations + t;
 		for (size_t l = 0; l < layerCount; l++)
 		{
-			//calculate every neuron's activation value
-			for (size_t n = 0; n < layers[l].outputCount; n++)
+			if (layers[l].type != LayerType::Dense)
+				EvaluateRecurrent(l, input, inputCount, output, [this](uint32_t i) { return genes[i]; }, buffers);
+			else
 			{
-				float weightedInput = GetBias(l, n);
-				for (int w = 0; w < inputCount; w++)
-					weightedInput += input[w] * GetWeight(l, n, w);
-				output[n] = Activate(weightedInput);
+				//(the same indexing as GetBias and GetWeight)
+				const float* biases = genes + layers[l].geneIndex;
+				const float* weights = biases + layers[l].outputCount;
+				//calculate every neuron's activation value
+				for (size_t n = 0; n < layers[l].outputCount; n++)
+				{
+					float weightedInput = biases[n];
+					for (int w = 0; w < inputCount; w++)
+						weightedInput += input[w] * weights[w * layers[l].outputCount + n];
+					output[n] = Activate(weightedInput);
+				}
 			}
 
 			inputCount = layers[l].outputCount;
 			//swap input and output arrays
 			input = output;
-			output = activations + (activationsTranslation - t);
+			output = buffers.activations + (activationsTranslation - t);
 			//if t == 0, set t to activationsTranslation. else set to 0 
 			t = t == 0 ? activationsTranslation : 0;
 		}
 
 		//return the networks outputs
+		return buffers.activations;
+	}
+
+	template<typename Function>
+	float const* Network::ReadGenes(Function function) const
+	{
+		if (genes)
+			return function([this](uint32_t i) { return genes[i]; });
+		if (genePages)
+			return function([this](uint32_t i) { return genePages[i >> pages::PAGE_SHIFT]->genes[i & pages::PAGE_MASK]; });
+		if (genePrecision == GenePrecision::BFloat16)
+			return function([this](uint32_t i) { return precision::BFloat16ToFloat(compactGenes[i]); });
+		return function([this](uint32_t i) { return precision::Float16ToFloat(compactGenes[i]); });
+	}
+
+	template<typename Reader>
+	float const* Network::EvaluateDense(const float* input, uint32_t inputCount, Reader read, const Buffers& buffers) const
+	{
+		//the same as Evaluate, but every gene goes through read
+		uint32_t t = layerCount % 2 == 0 ? activationsTranslation : 0;
+		float* output = buffers.activations + t;
+		for (uint32_t l = 0; l < layerCount; l++)
+		{
+			if (layers[l].type != LayerType::Dense)
+				EvaluateRecurrent(l, input, inputCount, output, read, buffers);
+			else
+			{
+				uint32_t biases = layers[l].geneIndex;
+				uint32_t weights = biases + layers[l].outputCount;
+				for (uint32_t n = 0; n < layers[l].outputCount; n++)
+				{
+					float weightedInput = read(biases + n);
+					for (uint32_t w = 0; w < inputCount; w++)
+						weightedInput += input[w] * read(weights + w * layers[l].outputCount + n);
+					output[n] = Activate(weightedInput);
+				}
+			}
+
+			inputCount = layers[l].outputCount;
+			input = output;
+			output = buffers.activations + (activationsTranslation - t);
+			t = t == 0 ? activationsTranslation : 0;
+		}
+		return buffers.activations;
+	}
+
+	template<typename Reader>
+	float const* Network::EvaluateSparse(const float* input, uint32_t inputCount, Reader read, const Buffers& buffers) const
+	{
+		//the cost of this follows the number of enabled connections instead of the size of the layers
+		uint32_t t = layerCount % 2 == 0 ? activationsTranslation : 0;
+		float* output = buffers.activations + t;
+		const uint32_t* rows = sparseRows.data();
+		const SparseConnection* connections = sparseConnections.data();
+		for (uint32_t l = 0; l < layerCount; l++)
+		{
+			//recurrent layers aren't in the sparse connections, they are evaluated densely with disabled connections read as 0
+			if (layers[l].type != LayerType::Dense)
+				EvaluateRecurrent(l, input, inputCount, output, [&](uint32_t i) { return connectionMask[i] ? read(i) : 0.0f; }, buffers);
+			else
+			{
+				uint32_t biases = layers[l].geneIndex;
+				for (uint32_t n = 0; n < layers[l].outputCount; n++)
+				{
+					float weightedInput = read(biases + n);
+					for (uint32_t c = rows[n]; c < rows[n + 1]; c++)
+						weightedInput += input[connections[c].input] * read(connections[c].gene);
+					output[n] = Activate(weightedInput);
+				}
+				rows += layers[l].outputCount;
+			}
+
+			inputCount = layers[l].outputCount;
+			input = output;
+			output = buffers.activations + (activationsTranslation - t);
+			t = t == 0 ? activationsTranslation : 0;
+		}
+		return buffers.activations;
+	}
+
+	void Network::UpdateSparse()
+	{
+		sparseDirty = false;
+		sparse = GetConnectionDensity() < sparseThreshold;
+		if (!sparse)
+		{
+			sparseRows.clear();
+			sparseConnections.clear();
+			return;
+		}
+
+		//only dense layers are evaluated sparsely
+		uint32_t neuronCount = 0;
+		for (uint32_t l = 0; l < layerCount; l++)
+		{
+			if (layers[l].type == LayerType::Dense)
+				neuronCount += layers[l].outputCount;
+		}
+		sparseRows.resize(neuronCount + 1);
+		sparseConnections.clear();
+
+		uint32_t neuron = 0;
+		uint32_t previousCount = inputCount;
+		for (uint32_t l = 0; l < layerCount; l++)
+		{
+			const Layer& layer = layers[l];
+			uint32_t weights = layer.geneIndex + layer.outputCount;
+			for (uint32_t n = 0; n < layer.outputCount && layer.type == LayerType::Dense; n++)
+			{
+				sparseRows[neuron++] = (uint32_t)sparseConnections.size();
+				for (uint32_t p = 0; p < previousCount; p++)
+				{
+					uint32_t gene = weights + p * layer.outputCount + n;
+					if (connectionMask[gene])
+						sparseConnections.push_back({ p, gene });
+				}
+			}
+			previousCount = layer.outputCount;
+		}
+		sparseRows[neuron] = (uint32_t)sparseConnections.size();
+	}
+
+	template<typename Reader>
+	void Network::EvaluateRecurrent(uint32_t l, const float* input, uint32_t inputCount, float* output, Reader read, const Buffers& buffers) const
+	{
+		const Layer& layer = layers[l];
+		uint32_t outputCount = layer.outputCount;
+		float* hidden = buffers.state + layer.stateIndex;
+		uint32_t gateGenes = GetLayerGeneCount(LayerType::Elman, inputCount, outputCount);
+
+		//the weighted input of a neuron in a gate, from the layer's inputs and hiddenInput (its last outputs)
+		auto weightedInput = [&](uint32_t gate, uint32_t n, const float* hiddenInput)
+		{
+			uint32_t biases = layer.geneIndex + gate * gateGenes;
+			uint32_t weights = biases + outputCount;
+			uint32_t hiddenWeights = weights + inputCount * outputCount;
+			float value = read(biases + n);
+			for (uint32_t w = 0; w < inputCount; w++)
+				value += input[w] * read(weights + w * outputCount + n);
+			for (uint32_t h = 0; h < outputCount; h++)
+				value += hiddenInput[h] * read(hiddenWeights + h * outputCount + n);
+			return value;
+		};
+
+		if (layer.type == LayerType::Elman)
+		{
+			for (uint32_t n = 0; n < outputCount; n++)
+				output[n] = Activate(weightedInput(0, n, hidden));
+		}
+		else
+		{
+			//the gates need every neuron's last output, so they are all found before any output changes
+			float* update = buffers.gates;
+			float* resetHidden = update + outputCount;
+			for (uint32_t n = 0; n < outputCount; n++)
+			{
+				update[n] = Activate(weightedInput(0, n, hidden));
+				resetHidden[n] = Activate(weightedInput(1, n, hidden)) * hidden[n];
+			}
+			for (uint32_t n = 0; n < outputCount; n++)
+			{
+				float candidate = Activate(weightedInput(2, n, resetHidden));
+				output[n] = (1 - update[n]) * hidden[n] + update[n] * candidate;
+			}
+		}
+		memcpy(hidden, output, sizeof(float) * outputCount);
+	}
+
+	void Network::InitializeState()
+	{
+		delete[] ownedState;
+		ownedState = nullptr;
+		state = nullptr;
+		stateCount = 0;
+
+		uint32_t maxGatedNeurons = 0;
+		for (uint32_t l = 0; l < layerCount; l++)
+		{
+			layers[l].stateIndex = stateCount;
+			if (layers[l].type != LayerType::Dense)
+				stateCount += layers[l].outputCount;
+			if (layers[l].type == LayerType::GRU)
+				maxGatedNeurons = std::max(maxGatedNeurons, layers[l].outputCount);
+		}
+		recurrentScratch.resize(maxGatedNeurons * 2);
+		if (stateCount > 0)
+		{
+			ownedState = new float[stateCount]();
+			state = ownedState;
+		}
+	}
+
+	void Network::ResetState()
+	{
+		if (stateCount > 0)
+			memset(state, 0, sizeof(float) * stateCount);
+	}
+
+	void Network::UseExternalState(float* externalState)
+	{
+		if (stateCount == 0)
+			return;
+		if (externalState)
+		{
+			delete[] ownedState;
+			ownedState = nullptr;
+			state = externalState;
+		}
+		else if (!ownedState)
+		{
+			ownedState = new float[stateCount]();
+			state = ownedState;
+		}
+	}
+
+	uint32_t Network::GetGateCount(LayerType type)
+	{
+		return type == LayerType::GRU ? 3 : 1;
+	}
+
+	uint32_t Network::GetLayerGeneCount(LayerType type, uint32_t previousCount, uint32_t outputCount)
+	{
+		//biases and weights from the previous layer, recurrent layers also have weights from their last outputs (for every gate)
+		uint32_t gateGenes = (previousCount + 1) * outputCount;
+		if (type != LayerType::Dense)
+			gateGenes += outputCount * outputCount;
+		return gateGenes * GetGateCount(type);
+	}
+
+	void Network::EnableConnectionMask()
+	{
+#ifdef _DEBUG
+		if (!initialized)
+			throw std::runtime_error("Can not mask an uninitialized network");
+#endif
+		if (connectionMask)
+			return;
+		connectionMask = new uint8_t[geneCount];
+		memset(connectionMask, 1, geneCount);
+		sparseDirty = true;
+		packedWeights.clear();
+	}
+
+	bool Network::GetConnectionEnabled(uint32_t layer, uint32_t currentNeuron, uint32_t previousNeuron) const
+	{
+#ifdef _DEBUG
+		if (layer >= layerCount)
+			throw std::runtime_error("Layer index exceeds the layer count");
+		if (currentNeuron >= layers[layer].outputCount)
+			throw std::runtime_error("Neuron index exceeds the neuron count");
+		if (previousNeuron >= (layer == 0 ? inputCount : layers[layer - 1].outputCount))
+			throw std::runtime_error("Neuron index exceeds the neuron count");
+#endif
+		if (!connectionMask)
+			return true;
+		Network::Layer& l = layers[layer];
+		return connectionMask[l.geneIndex + l.outputCount + previousNeuron * l.outputCount + currentNeuron];
+	}
+
+	void Network::SetConnectionEnabled(uint32_t layer, uint32_t currentNeuron, uint32_t previousNeuron, bool enabled)
+	{
+#ifdef _DEBUG
+		if (layer >= layerCount)
+			throw std::runtime_error("Layer index exceeds the layer count");
+		if (currentNeuron >= layers[layer].outputCount)
+			throw std::runtime_error("Neuron index exceeds the neuron count");
+		if (previousNeuron >= (layer == 0 ? inputCount : layers[layer - 1].outputCount))
+			throw std::runtime_error("Neuron index exceeds the neuron count");
+		if (!connectionMask)
+			throw std::runtime_error("Network does not have a connection mask");
+#endif
+		Network::Layer& l = layers[layer];
+		connectionMask[l.geneIndex + l.outputCount + previousNeuron * l.outputCount + currentNeuron] = enabled;
+		sparseDirty = true;
+		packedWeights.clear();
+	}
+
+	float Network::GetConnectionDensity() const
+	{
+		uint32_t weightCount = GetWeightCount();
+		if (!connectionMask || weightCount == 0)
+			return 1.0f;
+
+		//biases are always enabled, so they are taken away from the count
+		uint32_t enabled = 0;
+		for (uint32_t i = 0; i < geneCount; i++)
+			enabled += connectionMask[i];
+		uint32_t biasCount = geneCount - weightCount;
+		return (float)(enabled - biasCount) / weightCount;
+	}
+
+	uint32_t Network::GetWeightCount() const
+	{
+		uint32_t biasCount = 0;
+		for (uint32_t l = 0; l < layerCount; l++)
+			biasCount += layers[l].outputCount * GetGateCount(layers[l].type);
+		return geneCount - biasCount;
+	}
+
+	uint32_t Network::GetWeightGeneIndex(uint32_t weightIndex) const
+	{
+		uint32_t previousCount = inputCount;
+		for (uint32_t l = 0; l < layerCount; l++)
+		{
+			const Layer& layer = layers[l];
+			//every gate is its biases followed by its weights
+			uint32_t gateCount = GetGateCount(layer.type);
+			uint32_t gateGenes = GetLayerGeneCount(layer.type, previousCount, layer.outputCount) / gateCount;
+			uint32_t gateWeights = gateGenes - layer.outputCount;
+			if (weightIndex < gateWeights * gateCount)
+				return layer.geneIndex + (weightIndex / gateWeights) * gateGenes + layer.outputCount + weightIndex % gateWeights;
+			weightIndex -= gateWeights * gateCount;
+			previousCount = layer.outputCount;
+		}
+#ifdef _DEBUG
+		throw std::runtime_error("Weight index exceeds the weight count");
+#endif
+		return geneCount - 1;
+	}
+
+	void Network::Quantize()
+	{
+#ifdef _DEBUG
+		if (!initialized)
+			throw std::runtime_error("Can not quantize an uninitialized network");
+#endif
+		if (quantizedWeights == nullptr)
+		{
+			quantizedWeights = new int8_t[geneCount];
+			quantizedScales = new float[layerCount];
+		}
+
+		uint32_t previousCount = inputCount;
+		for (uint32_t l = 0; l < layerCount; l++)
+		{
+			const Layer& layer = layers[l];
+			if (layer.type != LayerType::Dense)
+			{
+				previousCount = layer.outputCount;
+				continue;
+			}
+			uint32_t weightIndex = layer.geneIndex + layer.outputCount;
+			uint32_t weightCount = previousCount * layer.outputCount;
+
+			//symmetric quantization: the biggest weight in the layer becomes +-127
+			float maxWeight = 0;
+			for (uint32_t w = 0; w < weightCount; w++)
+			{
+				if (!connectionMask || connectionMask[weightIndex + w])
+					maxWeight = std::max(maxWeight, std::abs(GetGene(weightIndex + w)));
+			}
+			float scale = maxWeight > 0 ? maxWeight / 127.0f : 1.0f;
+			float inverseScale = 1.0f / scale;
+			quantizedScales[l] = scale;
+
+			//transposed so each neuron's weights can be read in order
+			int8_t* quantized = quantizedWeights + layer.geneIndex;
+			for (uint32_t n = 0; n < layer.outputCount; n++)
+			{
+				for (uint32_t p = 0; p < previousCount; p++)
+				{
+					//disabled connections become 0 weights
+					uint32_t gene = weightIndex + p * layer.outputCount + n;
+					float weight = !connectionMask || connectionMask[gene] ? GetGene(gene) : 0.0f;
+					quantized[n * previousCount + p] = (int8_t)std::lround(std::clamp(weight * inverseScale, -127.0f, 127.0f));
+				}
+			}
+			previousCount = layer.outputCount;
+		}
+	}
+
+	//the dot product of int8 weights and float inputs, 4 weights at a time (the weights are widened to floats in registers, so only a quarter of the bytes are loaded)
+	static float QuantizedDot(const int8_t* weights, const float* input, uint32_t count)
+	{
+		__m128 sum = _mm_setzero_ps();
+		uint32_t w = 0;
+		for (; w + 4 <= count; w += 4)
+		{
+			int32_t packed;
+			memcpy(&packed, weights + w, sizeof(packed));
+			//int8 -> int32 by moving every byte to the top of its lane and shifting it back down with its sign
+			__m128i bytes = _mm_cvtsi32_si128(packed);
+			bytes = _mm_unpacklo_epi8(bytes, bytes);
+			bytes = _mm_srai_epi32(_mm_unpacklo_epi16(bytes, bytes), 24);
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(bytes), _mm_loadu_ps(input + w)));
+		}
+		//add the 4 lanes together
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+		float dot = _mm_cvtss_f32(sum);
+		for (; w < count; w++)
+			dot += weights[w] * input[w];
+		return dot;
+	}
+
+	float const* Network::EvaluateQuantized(const float* input, uint32_t inputCount)
+	{
+#ifdef _DEBUG
+		if (input == nullptr)
+			throw std::runtime_error("Cannot pass a null value as input");
+		if (inputCount != this->inputCount)
+			throw std::runtime_error("Incorrect number of inputs");
+		if (quantizedWeights == nullptr)
+			throw std::runtime_error("Network has to be quantized before evaluating it quantized");
+#endif
+		//same activation array juggling as Evaluate
+		uint32_t t = layerCount % 2 == 0 ? activationsTranslation : 0;
+		float* output = activations + t;
+		for (uint32_t l = 0; l < layerCount; l++)
+		{
+			const Layer& layer = layers[l];
+			//recurrent layers aren't quantized
+			if (layer.type != LayerType::Dense)
+				EvaluateRecurrent(l, input, inputCount, output, [this](uint32_t i) { return !connectionMask || connectionMask[i] ? GetGene(i) : 0.0f; }, { activations, recurrentScratch.data(), state });
+			else
+			{
+				const int8_t* weights = quantizedWeights + layer.geneIndex;
+				float scale = quantizedScales[l];
+				for (uint32_t n = 0; n < layer.outputCount; n++)
+				{
+					float dot = QuantizedDot(weights + n * inputCount, input, inputCount);
+					output[n] = Activate(GetGene(layer.geneIndex + n) + dot * scale);
+				}
+			}
+
+			inputCount = layer.outputCount;
+			input = output;
+			output = activations + (activationsTranslation - t);
+			t = t == 0 ? activationsTranslation : 0;
+		}
+		return activations;
+	}
+
+	void Network::Pack()
+	{
+#ifdef _DEBUG
+		if (!initialized)
+			throw std::runtime_error("Can not pack an uninitialized network");
+#endif
+		size_t packedCount = 0;
+		uint32_t previousCount = inputCount;
+		for (uint32_t l = 0; l < layerCount; l++)
+		{
+			if (layers[l].type == LayerType::Dense)
+				packedCount += (size_t)(layers[l].outputCount + 3) / 4 * (previousCount + 1) * 4;
+			previousCount = layers[l].outputCount;
+		}
+		packedWeights.assign(packedCount, 0.0f);
+
+		float* packed = packedWeights.data();
+		previousCount = inputCount;
+		for (uint32_t l = 0; l < layerCount; l++)
+		{
+			const Layer& layer = layers[l];
+			if (layer.type != LayerType::Dense)
+			{
+				previousCount = layer.outputCount;
+				continue;
+			}
+
+			uint32_t weightIndex = layer.geneIndex + layer.outputCount;
+			for (uint32_t group = 0; group < layer.outputCount; group += 4)
+			{
+				uint32_t groupCount = std::min(4u, layer.outputCount - group);
+				for (uint32_t n = 0; n < groupCount; n++)
+					packed[n] = GetGene(layer.geneIndex + group + n);
+				for (uint32_t p = 0; p < previousCount; p++)
+				{
+					for (uint32_t n = 0; n < groupCount; n++)
+					{
+						//disabled connections become 0 weights
+						uint32_t gene = weightIndex + p * layer.outputCount + group + n;
+						packed[4 + p * 4 + n] = !connectionMask || connectionMask[gene] ? GetGene(gene) : 0.0f;
+					}
+				}
+				packed += (previousCount + 1) * 4;
+			}
+			previousCount = layer.outputCount;
+		}
+	}
+
+	float const* Network::EvaluatePacked(const float* input, uint32_t inputCount)
+	{
+#ifdef _DEBUG
+		if (input == nullptr)
+			throw std::runtime_error("Cannot pass a null value as input");
+		if (inputCount != this->inputCount)
+			throw std::runtime_error("Incorrect number of inputs");
+		if (packedWeights.empty())
+			throw std::runtime_error("Network has to be packed before evaluating it packed");
+#endif
+		//same activation array juggling as Evaluate
+		uint32_t t = layerCount % 2 == 0 ? activationsTranslation : 0;
+		float* output = activations + t;
+		const float* packed = packedWeights.data();
+		for (uint32_t l = 0; l < layerCount; l++)
+		{
+			const Layer& layer = layers[l];
+			//recurrent layers aren't packed
+			if (layer.type != LayerType::Dense)
+				EvaluateRecurrent(l, input, inputCount, output, [this](uint32_t i) { return !connectionMask || connectionMask[i] ? GetGene(i) : 0.0f; }, { activations, recurrentScratch.data(), state });
+			else
+			{
+				uint32_t groupSize = (inputCount + 1) * 4;
+				uint32_t n = 0;
+				//two groups at a time so the two sums don't wait on each other
+				for (; n + 8 <= layer.outputCount; n += 8)
+				{
+					const float* weights0 = packed;
+					const float* weights1 = packed + groupSize;
+					__m128 sum0 = _mm_loadu_ps(weights0);
+					__m128 sum1 = _mm_loadu_ps(weights1);
+					for (uint32_t w = 0; w < inputCount; w++)
+					{
+						__m128 value = _mm_set1_ps(input[w]);
+						sum0 = _mm_add_ps(sum0, _mm_mul_ps(value, _mm_loadu_ps(weights0 + 4 + w * 4)));
+						sum1 = _mm_add_ps(sum1, _mm_mul_ps(value, _mm_loadu_ps(weights1 + 4 + w * 4)));
+					}
+					_mm_storeu_ps(output + n, sum0);
+					_mm_storeu_ps(output + n + 4, sum1);
+					packed += groupSize * 2;
+				}
+				for (; n < layer.outputCount; n += 4)
+				{
+					__m128 sum = _mm_loadu_ps(packed);
+					for (uint32_t w = 0; w < inputCount; w++)
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(input[w]), _mm_loadu_ps(packed + 4 + w * 4)));
+					//(the last group can have less than 4 neurons, output only has room for the layer)
+					float sums[4];
+					_mm_storeu_ps(sums, sum);
+					std::copy(sums, sums + std::min(4u, layer.outputCount - n), output + n);
+					packed += groupSize;
+				}
+				for (uint32_t i = 0; i < layer.outputCount; i++)
+					output[i] = Activate(output[i]);
+			}
+
+			inputCount = layer.outputCount;
+			input = output;
+			output = activations + (activationsTranslation - t);
+			t = t == 0 ? activationsTranslation : 0;
+		}
 		return activations;
 	}
 
+	void Network::ClearQuantized()
+	{
+		delete[] quantizedWeights;
+		delete[] quantizedScales;
+		quantizedWeights = nullptr;
+		quantizedScales = nullptr;
+	}
+
 	float const* Network::GetPreviousActivations() const
 	{
 #ifdef _DEBUG
@@ -256,8 +1074,8 @@ namespace nlv
 		std::random_device rand;
 		std::default_random_engine rEngine(rand());
 		std::normal_distribution<float> dist(0, 1);
-		for (size_t i = 0; i < geneCount; i++)
-			genes[i] = dist(rEngine);
+		for (uint32_t i = 0; i < geneCount; i++)
+			SetGene(i, dist(rEngine));
 	}
 
 	void Network::RandomizeValues(uint32_t seed)
@@ -269,8 +1087,8 @@ namespace nlv
 
 		std::default_random_engine rEngine(seed);
 		std::normal_distribution<float> dist(0, 1);
-		for (size_t i = 0; i < geneCount; i++)
-			genes[i] = dist(rEngine);
+		for (uint32_t i = 0; i < geneCount; i++)
+			SetGene(i, dist(rEngine));
 	}
 
 	void Network::RandomizeValues(std::default_random_engine& randEngine)
@@ -281,8 +1099,8 @@ namespace nlv
 #endif
 
 		std::normal_distribution<float> dist(0, 1);
-		for (size_t i = 0; i < geneCount; i++)
-			genes[i] = dist(randEngine);
+		for (uint32_t i = 0; i < geneCount; i++)
+			SetGene(i, dist(randEngine));
 	}
 
 	float Network::GetWeight(uint32_t layer, uint32_t currentNeuron, uint32_t previousNeuron) const
@@ -300,7 +1118,7 @@ namespace nlv
 
 		Network::Layer& l = layers[layer];
 		//return weight at index [currentNeuronIndex, lastNeuronIndex] at specified layer
-		return genes[l.geneIndex + l.outputCount + previousNeuron * l.outputCount + currentNeuron];
+		return GetGene(l.geneIndex + l.outputCount + previousNeuron * l.outputCount + currentNeuron);
 	}
 
 	void Network::SetWeight(uint32_t layer, uint32_t currentNeuron, uint32_t previousNeuron, float value)
@@ -318,7 +1136,7 @@ namespace nlv
 
 		Network::Layer& l = layers[layer];
 		//set weight at index [currentNeuronIndex, lastNeuronIndex] at specified layer
-		genes[l.geneIndex + l.outputCount + previousNeuron * l.outputCount + currentNeuron] = value;
+		SetGene(l.geneIndex + l.outputCount + previousNeuron * l.outputCount + currentNeuron, value);
 	}
 
 	float Network::GetBias(uint32_t layer, uint32_t neuronIndex) const
@@ -332,7 +1150,7 @@ namespace nlv
 			throw std::runtime_error("Can not read values from an uninitialized network");
 #endif
 
-		return genes[layers[layer].geneIndex + neuronIndex];
+		return GetGene(layers[layer].geneIndex + neuronIndex);
 	}
 
 	void Network::SetBias(uint32_t layer, uint32_t neuronIndex, float value)
@@ -346,7 +1164,218 @@ namespace nlv
 			throw std::runtime_error("Can not read values from an uninitialized network");
 #endif
 
-		genes[layers[layer].geneIndex + neuronIndex] = value;
+		SetGene(layers[layer].geneIndex + neuronIndex, value);
+	}
+
+	void Network::SetGenes(const float* genes)
+	{
+#ifdef _DEBUG
+		if (!initialized)
+			throw std::runtime_error("Can not set values of an uninitialized network");
+#endif
+
+		packedWeights.clear();
+		if (this->genes)
+			memcpy(this->genes, genes, sizeof(float) * geneCount);
+		else if (genePages)
+		{
+			//pages that already have the genes are left alone, so they stay shared
+			for (uint32_t p = 0; p < pages::GetPageCount(geneCount); p++)
+			{
+				uint32_t start = p << pages::PAGE_SHIFT;
+				size_t size = sizeof(float) * std::min(pages::PAGE_GENES, geneCount - start);
+				if (memcmp(genePages[p]->genes, genes + start, size) != 0)
+				{
+					genePages[p] = pages::Unshare(genePages[p]);
+					memcpy(genePages[p]->genes, genes + start, size);
+				}
+			}
+		}
+		else
+		{
+			for (uint32_t i = 0; i < geneCount; i++)
+				compactGenes[i] = precision::Narrow(genePrecision, genes[i]);
+		}
+	}
+
+	void Network::SetGenes(const Network& other)
+	{
+#ifdef _DEBUG
+		if (!initialized)
+			throw std::runtime_error("Can not set values of an uninitialized network");
+		if (geneCount != other.geneCount)
+			throw std::runtime_error("Networks have a different number of genes");
+#endif
+
+		SetGeneRange(other, 0, geneCount);
+
+		if (other.connectionMask)
+		{
+			if (!connectionMask)
+				connectionMask = new uint8_t[geneCount];
+			memcpy(connectionMask, other.connectionMask, geneCount);
+			sparseDirty = true;
+		}
+	}
+
+	void Network::SetGeneRange(const Network& other, uint32_t startIndex, uint32_t endIndex)
+	{
+#ifdef _DEBUG
+		if (!initialized)
+			throw std::runtime_error("Can not set values of an uninitialized network");
+		if (geneCount != other.geneCount)
+			throw std::runtime_error("Networks have a different number of genes");
+		if (startIndex > endIndex || endIndex > geneCount)
+			throw std::runtime_error("Gene range exceeds the gene count");
+#endif
+
+		packedWeights.clear();
+		if (genes && other.genes)
+			memcpy(genes + startIndex, other.genes + startIndex, sizeof(float) * (endIndex - startIndex));
+		else if (compactGenes && other.compactGenes && genePrecision == other.genePrecision)
+			memcpy(compactGenes + startIndex, other.compactGenes + startIndex, sizeof(uint16_t) * (endIndex - startIndex));
+		else if (genePages && other.genePages)
+		{
+			uint32_t i = startIndex;
+			while (i < endIndex)
+			{
+				uint32_t p = i >> pages::PAGE_SHIFT;
+				uint32_t pageStart = p << pages::PAGE_SHIFT;
+				uint32_t pageEnd = std::min(pageStart + pages::PAGE_GENES, geneCount);
+				uint32_t end = std::min(pageEnd, endIndex);
+				//a page entirely in the range is shared, only the pages at the ends of the range are copied into
+				if (i == pageStart && end == pageEnd)
+					SharePage(p, other.genePages[p]);
+				else if (genePages[p] != other.genePages[p])
+				{
+					genePages[p] = pages::Unshare(genePages[p]);
+					memcpy(genePages[p]->genes + (i - pageStart), other.genePages[p]->genes + (i - pageStart), sizeof(float) * (end - i));
+				}
+				i = end;
+			}
+		}
+		else
+		{
+			for (uint32_t i = startIndex; i < endIndex; i++)
+				SetGene(i, other.GetGene(i));
+		}
+	}
+
+	void Network::CopyGenes(float* destination, bool applyMask) const
+	{
+		if (genes)
+			memcpy(destination, genes, sizeof(float) * geneCount);
+		else if (genePages)
+		{
+			for (uint32_t p = 0; p < pages::GetPageCount(geneCount); p++)
+			{
+				uint32_t start = p << pages::PAGE_SHIFT;
+				memcpy(destination + start, genePages[p]->genes, sizeof(float) * std::min(pages::PAGE_GENES, geneCount - start));
+			}
+		}
+		else
+		{
+			for (uint32_t i = 0; i < geneCount; i++)
+				destination[i] = precision::Widen(genePrecision, compactGenes[i]);
+		}
+
+		if (applyMask && connectionMask)
+		{
+			for (uint32_t i = 0; i < geneCount; i++)
+			{
+				if (!connectionMask[i])
+					destination[i] = 0;
+			}
+		}
+	}
+
+	void Network::SetGenePrecision(GenePrecision type)
+	{
+		if (type == genePrecision)
+			return;
+		if (genePages)
+			throw std::runtime_error("Shared genes can only be stored as floats");
+
+		//keep the old genes around until they are converted
+		float* oldGenes = genes;
+		uint16_t* oldCompactGenes = compactGenes;
+		GenePrecision oldPrecision = genePrecision;
+		genes = nullptr;
+		compactGenes = nullptr;
+		genePrecision = type;
+		if (initialized)
+		{
+			AllocateGenes();
+			for (uint32_t i = 0; i < geneCount; i++)
+				SetGene(i, oldGenes ? oldGenes[i] : precision::Widen(oldPrecision, oldCompactGenes[i]));
+		}
+		delete[] oldGenes;
+		delete[] oldCompactGenes;
+	}
+
+	void Network::AllocateGenes(bool shared)
+	{
+		if (shared)
+		{
+			uint32_t pageCount = pages::GetPageCount(geneCount);
+			genePages = new pages::GenePage*[pageCount];
+			std::fill(genePages, genePages + pageCount, nullptr);
+		}
+		else if (genePrecision == GenePrecision::Float32)
+			genes = new float[geneCount];
+		else
+			compactGenes = new uint16_t[geneCount];
+	}
+
+	void Network::ReleasePages()
+	{
+		if (!genePages)
+			return;
+		for (uint32_t p = 0; p < pages::GetPageCount(geneCount); p++)
+			pages::Release(genePages[p]);
+		delete[] genePages;
+		genePages = nullptr;
+	}
+
+	void Network::SharePage(uint32_t pageIndex, pages::GenePage* page)
+	{
+		if (genePages[pageIndex] == page)
+			return;
+		pages::Release(genePages[pageIndex]);
+		genePages[pageIndex] = pages::Share(page);
+	}
+
+	void Network::SetSharedGenes(bool shared)
+	{
+#ifdef _DEBUG
+		if (!initialized)
+			throw std::runtime_error("Can not share the genes of an uninitialized network");
+#endif
+		if (shared == (genePages != nullptr))
+			return;
+		if (shared && genePrecision != GenePrecision::Float32)
+			throw std::runtime_error("Only genes stored as floats can be shared");
+
+		if (shared)
+		{
+			float* oldGenes = genes;
+			genes = nullptr;
+			AllocateGenes(true);
+			for (uint32_t p = 0; p < pages::GetPageCount(geneCount); p++)
+			{
+				uint32_t start = p << pages::PAGE_SHIFT;
+				genePages[p] = pages::Allocate();
+				memcpy(genePages[p]->genes, oldGenes + start, sizeof(float) * std::min(pages::PAGE_GENES, geneCount - start));
+			}
+			delete[] oldGenes;
+		}
+		else
+		{
+			float* newGenes = new float[geneCount];
+			CopyGenes(newGenes);
+			ReleasePages();
+			genes = newGenes;
+		}
 	}
 
 	float Network::Activate(float weightedInput) const
@@ -361,11 +1390,14 @@ namespace nlv
 
 		//save order:
 		// file signiture
+		// gene precision (version 001 only)
 		// input count
 		// layer count
 		// layer data
 		// gene count
-		// genes
+		// genes (as bits if they are stored in 16 bits)
+		// M then the connection mask as a 0 or 1 for every gene (only if the network has a connection mask)
+		// R then the type of every layer (only if the network has recurrent layers)
 
 		//NOTE: the last activation values are NOT saved, they need to be recreated by calling Evaluate()
 		//it is unnecessary to save the activation values for intended uses of saving and loading
@@ -373,15 +1405,42 @@ namespace nlv
 		// 8 byte signiture
 		// \211 is for the same reason as png 
 		// nlvn is for nelve network
-		// 000 is for version 000 (yeah I am probably never going to change this)
-		stream << "\211NLVN000";
-		stream << inputCount << layerCount;
+		// 000 is for version 000, 001 is used when the genes are stored in 16 bits
+		stream << (genePrecision == GenePrecision::Float32 ? "\211NLVN000" : "\211NLVN001");
+		if (genePrecision != GenePrecision::Float32)
+			stream << (uint32_t)genePrecision << ' ';
+		//values are separated by spaces so they can be read back in
+		stream << inputCount << ' ' << layerCount;
 		for (size_t i = 0; i < layerCount; i++)
-			stream << layers[i].geneIndex << layers[i].outputCount;
-		stream << geneCount;
+			stream << ' ' << layers[i].geneIndex << ' ' << layers[i].outputCount;
+		stream << ' ' << geneCount;
 		//going through each gene one by one is painful (and maybe avoidable? idk)
-		for (size_t i = 0; i < geneCount; i++)
-			stream << genes[i];
+		if (genePrecision == GenePrecision::Float32)
+		{
+			//enough digits that floats survive the round trip
+			auto oldPrecision = stream.precision(9);
+			for (size_t i = 0; i < geneCount; i++)
+				stream << ' ' << GetGene(i);
+			stream.precision(oldPrecision);
+		}
+		else
+		{
+			//compact genes are saved as their bits, so loading them gives back exactly the same genes
+			for (size_t i = 0; i < geneCount; i++)
+				stream << ' ' << compactGenes[i];
+		}
+		if (connectionMask)
+		{
+			stream << " M ";
+			for (size_t i = 0; i < geneCount; i++)
+				stream << (connectionMask[i] ? '1' : '0');
+		}
+		if (stateCount > 0)
+		{
+			stream << " R";
+			for (size_t i = 0; i < layerCount; i++)
+				stream << ' ' << (uint32_t)layers[i].type;
+		}
 
 		return true;
 	}
@@ -390,10 +1449,20 @@ namespace nlv
 	{
 		//check header is correct
 		std::string header(8, ' ');
-		std::copy_n(std::istreambuf_iterator<char>(stream.rdbuf()),
-			8, std::back_inserter(header));
-		if (header != "\211NLVN000")
+		if (!stream.read(&header[0], 8))
 			return false;
+		bool compact = header == "\211NLVN001";
+		if (header != "\211NLVN000" && !compact)
+			return false;
+		GenePrecision loadedPrecision = GenePrecision::Float32;
+		if (compact)
+		{
+			uint32_t type;
+			stream >> type;
+			loadedPrecision = (GenePrecision)type;
+			if (loadedPrecision != GenePrecision::Float16 && loadedPrecision != GenePrecision::BFloat16)
+				return false;
+		}
 
 		//delete contents first if already initialized
 		Uninitialize();
@@ -410,9 +1479,47 @@ namespace nlv
 			maxNeurons = std::max(maxNeurons, layers[i].outputCount);
 		}
 		stream >> geneCount;
-		genes = new float[geneCount];
-		for (size_t i = 0; i < geneCount; i++)
-			stream >> genes[i];
+		genePrecision = loadedPrecision;
+		AllocateGenes();
+		if (compact)
+		{
+			for (size_t i = 0; i < geneCount; i++)
+				stream >> compactGenes[i];
+		}
+		else
+		{
+			for (size_t i = 0; i < geneCount; i++)
+				stream >> genes[i];
+		}
+		//the connection mask and layer types are optional
+		for (size_t i = 0; i < layerCount; i++)
+			layers[i].type = LayerType::Dense;
+		stream >> std::ws;
+		if (stream.peek() == 'M')
+		{
+			std::string mask;
+			stream.get();
+			stream >> mask;
+			if (mask.size() == geneCount)
+			{
+				connectionMask = new uint8_t[geneCount];
+				for (size_t i = 0; i < geneCount; i++)
+					connectionMask[i] = mask[i] == '1';
+				sparseDirty = true;
+			}
+			stream >> std::ws;
+		}
+		if (stream.peek() == 'R')
+		{
+			stream.get();
+			for (size_t i = 0; i < layerCount; i++)
+			{
+				uint32_t type;
+				stream >> type;
+				layers[i].type = type <= (uint32_t)LayerType::GRU ? (LayerType)type : LayerType::Dense;
+			}
+		}
+		InitializeState();
 
 		//set values
 		activations = new float[maxNeurons * 2];
@@ -429,12 +1536,23 @@ namespace nlv
 			delete[] layers;
 			delete[] activations;
 			delete[] genes;
+			delete[] compactGenes;
+			delete[] connectionMask;
+			delete[] ownedState;
+			ReleasePages();
 			layers = nullptr;
 			activations = nullptr;
 			genes = nullptr;
+			compactGenes = nullptr;
+			connectionMask = nullptr;
+			ownedState = nullptr;
+			state = nullptr;
+			stateCount = 0;
 			layerCount = 0;
 
 			initialized = false;
 		}
+		ClearQuantized();
+		packedWeights.clear();
 	}
 }
\ No newline at end of file
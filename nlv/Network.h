@@ -1,17 +1,34 @@
 #pragma once
+#include "GenePrecision.h"
+#include "GenePages.h"
 #include <random>
 #include <fstream>
 
 namespace nlv
 {
 	class NetworkEvolver;
+	class NetworkExporter;
 
-	//a feed forward neural network
+	//how a layer turns its inputs into outputs
+	enum class LayerType : uint8_t
+	{
+		// fully connected, with no memory
+		Dense,
+		// also takes its own outputs from the last evaluation as inputs (a simple recurrent network)
+		Elman,
+		// a gated recurrent unit: an update gate decides how much of the last outputs are kept, a reset gate how much of them feed the new candidate outputs
+		// (has 3 times the genes of an Elman layer)
+		GRU
+	};
+
+	//a feed forward neural network (hidden layers can also be recurrent)
 	class Network
 	{
 	public:
 		Network(); // <--this initializes an empty network, which will not be able to do anything
 		Network(int inputs, std::vector<int> hiddenLayerNeurons, int outputs);
+		// hiddenLayerTypes: the type of every hidden layer (the output layer is always dense)
+		Network(int inputs, std::vector<int> hiddenLayerNeurons, int outputs, std::vector<LayerType> hiddenLayerTypes);
 		Network(const Network& other);
 		Network(Network&& other);
 		Network& operator=(const Network& other);
@@ -42,15 +59,177 @@ namespace nlv
 		// returns the output activations of the neural network (always values between 0 and 1)
 		float const* Evaluate(float* input, uint32_t inputCount);
 
+		// The same as Evaluate, but the activations are written into scratch instead of the network, so many threads can evaluate the same network at once
+		// (as long as nothing changes the network meanwhile, including the non const Evaluate which can rebuild the sparse connections)
+		// input: The activations of the input layer
+		// inputCount: The number of neurons in the input layer
+		// scratch: GetScratchSize() floats, only used by one evaluation at a time
+		// hiddenState: GetStateCount() floats of hidden state that is read and updated (can be nullptr if there are no recurrent layers)
+		// returns the output activations of the neural network, which are at the start of scratch
+		float const* Evaluate(const float* input, uint32_t inputCount, float* scratch, float* hiddenState = nullptr) const;
+
+		// Returns the number of floats of scratch the const Evaluate needs
+		uint32_t GetScratchSize() const;
+
+		// Evaluates the network for a batch of inputs at once, which is much faster than evaluating them one at a time
+		// (a block of rows is multiplied with the weights together, so each weight is loaded once for the block instead of once per row)
+		// like the const Evaluate it doesn't change the network, so many threads can call it at once
+		// inputs: rowCount rows of GetInputCount() floats, one row for every evaluation
+		// rowCount: the number of rows
+		// outputs: rowCount rows of GetOutputCount() floats that the output activations are written into
+		// threadCount: the number of threads the rows are split between (small batches use fewer)
+		// hiddenStates: rowCount rows of GetStateCount() floats, the hidden state of every row (can be nullptr if there are no recurrent layers)
+		// networks with recurrent layers are evaluated a row at a time, the rows' hidden states depend on their own last outputs
+		void EvaluateBatch(const float* inputs, uint32_t rowCount, float* outputs, uint32_t threadCount = 1, float* hiddenStates = nullptr) const;
+
+		// Converts the weights to int8 (with a scale per layer) for EvaluateQuantized. Has to be called again after genes change
+		// biases stay as floats, there are few of them compared to weights
+		void Quantize();
+
+		// The same as Evaluate, but reads the weights made by Quantize, which are 4x smaller than the float weights
+		// the dot products are done on the int8 weights with float accumulation, then scaled once per neuron
+		float const* EvaluateQuantized(const float* input, uint32_t inputCount);
+
+		// Returns whether Quantize has been called since the network was created or copied
+		inline bool GetIsQuantized() const { return quantizedWeights != nullptr; }
+
+		// Copies the weights of dense layers into a neuron major layout for EvaluatePacked. Has to be called again after genes or connections change
+		// (changing them throws the packed weights away, so evaluating with old weights throws in debug builds)
+		// the genes (and so crossover and saved files) stay in their own order, this is only a copy made for evaluation
+		void Pack();
+
+		// The same as Evaluate, but reads the weights made by Pack, 4 neurons at a time with SSE
+		// every neuron's weights are read in order instead of striding through the genes
+		float const* EvaluatePacked(const float* input, uint32_t inputCount);
+
+		// Returns whether Pack has been called since the network was created or copied, or its genes or connections last changed
+		inline bool GetIsPacked() const { return !packedWeights.empty(); }
+
 		// Returns the last output activations calculated by the evaluate function (always values between 0 and 1)
 		float const* GetPreviousActivations() const;
 
+		// Returns the type of a layer
+		inline LayerType GetLayerType(uint32_t layer) const { return layers[layer].type; }
+
+		// Returns the number of floats of hidden state recurrent layers keep between evaluations (0 if there are no recurrent layers)
+		inline uint32_t GetStateCount() const { return stateCount; }
+
+		// Returns the hidden state of the recurrent layers
+		inline float* GetState() { return state; }
+		inline const float* GetState() const { return state; }
+
+		// Sets the hidden state to 0 (should be done at the start of every episode)
+		void ResetState();
+
+		// Makes the network keep its hidden state in an array it doesn't own, so many networks can keep theirs in one contiguous array
+		// state: GetStateCount() floats that stay valid while the network uses them, or nullptr to go back to its own array
+		void UseExternalState(float* state);
+
+		// Gives the network a connection mask with every connection enabled (does nothing if it already has one)
+		// disabled connections act like their weight is 0, but keep their weight so it comes back if they are enabled again
+		void EnableConnectionMask();
+
+		// Returns whether the network has a connection mask
+		inline bool GetHasConnectionMask() const { return connectionMask != nullptr; }
+
+		// Returns whether the connection between the last and current neuron is enabled (always true without a connection mask)
+		bool GetConnectionEnabled(uint32_t layer, uint32_t currentNeuronIndex, uint32_t lastNeuronIndex) const;
+
+		// Enables or disables the connection between the last and current neuron (the network has to have a connection mask)
+		void SetConnectionEnabled(uint32_t layer, uint32_t currentNeuronIndex, uint32_t lastNeuronIndex, bool enabled);
+
+		// Returns the number of enabled connections divided by the number of connections
+		float GetConnectionDensity() const;
+
+		// Sets the density under which a masked network is evaluated sparsely (only enabled connections are read)
+		// threshold: 0 never evaluates sparsely, 1 always does
+		inline void SetSparseThreshold(float threshold) { sparseThreshold = threshold; sparseDirty = true; }
+		inline float GetSparseThreshold() const { return sparseThreshold; }
+
+		// Returns the total number of weights (connections) in the network
+		uint32_t GetWeightCount() const;
+
 		// Returns the number of input neurons into the network
 		inline uint32_t GetInputCount() const { return inputCount; }
 		
 		// Returns the number of output neurons from the network
 		inline uint32_t GetOutputCount() const { return layers[layerCount - 1].outputCount; }
 
+		// Returns the number of layers in the network (not including the input layer)
+		inline uint32_t GetLayerCount() const { return layerCount; }
+
+		// layer: the index of the layer
+		// Returns the number of neurons in the layer
+		inline uint32_t GetLayerNeuronCount(uint32_t layer) const { return layers[layer].outputCount; }
+
+		// Returns the total number of genes (weights and biases) in the network
+		inline uint32_t GetGeneCount() const { return geneCount; }
+
+		// Returns every gene in the network (see genes for the layout)
+		// Returns nullptr if the genes are stored in 16 bits or shared, use CopyGenes or GetGene instead
+		inline const float* GetGenes() const { return genes; }
+
+		// Copies every gene in the network into destination as floats (works with any precision)
+		// destination: an array of GetGeneCount() values
+		// applyMask: whether weights of disabled connections are copied as 0
+		void CopyGenes(float* destination, bool applyMask = false) const;
+
+		// Sets every gene in the network (rounding them if the genes are stored in 16 bits)
+		// genes: an array of GetGeneCount() values, in the same layout as GetGenes()
+		void SetGenes(const float* genes);
+
+		// Sets every gene to the genes of another network with the same layout (without widening them if both have the same precision)
+		// the connection mask is copied too if the other network has one
+		// if both networks share their genes, the other network's pages are shared instead of copied
+		void SetGenes(const Network& other);
+
+		// Sets genes [startIndex, endIndex) to the genes of another network with the same layout (the connection mask isn't copied)
+		// if both networks share their genes, pages entirely inside the range are shared instead of copied
+		void SetGeneRange(const Network& other, uint32_t startIndex, uint32_t endIndex);
+
+		// index: the index of the gene
+		// Returns the gene at the index as a float
+		inline float GetGene(uint32_t index) const
+		{
+			if (genes)
+				return genes[index];
+			if (genePages)
+				return genePages[index >> pages::PAGE_SHIFT]->genes[index & pages::PAGE_MASK];
+			return precision::Widen(genePrecision, compactGenes[index]);
+		}
+
+		// Sets the gene at the index (rounding it if the genes are stored in 16 bits, and copying its page first if the page is shared)
+		inline void SetGene(uint32_t index, float value)
+		{
+			packedWeights.clear();
+			if (genes)
+				genes[index] = value;
+			else if (genePages)
+			{
+				pages::GenePage*& page = genePages[index >> pages::PAGE_SHIFT];
+				page = pages::Unshare(page);
+				page->genes[index & pages::PAGE_MASK] = value;
+			}
+			else
+				compactGenes[index] = precision::Narrow(genePrecision, value);
+		}
+
+		// Stores the genes in pages that copies of the network share until one of them writes to a page (see GenePages.h)
+		// copying the network then doesn't copy its genes, and changing a gene only copies the page it is on
+		// shared genes are read through their pages like 16 bit genes are widened, so they are a little slower to evaluate
+		// shared: whether the genes are shared, false gives the network its own array of genes again
+		// Throws if the genes are stored in 16 bits (only floats can be shared)
+		void SetSharedGenes(bool shared);
+
+		inline bool GetHasSharedGenes() const { return genePages != nullptr; }
+
+		// Changes how the genes are stored, converting the current genes
+		// going from 32 to 16 bits rounds every gene
+		// Throws if the genes are shared
+		void SetGenePrecision(GenePrecision type);
+
+		inline GenePrecision GetGenePrecision() const { return genePrecision; }
+
 		// Randomizes the network's values
 		void RandomizeValues();
 		// seed: used to seed the random engine
@@ -78,10 +257,60 @@ namespace nlv
 	private:
 		//network evolver is allowed to modify the genes directly
 		friend NetworkEvolver;
+		//the exporter reads the layout of the genes
+		friend NetworkExporter;
 
 		// Componentwise activation function (specifically a sigmoid function)
 		float Activate(float weightedInput) const;
 
+		// Where an evaluation writes to: the network's own arrays, or the caller's for the const Evaluate
+		struct Buffers
+		{
+			// activationsTranslation * 2 floats that layer outputs are juggled between
+			float* activations;
+			// the gate scratch of GRU layers (the size of recurrentScratch)
+			float* gates;
+			// the hidden state of recurrent layers
+			float* state;
+		};
+
+		// Evaluates rows [start, end) of a batch a block of rows at a time (only for networks without recurrent layers)
+		// weights: the genes as floats, with disabled connections as 0
+		void EvaluateBatchRows(const float* weights, const float* inputs, uint32_t start, uint32_t end, float* outputs) const;
+		// Evaluates the network into buffers (every other Evaluate ends up here)
+		float const* Evaluate(const float* input, uint32_t inputCount, const Buffers& buffers) const;
+		// Calls function with a function object that reads a gene as a float (for the precision the genes are stored in)
+		template<typename Function>
+		float const* ReadGenes(Function function) const;
+		// Evaluate, with every gene read through read (used when genes are compact or masked)
+		template<typename Reader>
+		float const* EvaluateDense(const float* input, uint32_t inputCount, Reader read, const Buffers& buffers) const;
+		// Evaluate that only goes through the enabled connections in sparseRows
+		template<typename Reader>
+		float const* EvaluateSparse(const float* input, uint32_t inputCount, Reader read, const Buffers& buffers) const;
+		// Evaluates a recurrent layer, updating its hidden state
+		template<typename Reader>
+		void EvaluateRecurrent(uint32_t layer, const float* input, uint32_t inputCount, float* output, Reader read, const Buffers& buffers) const;
+		// Finds where each recurrent layer's hidden state is and allocates it
+		void InitializeState();
+		// Returns the number of gates (sets of weights and biases) a layer type has
+		static uint32_t GetGateCount(LayerType type);
+		// Returns the number of genes in a layer
+		static uint32_t GetLayerGeneCount(LayerType type, uint32_t previousCount, uint32_t outputCount);
+		// Rebuilds the sparse connections from the mask, or clears them if the network is too dense
+		void UpdateSparse();
+		// weightIndex: an index from 0 to GetWeightCount()
+		// Returns the index of the weight's gene
+		uint32_t GetWeightGeneIndex(uint32_t weightIndex) const;
+
+		// Allocates the gene array used by the precision (the old gene arrays have to be deleted first)
+		// shared: allocates an array of GetPageCount(geneCount) pages instead, which are all nullptr until they are set
+		void AllocateGenes(bool shared = false);
+		// Removes the network from every page and deletes the page array
+		void ReleasePages();
+		// Makes page the network's page at pageIndex, sharing it (does nothing if it already is)
+		void SharePage(uint32_t pageIndex, pages::GenePage* page);
+
 		//save to stream
 		bool Save(std::ostream& stream) const;
 		//load from stream
@@ -89,20 +318,69 @@ namespace nlv
 
 		//delete the network (called by load functions, copy and move assigners and destructor)
 		void Uninitialize();
+		//delete the quantized weights
+		void ClearQuantized();
 
 		//contains all weights and biases.
 		//weights (connecting a neuron in the previous layer and a neuron in the current layer)
 		// indexed by [layerGeneIndex + outputCount + currentNeuron * outputCount + previousNeuron]
 		//biases indexed by [layerGeneIndex + biasIndex]
+		//recurrent layers have these for every gate, followed by the weights from the layer's last outputs
+		// indexed by [gateGeneIndex + outputCount + previousCount * outputCount + lastOutput * outputCount + currentNeuron]
+		//(nullptr if the genes are stored in 16 bits or shared)
 		float* genes;
+		//the genes when they are stored in 16 bits, in the same layout as genes (otherwise nullptr)
+		uint16_t* compactGenes = nullptr;
+		//the genes when they are shared, gene i is at [i >> PAGE_SHIFT]->genes[i & PAGE_MASK] (otherwise nullptr)
+		pages::GenePage** genePages = nullptr;
+		//how the genes are stored
+		GenePrecision genePrecision = GenePrecision::Float32;
 		// An array used to store the last activation output values
 		float* activations;
+		//int8 weights made by Quantize, indexed by [layerGeneIndex + currentNeuron * previousCount + previousNeuron] so each neuron's weights are contiguous
+		//(nullptr until Quantize is called, it isn't copied with the network)
+		int8_t* quantizedWeights = nullptr;
+		//the value of 1 in quantizedWeights for every layer
+		float* quantizedScales = nullptr;
+		//float weights made by Pack. every group of 4 neurons in a dense layer has its 4 biases, then its 4 weights from every previous neuron
+		// indexed by [layerPackedIndex + group * (previousCount + 1) * 4 + 4 + previousNeuron * 4 + currentNeuron % 4] (the last group is padded with 0s)
+		//(empty until Pack is called and whenever the genes or connections change, it isn't copied with the network)
+		std::vector<float> packedWeights;
+		//whether each gene is enabled, in the same layout as genes (biases are always enabled). nullptr if the network isn't masked
+		uint8_t* connectionMask = nullptr;
+		//the density under which the network is evaluated sparsely
+		float sparseThreshold = 0.5f;
+		//whether the mask changed since sparseRows was built
+		bool sparseDirty = true;
+		//whether the network is evaluated with the sparse connections
+		bool sparse = false;
+		//an enabled connection, stored in order of the neuron it goes into (CSR)
+		struct SparseConnection {
+			// the index of the neuron in the previous layer
+			uint32_t input;
+			// the index of the weight's gene
+			uint32_t gene;
+		};
+		//the hidden state of every recurrent layer (the outputs of its last evaluation)
+		float* state = nullptr;
+		//state if the network owns it, otherwise nullptr
+		float* ownedState = nullptr;
+		uint32_t stateCount = 0;
+		//used by GRU layers for their gates
+		std::vector<float> recurrentScratch;
+		//the connections of every neuron (in every dense layer) are [sparseRows[neuron], sparseRows[neuron + 1])
+		std::vector<uint32_t> sparseRows;
+		std::vector<SparseConnection> sparseConnections;
 		// Data about the layers of the network (output neuron count & gene index)
 		struct Layer {
 			// the index into the gene array
 			uint32_t geneIndex;
 			// The number of neurons in the layer
 			uint32_t outputCount;
+			// How the layer is evaluated
+			LayerType type;
+			// The index of the layer's hidden state in state (if it is recurrent)
+			uint32_t stateIndex;
 		} *layers;
 		//Number of layers (not including input layer)
 		uint32_t layerCount;
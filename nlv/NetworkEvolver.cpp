@@ -5,19 +5,25 @@
 
 namespace nlv 
 {
+	thread_local uint32_t NetworkEvolver::episodeThread = 0;
+
 	NetworkEvolver::NetworkEvolver(const NetworkEvolverBuilder& def)
 		: populationSize(def.populationSize), maxSteps(def.maxSteps), elitePercent(def.elitePercent),
-		mutationRate(def.mutationRate), stepCallback(def.stepFunction), startCallback(def.startFunction), endCallback(def.endFunction),
+		mutationRate(def.mutationRate), stepCallback(def.stepFunction), batchStepCallback(def.batchStepFunction), startCallback(def.startFunction), endCallback(def.endFunction),
 		mutationType(def.mutationType), selectionType(def.selectionType), crossoverType(def.crossoverType), currentGeneration(0),
 		threadedStepping(def.threadedEpisodes), episodeThreadCount(def.episodeThreadCount), staticEpisodes(def.staticEpisodes),
-		mutationScale(def.mutationScale), userPointer(def.userPtr)
+		mutationScale(def.mutationScale), userPointer(def.userPtr), replicaCallback(def.replicaFunction), replicaCount(def.replicaCount),
+		fitnessReduction(def.fitnessReduction), fitnessPercentile(def.fitnessPercentile), birthCallback(def.birthFunction), replacementType(def.replacementType),
+		optimizerType(def.optimizerType), quantizedInference(def.quantizedInference), packedInference(def.packedInference), genePrecision(def.genePrecision), sharedGenes(def.sharedGenes),
+		connectionMasks(def.connectionMask), connectionToggleRate(def.connectionToggleRate), populationStatsHistory(def.populationStatsHistory)
 	{
 		if (populationSize == 0)
 			throw std::runtime_error("Generation size cannot be 0");
+		nextPopulationSize = populationSize;
 		if (maxSteps == 0)
 			throw std::runtime_error("Max steps cannot be 0");
-		if (stepCallback == nullptr)
-			throw std::runtime_error("Step callback cannot be nullptr");
+		if (replicaCount > 1 && replicaCallback == nullptr)
+			throw std::runtime_error("Replica callback cannot be nullptr when using more than one replica");
 
 		neuralInputSize = def.networkTemplate.GetInputCount();
 		neuralOutputSize = def.networkTemplate.GetOutputCount();
@@ -44,8 +50,35 @@ namespace nlv
 		for (size_t i = 0; i < populationSize; i++)
 		{
 			new (organisms + i) NetworkOrganism(def.networkTemplate);
+			organisms[i].network.SetGenePrecision(genePrecision);
+			organisms[i].network.SetSharedGenes(sharedGenes);
 			organisms[i].network.RandomizeValues(random.engine);
+			if (connectionMasks)
+			{
+				Network& network = organisms[i].network;
+				network.EnableConnectionMask();
+				network.SetSparseThreshold(def.sparseThreshold);
+				uint32_t weightCount = network.GetWeightCount();
+				for (uint32_t w = 0; w < weightCount; w++)
+				{
+					if (random.Chance() >= def.initialConnectionDensity)
+						network.connectionMask[network.GetWeightGeneIndex(w)] = 0;
+				}
+			}
+		}
+		//(16 bit and shared genes are copied into floats for crossover and custom mutation)
+		if (!organisms[0].network.genes)
+			widenedGenes.resize(3 * (size_t)organisms[0].network.geneCount);
+		BindHiddenStates();
+
+		//evolution strategies search around a single mean, so the first generation is already perturbations of it
+		if (optimizerType != EvolverOptimizerType::Genetic)
+		{
+			strategy.Initialize(optimizerType, WidenGenes(organisms[0], 0), organisms[0].network.geneCount, populationSize, def.strategySigma, def.strategyLearningRate, random.engine());
+			strategy.Sample(organisms);
 		}
+		if (def.adaptiveMaxPopulation != 0)
+			SetAdaptivePopulation(def.adaptiveMinPopulation, def.adaptiveMaxPopulation, def.adaptivePatience, def.adaptiveShrinkFactor, def.adaptiveGrowFactor);
 
 		initialized = true;
 	}
@@ -57,14 +90,26 @@ namespace nlv
 
 	NetworkEvolver::NetworkEvolver(NetworkEvolver&& other)
 		: populationSize(other.populationSize), maxSteps(other.maxSteps), elitePercent(other.elitePercent),
-		mutationRate(other.mutationRate), stepCallback(other.stepCallback), startCallback(other.startCallback), endCallback(other.endCallback),
+		mutationRate(other.mutationRate), stepCallback(other.stepCallback), batchStepCallback(other.batchStepCallback), startCallback(other.startCallback), endCallback(other.endCallback),
 		mutationType(other.mutationType), selectionType(other.selectionType), crossoverType(other.crossoverType), currentGeneration(0),
 		threadedStepping(other.threadedStepping), episodeThreadCount(other.episodeThreadCount), staticEpisodes(other.staticEpisodes),
-		mutationScale(other.mutationScale), userPointer(other.userPointer)
+		mutationScale(other.mutationScale), userPointer(other.userPointer), remoteEvaluator(other.remoteEvaluator), sharedMemoryBridge(other.sharedMemoryBridge), trace(other.trace), replicaCallback(other.replicaCallback), replicaCount(other.replicaCount),
+		fitnessReduction(other.fitnessReduction), fitnessPercentile(other.fitnessPercentile), birthCallback(other.birthCallback), replacementType(other.replacementType),
+		steadyStateEvaluations(other.steadyStateEvaluations), optimizerType(other.optimizerType), strategy(std::move(other.strategy)),
+		quantizedInference(other.quantizedInference), packedInference(other.packedInference), genePrecision(other.genePrecision), sharedGenes(other.sharedGenes), widenedGenes(std::move(other.widenedGenes)),
+		connectionMasks(other.connectionMasks), connectionToggleRate(other.connectionToggleRate),
+		hiddenStates(std::move(other.hiddenStates)), stateCount(other.stateCount), stats(std::move(other.stats)),
+		populationStatsHistory(std::move(other.populationStatsHistory)), populationStatsStart(other.populationStatsStart), populationStatsCount(other.populationStatsCount),
+		geneMeans(std::move(other.geneMeans)), geneVariances(std::move(other.geneVariances)), geneSums(std::move(other.geneSums)),
+		snapshot(other.snapshot.load()), spareSnapshot(std::move(other.spareSnapshot)), snapshotGenomeCount(other.snapshotGenomeCount)
 	{
 		neuralInputSize = other.neuralInputSize;
 		neuralOutputSize = other.neuralOutputSize;
 		organisms = other.organisms;
+		spareOrganisms = other.spareOrganisms;
+		nextPopulationSize = other.nextPopulationSize;
+		eliteCount = other.eliteCount;
+		adaptivePopulation = other.adaptivePopulation;
 		tournamentSize = other.tournamentSize;
 		fitnessOrderedIndexes = other.fitnessOrderedIndexes;
 		random = other.random;
@@ -73,6 +118,7 @@ namespace nlv
 
 		other.populationSize = 0;
 		other.organisms = nullptr;
+		other.spareOrganisms = nullptr;
 		other.fitnessOrderedIndexes = nullptr;
 		other.initialized = false;
 	}
@@ -86,6 +132,16 @@ namespace nlv
 		elitePercent = other.elitePercent;
 		mutationRate = other.mutationRate;
 		stepCallback = other.stepCallback;
+		batchStepCallback = other.batchStepCallback;
+		replicaCallback = other.replicaCallback;
+		replicaCount = other.replicaCount;
+		fitnessReduction = other.fitnessReduction;
+		fitnessPercentile = other.fitnessPercentile;
+		birthCallback = other.birthCallback;
+		replacementType = other.replacementType;
+		steadyStateEvaluations = other.steadyStateEvaluations;
+		optimizerType = other.optimizerType;
+		strategy = std::move(other.strategy);
 		startCallback = other.startCallback;
 		endCallback = other.endCallback;
 		mutationType = other.mutationType;
@@ -93,13 +149,39 @@ namespace nlv
 		crossoverType = other.crossoverType;
 		currentGeneration = 0;
 		threadedStepping = other.threadedStepping;
+		quantizedInference = other.quantizedInference;
+		packedInference = other.packedInference;
+		genePrecision = other.genePrecision;
+		sharedGenes = other.sharedGenes;
+		widenedGenes = std::move(other.widenedGenes);
+		connectionMasks = other.connectionMasks;
+		connectionToggleRate = other.connectionToggleRate;
+		hiddenStates = std::move(other.hiddenStates);
+		stateCount = other.stateCount;
+		stats = std::move(other.stats);
+		populationStatsHistory = std::move(other.populationStatsHistory);
+		populationStatsStart = other.populationStatsStart;
+		populationStatsCount = other.populationStatsCount;
+		geneMeans = std::move(other.geneMeans);
+		geneVariances = std::move(other.geneVariances);
+		geneSums = std::move(other.geneSums);
+		snapshot.store(other.snapshot.load());
+		spareSnapshot = std::move(other.spareSnapshot);
+		snapshotGenomeCount = other.snapshotGenomeCount;
 		episodeThreadCount = other.episodeThreadCount;
 		staticEpisodes = other.staticEpisodes;
 		mutationScale = other.mutationScale;
 		userPointer = other.userPointer;
+		remoteEvaluator = other.remoteEvaluator;
+		sharedMemoryBridge = other.sharedMemoryBridge;
+		trace = other.trace;
 		neuralInputSize = other.neuralInputSize;
 		neuralOutputSize = other.neuralOutputSize;
 		organisms = other.organisms;
+		spareOrganisms = other.spareOrganisms;
+		nextPopulationSize = other.nextPopulationSize;
+		eliteCount = other.eliteCount;
+		adaptivePopulation = other.adaptivePopulation;
 		tournamentSize = other.tournamentSize;
 		fitnessOrderedIndexes = other.fitnessOrderedIndexes;
 		random = other.random;
@@ -108,6 +190,7 @@ namespace nlv
 
 		other.populationSize = 0;
 		other.organisms = nullptr;
+		other.spareOrganisms = nullptr;
 		other.fitnessOrderedIndexes = nullptr;
 		other.initialized = false;
 		return *this;
@@ -115,11 +198,27 @@ namespace nlv
 
 	void NetworkEvolver::CreateNewGen()
 	{
+		NLV_STATS_ONLY(stats = EvolverStats());
 		//the first generation hasn't been stepped yet, and therefore cannot be used for creating a new generation
 		//the reason it is ordered CreateGen(), StepGen() is so the fitness data from the generation step is saved for the user to access without any copying
 		//stepgen isn't called inside of the start function because that might confuse things for the user when initiating
 		if (currentGeneration == 0)
 			return;
+		NLV_STATS_ONLY(uint64_t phaseStart = timing::Now());
+		uint64_t traceStart = trace ? timing::Now() : 0;
+
+		if (optimizerType != EvolverOptimizerType::Genetic)
+		{
+			//the population is reused, every organism just gets new genes
+			strategy.Update(organisms);
+			strategy.Sample(organisms);
+			for (uint32_t i = 0; i < populationSize; i++)
+				organisms[i].Reset();
+			NLV_STATS_ONLY(stats.strategyNanoseconds = timing::Lap(phaseStart));
+			if (trace)
+				trace->Lap("Strategy", traceStart);
+			return;
+		}
 
 		//Order:
 		//Retain elite: elite get copied into next generation
@@ -130,26 +229,34 @@ namespace nlv
 
 		//Make an index array ordered by the fitnesses of organisms
 		std::sort(fitnessOrderedIndexes, fitnessOrderedIndexes + populationSize, [this](int a, int b) { return organisms[a].fitness > organisms[b].fitness; });
+		NLV_STATS_ONLY(stats.sortNanoseconds = timing::Lap(phaseStart));
+		if (trace)
+			trace->Lap("Sort", traceStart);
 
 		//since I want to be able to save the network evolver and normal_distribution is stateful it needs to be reset before every generation to keep everything deterministic after save() and load()
 		random.guassan.reset();
 		//uniform_real_distribution probably doesn't use it's internal state but i'll call reset() on it just in case
 		random.dist.reset();
 
-		//create new organism array
-		NetworkOrganism* newOrganisms = (NetworkOrganism*)(malloc(sizeof(NetworkOrganism) * populationSize));
-		if (newOrganisms == nullptr)
-			throw std::runtime_error("Cannot allocate new organism array.");
-		memset(newOrganisms, 0, sizeof(NetworkOrganism) * populationSize);
-
-		//Retain elite in next generation
-		uint32_t eliteCount = std::min((uint32_t)(elitePercent * populationSize), populationSize);
-		for (size_t i = 0; i < eliteCount; i++)
+		//the new generation is made in the last generation's organisms, so it is only allocated the first time (or when the population size changes)
+		uint32_t newSize = nextPopulationSize;
+		if (spareOrganisms != nullptr && newSize != populationSize)
+			FreeOrganisms(spareOrganisms);
+		if (spareOrganisms == nullptr)
 		{
-			new (newOrganisms + i) NetworkOrganism(organisms[fitnessOrderedIndexes[i]]);
-			if (!staticEpisodes)
-				newOrganisms[i].Reset();
+			spareOrganisms = (NetworkOrganism*)(malloc(sizeof(NetworkOrganism) * newSize));
+			if (spareOrganisms == nullptr)
+				throw std::runtime_error("Cannot allocate new organism array.");
+			for (size_t i = 0; i < newSize; i++)
+				new (spareOrganisms + i) NetworkOrganism(organisms[0].network);
 		}
+		NetworkOrganism* newOrganisms = spareOrganisms;
+		NLV_STATS_ONLY(stats.allocationNanoseconds = timing::Lap(phaseStart));
+		if (trace)
+			trace->Lap("Allocation", traceStart);
+
+		//the elite are kept in the next generation (they are moved in once every child has been made, since they can be parents)
+		eliteCount = std::min((uint32_t)(elitePercent * newSize), std::min(newSize, populationSize));
 
 		//the rest of the newGeneration will be populated with children of the previous generation
 		int childIndex = eliteCount;
@@ -169,12 +276,12 @@ namespace nlv
 			//inverseTotalFitness += fitnessAddition * population;
 			//inverseTotalFitness = 1.0f / (inverseTotalFitness);
 
-			while (childIndex < populationSize)
+			while (childIndex < newSize)
 			{
 				NetworkOrganism& p1 = SelectionFitnessProportional(fitnessAddition);
 				NetworkOrganism& p2 = SelectionFitnessProportional(fitnessAddition);
 
-				new (newOrganisms + childIndex) NetworkOrganism(p1.network);
+				newOrganisms[childIndex].Reset();
 				Crossover(newOrganisms[childIndex], p1, p2);
 				childIndex++;
 			}
@@ -185,12 +292,12 @@ namespace nlv
 			//1 / guass formula
 			float inverseSumOfAllRanks = 2.0f / (populationSize * (populationSize + 1));
 
-			while (childIndex < populationSize)
+			while (childIndex < newSize)
 			{
 				NetworkOrganism& p1 = SelectionRanked(inverseSumOfAllRanks);
 				NetworkOrganism& p2 = SelectionRanked(inverseSumOfAllRanks);
 
-				new (newOrganisms + childIndex) NetworkOrganism(p1.network);
+				newOrganisms[childIndex].Reset();
 				Crossover(newOrganisms[childIndex], p1, p2);
 				childIndex++;
 			}
@@ -199,7 +306,7 @@ namespace nlv
 		case EvolverSelectionType::Tournament:
 		{
 			std::vector<int> tournament(tournamentSize);
-			while (childIndex < populationSize)
+			while (childIndex < newSize)
 			{
 				//get tournamentSize random indexes
 				for (size_t i = 0; i < tournamentSize; i++)
@@ -229,7 +336,7 @@ namespace nlv
 
 				NetworkOrganism* p1 = organisms + best;
 				NetworkOrganism* p2 = organisms + secondBest;
-				new (newOrganisms + childIndex) NetworkOrganism(p1->network);
+				newOrganisms[childIndex].Reset();
 				Crossover(newOrganisms[childIndex], *p1, *p2);
 				childIndex++;
 			}
@@ -243,12 +350,12 @@ namespace nlv
 			NetworkOrganism* p1;
 			NetworkOrganism* p2;
 
-			while (childIndex < populationSize)
+			while (childIndex < newSize)
 			{
 				selectionCallback(organisms, p1);
 				selectionCallback(organisms, p2);
 
-				new (newOrganisms + childIndex) NetworkOrganism(p1->network);
+				newOrganisms[childIndex].Reset();
 				Crossover(newOrganisms[childIndex], *p1, *p2);
 				childIndex++;
 			}
@@ -259,31 +366,48 @@ namespace nlv
 			break;
 		}
 
+		//the networks are swapped rather than copied, what the elite leave behind is reused next generation
+		for (size_t i = 0; i < eliteCount; i++)
+		{
+			NetworkOrganism& elite = organisms[fitnessOrderedIndexes[i]];
+			std::swap(newOrganisms[i].network, elite.network);
+			newOrganisms[i].fitness = elite.fitness;
+			newOrganisms[i].steps = elite.steps;
+			newOrganisms[i].continueStepping = elite.continueStepping;
+			if (!staticEpisodes)
+				newOrganisms[i].Reset();
+		}
+		NLV_STATS_ONLY(stats.selectionNanoseconds = timing::Lap(phaseStart));
+		if (trace)
+			trace->Lap("Selection", traceStart);
+
 		//Mutate new children
 		switch (mutationType)
 		{
 		case EvolverMutationType::Set:
-			for (size_t i = eliteCount; i < populationSize; i++)
+			for (size_t i = eliteCount; i < newSize; i++)
 			{
 				while (random.Chance() < mutationRate)
 					MutateSet(newOrganisms[i]);
 			}
 			break;
 		case EvolverMutationType::Add:
-			for (size_t i = eliteCount; i < populationSize; i++)
+			for (size_t i = eliteCount; i < newSize; i++)
 			{
 				while (random.Chance() < mutationRate)
 					MutateAdd(newOrganisms[i]);
 			}
 			break;
 		case EvolverMutationType::Custom:
-			for (size_t i = eliteCount; i < populationSize; i++)
+			for (size_t i = eliteCount; i < newSize; i++)
 			{
 				if (!mutationCallback)
 					throw std::runtime_error("Mutation callback cannot be nullptr when mutation type is custom");
 				while (random.Chance() < mutationRate)
 				{
-					mutationCallback(organisms[i].network.genes, organisms[i]);
+					float* genes = WidenGenes(newOrganisms[i], 0);
+					mutationCallback(genes, newOrganisms[i]);
+					NarrowGenes(newOrganisms[i], genes);
 				}
 			}
 			break;
@@ -291,14 +415,34 @@ namespace nlv
 			throw std::runtime_error("Mutation type is incorrectly defined");
 			break;
 		}
+		if (connectionMasks)
+		{
+			for (size_t i = eliteCount; i < newSize; i++)
+				MutateConnections(newOrganisms[i]);
+		}
+		NLV_STATS_ONLY(stats.mutationNanoseconds = timing::Lap(phaseStart));
+		if (trace)
+			trace->Lap("Mutation", traceStart);
 
-		//destroy previous generation
-		for (size_t i = 0; i < populationSize; i++)
-			(*(organisms + i)).~NetworkOrganism();
-		free(organisms);
-
-		//set organisms to the new generation
+		//set organisms to the new generation, the previous one is kept to make the next generation in
+		if (newSize == populationSize)
+			spareOrganisms = organisms;
+		else
+		{
+			//(unless it is a different size)
+			FreeOrganisms(organisms);
+			spareOrganisms = nullptr;
+			populationSize = newSize;
+			delete[] fitnessOrderedIndexes;
+			fitnessOrderedIndexes = new uint32_t[populationSize];
+			for (uint32_t i = 0; i < populationSize; i++)
+				fitnessOrderedIndexes[i] = i;
+		}
 		organisms = newOrganisms;
+		BindHiddenStates();
+		NLV_STATS_ONLY(stats.allocationNanoseconds += timing::Lap(phaseStart));
+		if (trace)
+			trace->Lap("Allocation", traceStart);
 	}
 
 	NetworkOrganism& NetworkEvolver::SelectionFitnessProportional(float fitnessAddition)
@@ -339,44 +483,104 @@ namespace nlv
 
 	}
 
+	void NetworkEvolver::BindHiddenStates()
+	{
+		stateCount = organisms[0].network.GetStateCount();
+		if (stateCount == 0)
+			return;
+
+		hiddenStates.resize((size_t)populationSize * stateCount);
+		for (uint32_t i = 0; i < populationSize; i++)
+			organisms[i].network.UseExternalState(hiddenStates.data() + (size_t)i * stateCount);
+	}
+
+	float* NetworkEvolver::WidenGenes(NetworkOrganism& organism, uint32_t slot)
+	{
+		if (organism.network.genes)
+			return organism.network.genes;
+		float* genes = widenedGenes.data() + slot * (size_t)organism.network.geneCount;
+		organism.network.CopyGenes(genes);
+		return genes;
+	}
+
+	void NetworkEvolver::NarrowGenes(NetworkOrganism& organism, const float* genes)
+	{
+		if (genes != organism.network.genes)
+			organism.network.SetGenes(genes);
+		else
+			//the genes were written in place, so the packed weights are out of date
+			organism.network.packedWeights.clear();
+	}
+
 	void NetworkEvolver::Crossover(NetworkOrganism& child, NetworkOrganism& p1, NetworkOrganism& p2)
 	{
-		//note: assumes child's network is a clone of p1 already
-		switch (crossoverType)
+		uint32_t geneCount = child.network.geneCount;
+		//connection masks follow the genes they belong to
+		uint8_t* childMask = child.network.connectionMask;
+		const uint8_t* p1Mask = p1.network.connectionMask;
+		const uint8_t* p2Mask = p2.network.connectionMask;
+		if (!p1Mask || !p2Mask)
+			childMask = nullptr;
+		else
+			child.network.sparseDirty = true;
+
+		//point crossovers copy whole ranges from a parent, which is done without widening (and shares whole pages if the genes are shared)
+		auto copyRange = [&](const NetworkOrganism& parent, const uint8_t* parentMask, uint32_t start, uint32_t end)
 		{
-		case EvolverCrossoverType::Uniform:
+			child.network.SetGeneRange(parent.network, start, end);
+			if (childMask)
+				memcpy(childMask + start, parentMask + start, end - start);
+		};
+		if (crossoverType == EvolverCrossoverType::Point)
 		{
-			for (size_t i = 0; i < child.network.geneCount; i++)
-			{
-				if (random.Chance() > 0.5f)
-					child.network.genes[i] = p2.network.genes[i];
-			}
+			uint32_t point = random.ChanceIndex(geneCount);
+			copyRange(p1, p1Mask, 0, point);
+			copyRange(p2, p2Mask, point, geneCount);
+			return;
 		}
-		break;
-		case EvolverCrossoverType::Point:
+		if (crossoverType == EvolverCrossoverType::TwoPoint)
 		{
-			uint32_t point = random.ChanceIndex(child.network.geneCount);
-			memcpy(child.network.genes + point, p2.network.genes + point, (child.network.geneCount - point) * sizeof(float));
+			uint32_t point1 = random.ChanceIndex(geneCount);
+			uint32_t point2 = random.ChanceIndex(geneCount);
+			if (point1 > point2)
+				std::swap(point1, point2);
+			copyRange(p1, p1Mask, 0, point1);
+			copyRange(p2, p2Mask, point1, point2);
+			copyRange(p1, p1Mask, point2, geneCount);
+			return;
 		}
-		break;
-		case EvolverCrossoverType::TwoPoint:
+		//custom crossover gets a child that is a copy of p1 (so only the pages the callback changes stop being shared with p1)
+		if (crossoverType == EvolverCrossoverType::Custom)
+			copyRange(p1, p1Mask, 0, geneCount);
+
+		//the other crossovers are done on floats, so 16 bit genes are widened first and rounded when they are written back
+		float* childGenes = WidenGenes(child, 0);
+		const float* p1Genes = WidenGenes(p1, 1);
+		const float* p2Genes = WidenGenes(p2, 2);
+
+		//every gene (and mask) of the child is written once, from whichever parent it comes from
+		switch (crossoverType)
 		{
-			uint32_t point1 = random.ChanceIndex(child.network.geneCount);
-			uint32_t point2 = random.ChanceIndex(child.network.geneCount);
-			uint32_t size;
-			if (point1 > point2)
+		case EvolverCrossoverType::Uniform:
+		{
+			for (size_t i = 0; i < geneCount; i++)
 			{
-				size = point1 - point2;
-				point1 = point2;
+				bool fromP2 = random.Chance() > 0.5f;
+				childGenes[i] = fromP2 ? p2Genes[i] : p1Genes[i];
+				if (childMask)
+					childMask[i] = fromP2 ? p2Mask[i] : p1Mask[i];
 			}
-			else
-				size = point2 - point1;
-			memcpy(child.network.genes + point1, p2.network.genes + point1, size * sizeof(float));
 		}
 		break;
 		case EvolverCrossoverType::Arithmetic:
-			for (size_t i = 0; i < child.network.geneCount; i++)
-				child.network.genes[i] = (p1.network.genes[i] + p2.network.genes[i]) * 0.5f;
+			for (size_t i = 0; i < geneCount; i++)
+				childGenes[i] = (p1Genes[i] + p2Genes[i]) * 0.5f;
+			//blended connections are enabled if either parent has them
+			if (childMask)
+			{
+				for (size_t i = 0; i < geneCount; i++)
+					childMask[i] = p1Mask[i] | p2Mask[i];
+			}
 			break;
 		case EvolverCrossoverType::ArithmeticProportional:
 
@@ -385,8 +589,13 @@ namespace nlv
 				t = 0.5f;
 			else
 				t = p1.fitness / (p1.fitness + p2.fitness);
-			for (size_t i = 0; i < child.network.geneCount; i++)
-				child.network.genes[i] = p1.network.genes[i] * t + (1 - t) * p2.network.genes[i];
+			for (size_t i = 0; i < geneCount; i++)
+				childGenes[i] = p1Genes[i] * t + (1 - t) * p2Genes[i];
+			if (childMask)
+			{
+				for (size_t i = 0; i < geneCount; i++)
+					childMask[i] = p1Mask[i] | p2Mask[i];
+			}
 			break;
 		case EvolverCrossoverType::Custom:
 		{
@@ -394,102 +603,484 @@ namespace nlv
 			if (!crossoverCallback)
 				throw std::runtime_error("Crossover callback cannot be nullptr when crossover type is custom");
 #endif
-			crossoverCallback(child.network.genes, p1, p2, p1.network.genes, p2.network.genes);
+			crossoverCallback(childGenes, p1, p2, p1Genes, p2Genes);
 		}
 		break;
 		default:
 			throw std::runtime_error("Crossover type is incorrectly defined");
 			break;
 		}
+		NarrowGenes(child, childGenes);
+	}
+
+	uint32_t NetworkEvolver::CreateSteadyStateChild(uint8_t* busy)
+	{
+		uint32_t loser = RandomIdleOrganism(busy);
+		switch (replacementType)
+		{
+		case EvolverReplacementType::Worst:
+			for (uint32_t i = 0; i < populationSize; i++)
+			{
+				if (!busy[i] && organisms[i].fitness < organisms[loser].fitness)
+					loser = i;
+			}
+			break;
+		case EvolverReplacementType::Tournament:
+			for (uint32_t i = 1; i < tournamentSize; i++)
+			{
+				uint32_t index = RandomIdleOrganism(busy);
+				if (organisms[index].fitness < organisms[loser].fitness)
+					loser = index;
+			}
+			break;
+		default:
+			throw std::runtime_error("Replacement type is incorrectly defined");
+		}
+		//the loser is gone as soon as the child is made, so it can't be a parent either
+		busy[loser] = true;
+
+		//the two best from a tournament are the parents
+		uint32_t p1 = RandomIdleOrganism(busy);
+		uint32_t p2 = RandomIdleOrganism(busy);
+		if (organisms[p2].fitness > organisms[p1].fitness)
+			std::swap(p1, p2);
+		for (uint32_t i = 2; i < tournamentSize; i++)
+		{
+			uint32_t index = RandomIdleOrganism(busy);
+			if (organisms[index].fitness > organisms[p1].fitness)
+			{
+				p2 = p1;
+				p1 = index;
+			}
+			else if (organisms[index].fitness > organisms[p2].fitness)
+				p2 = index;
+		}
+
+		NetworkOrganism& child = organisms[loser];
+		Crossover(child, organisms[p1], organisms[p2]);
+		MutateChild(child);
+		return loser;
+	}
+
+	uint32_t NetworkEvolver::RandomIdleOrganism(const uint8_t* busy)
+	{
+		uint32_t index;
+		do {
+			index = random.Chance() * populationSize;
+		} while (index >= populationSize || busy[index]);
+		return index;
+	}
+
+	void NetworkEvolver::MutateChild(NetworkOrganism& child)
+	{
+		switch (mutationType)
+		{
+		case EvolverMutationType::Set:
+			while (random.Chance() < mutationRate)
+				MutateSet(child);
+			break;
+		case EvolverMutationType::Add:
+			while (random.Chance() < mutationRate)
+				MutateAdd(child);
+			break;
+		case EvolverMutationType::Custom:
+			if (!mutationCallback)
+				throw std::runtime_error("Mutation callback cannot be nullptr when mutation type is custom");
+			while (random.Chance() < mutationRate)
+			{
+				float* genes = WidenGenes(child, 0);
+				mutationCallback(genes, child);
+				NarrowGenes(child, genes);
+			}
+			break;
+		default:
+			throw std::runtime_error("Mutation type is incorrectly defined");
+		}
+		if (connectionMasks)
+			MutateConnections(child);
 	}
 
 	void NetworkEvolver::MutateAdd(NetworkOrganism& org)
 	{
 		uint32_t randomGeneIndex = random.Chance() * org.network.geneCount;
-		org.network.genes[randomGeneIndex] = std::clamp(org.network.genes[randomGeneIndex] + mutationScale * random.Normal(), -1.0f, 1.0f);
+		org.network.SetGene(randomGeneIndex, std::clamp(org.network.GetGene(randomGeneIndex) + mutationScale * random.Normal(), -1.0f, 1.0f));
+	}
+
+	void NetworkEvolver::MutateConnections(NetworkOrganism& org)
+	{
+		Network& network = org.network;
+		if (!network.connectionMask)
+			return;
+		uint32_t weightCount = network.GetWeightCount();
+		while (random.Chance() < connectionToggleRate)
+		{
+			network.connectionMask[network.GetWeightGeneIndex(random.ChanceIndex(weightCount))] ^= 1;
+			network.sparseDirty = true;
+			network.packedWeights.clear();
+		}
 	}
 
 	void NetworkEvolver::MutateSet(NetworkOrganism& org)
 	{
 		uint32_t randomGeneIndex = random.ChanceIndex(org.network.geneCount);
-		org.network.genes[randomGeneIndex] = random.Value();
+		org.network.SetGene(randomGeneIndex, random.Value());
 	}
 
 	void NetworkEvolver::RunEpisode()
 	{
-		//if threaded stepping is enabled, the system creates episodeThreadCount threads and uses them to step through the organism
-		if (threadedStepping)
+		if (sharedMemoryBridge)
 		{
-			std::vector<std::thread> threads;
-			threads.reserve(episodeThreadCount);
+			RunEpisodeBridged();
+			return;
+		}
+		if (remoteEvaluator)
+		{
+			if (replicaCount > 1)
+				throw std::runtime_error("Replicas cannot be used with a remote evaluator");
+			//workers are separate processes, so this doesn't need threads
+			NLV_STATS_ONLY(uint64_t episodeStart = timing::Now());
+			EvolverTrace::Scope scope(trace, "Remote episode", GetEpisodeStartIndex(), populationSize);
+			StartProgress(populationSize - GetEpisodeStartIndex());
+			remoteEvaluator->Evaluate(*this, GetEpisodeStartIndex(), populationSize);
+			AddProgress(populationSize - GetEpisodeStartIndex());
+			//(forward passes and steps happen in the workers, so only the organisms and time are counted)
+#ifdef NLV_STATS
+			stats.organismsSkipped = GetEpisodeStartIndex();
+			stats.organismsEvaluated += populationSize - stats.organismsSkipped;
+			stats.episodeNanoseconds += timing::Now() - episodeStart;
+#endif
+			if (activateStaticEpisodes)
+				staticEpisodes = true;
+			return;
+		}
+		if (batchStepCallback)
+		{
+			if (replicaCount > 1)
+				throw std::runtime_error("Replicas cannot be used with a batch step callback");
+			RunEpisodeRanges([this](uint32_t startIndex, uint32_t endIndex)
+				{
+					auto stepRange = [this](uint32_t stepStart, uint32_t stepEnd) { batchStepCallback(*this, organisms, stepStart, stepEnd); };
+					RunEpisodeBatched(stepRange, startIndex, endIndex);
+				});
+			return;
+		}
+		if (stepCallback == nullptr)
+			throw std::runtime_error("Step callback cannot be nullptr");
 
-			//used to ignore the elite if it is prescient to do so (if elite would have the same fitness as the last episode)
-			uint32_t eliteTranslation;
-			if (staticEpisodes && currentGeneration != 0)
-				eliteTranslation = elitePercent * populationSize;
-			else
-				eliteTranslation = 0;
+		//the step callback is wrapped into a stepper so it goes through the same loop as a callable
+		auto stepper = [this](NetworkOrganism& organism, uint32_t organismIndex) { stepCallback(*this, organism, organismIndex); };
+		RunEpisode(stepper);
+	}
+
+	void NetworkEvolver::RunEpisodeBridged()
+	{
+		if (replicaCount > 1)
+			throw std::runtime_error("Replicas cannot be used with a shared memory bridge");
+		if (sharedMemoryBridge->GetPopulationSize() != populationSize || sharedMemoryBridge->GetInputCount() != neuralInputSize || sharedMemoryBridge->GetOutputCount() != neuralOutputSize)
+			throw std::runtime_error("The shared memory bridge was made for a different population or network size");
+
+		//the simulator gets the whole population every step, so this isn't threaded (the simulator can thread it instead)
+		NLV_STATS_ONLY(uint64_t episodeStart = timing::Now());
+		uint32_t startIndex = GetEpisodeStartIndex();
+		EvolverTrace::Scope scope(trace, "Bridged episode", startIndex, populationSize);
+		StartProgress(populationSize - startIndex);
+		sharedMemoryBridge->BeginEpisode(*this, organisms, startIndex, populationSize);
+		auto stepRange = [this](uint32_t stepStart, uint32_t stepEnd) { sharedMemoryBridge->Step(*this, organisms, stepStart, stepEnd); };
+		RunEpisodeBatched(stepRange, startIndex, populationSize);
+		NLV_STATS_ONLY(stats.organismsSkipped = startIndex);
+		NLV_STATS_ONLY(stats.episodeNanoseconds += timing::Now() - episodeStart);
+
+		if (activateStaticEpisodes)
+			staticEpisodes = true;
+	}
 
+	uint32_t NetworkEvolver::GetEpisodeStartIndex() const
+	{
+		//if every episode is the same the elite do not need to be stepped through since there fitness will be the same as previous episodes
+		//(evolution strategies don't have an elite)
+		if (staticEpisodes && currentGeneration != 0 && optimizerType == EvolverOptimizerType::Genetic)
+			return eliteCount;
+		return 0;
+	}
 
-			uint32_t perThreadAmount = (populationSize - eliteTranslation) / episodeThreadCount;
-			uint32_t extraIndex = episodeThreadCount - ((populationSize - eliteTranslation) % episodeThreadCount);
-			uint32_t startIndex = eliteTranslation;
-			for (uint32_t t = 0; t < episodeThreadCount; t++)
+#ifdef NLV_STATS
+	void NetworkEvolver::AddEpisodeCounters(const EvolverEpisodeCounters& counters)
+	{
+		std::lock_guard<std::mutex> lock(statsMutex);
+		stats.forwardPassNanoseconds += counters.forwardPassNanoseconds;
+		stats.stepNanoseconds += counters.stepNanoseconds;
+		stats.forwardPasses += counters.forwardPasses;
+		stats.steps += counters.steps;
+		stats.organismsEvaluated += counters.organisms;
+	}
+#endif
+
+	void NetworkEvolver::SetPopulationSize(uint32_t size)
+	{
+		if (size == 0)
+			throw std::runtime_error("Generation size cannot be 0");
+		if (optimizerType != EvolverOptimizerType::Genetic && size != populationSize)
+			throw std::runtime_error("Only the genetic optimizer can change population size");
+		nextPopulationSize = size;
+	}
+
+	void NetworkEvolver::SetAdaptivePopulation(uint32_t minSize, uint32_t maxSize, uint32_t patience, float shrinkFactor, float growFactor)
+	{
+		if (minSize == 0 || minSize > maxSize)
+			throw std::runtime_error("Adaptive population sizes have to be more than 0, and minSize can't be more than maxSize");
+		if (optimizerType != EvolverOptimizerType::Genetic)
+			throw std::runtime_error("Only the genetic optimizer can change population size");
+		adaptivePopulation = AdaptivePopulation();
+		adaptivePopulation.minSize = minSize;
+		adaptivePopulation.maxSize = maxSize;
+		adaptivePopulation.patience = std::max(patience, 1u);
+		adaptivePopulation.shrinkFactor = std::clamp(shrinkFactor, 0.0f, 1.0f);
+		adaptivePopulation.growFactor = std::max(growFactor, 1.0f);
+		nextPopulationSize = std::clamp(nextPopulationSize, minSize, maxSize);
+	}
+
+	void NetworkEvolver::ClearAdaptivePopulation()
+	{
+		adaptivePopulation = AdaptivePopulation();
+	}
+
+	void NetworkEvolver::AdaptPopulationSize()
+	{
+		if (adaptivePopulation.maxSize == 0)
+			return;
+
+		//a new best fitness means the search is going somewhere, so fewer organisms are needed
+		//(the first generation only sets where the best fitness starts)
+		float bestFitness = FindBestOrganism().fitness;
+		uint32_t size = nextPopulationSize;
+		if (!adaptivePopulation.hasBestFitness || bestFitness > adaptivePopulation.bestFitness)
+		{
+			if (adaptivePopulation.hasBestFitness)
+				size = (uint32_t)(size * adaptivePopulation.shrinkFactor);
+			adaptivePopulation.hasBestFitness = true;
+			adaptivePopulation.bestFitness = bestFitness;
+			adaptivePopulation.stagnantGenerations = 0;
+		}
+		//otherwise it has stagnated, more organisms give it more diversity to get out
+		else if (++adaptivePopulation.stagnantGenerations >= adaptivePopulation.patience)
+		{
+			size = (uint32_t)std::ceil(size * adaptivePopulation.growFactor);
+			adaptivePopulation.stagnantGenerations = 0;
+		}
+		nextPopulationSize = std::clamp(size, adaptivePopulation.minSize, adaptivePopulation.maxSize);
+	}
+
+	void NetworkEvolver::SetPopulationStatsHistory(uint32_t length)
+	{
+		populationStatsHistory.assign(length, EvolverPopulationStats());
+		populationStatsStart = 0;
+		populationStatsCount = 0;
+	}
+
+	const EvolverPopulationStats& NetworkEvolver::GetPopulationStats(uint32_t age) const
+	{
+		if (age >= populationStatsCount)
+			throw std::runtime_error("There are no population stats for that generation");
+		uint32_t length = (uint32_t)populationStatsHistory.size();
+		return populationStatsHistory[(populationStatsStart + populationStatsCount - 1 - age) % length];
+	}
+
+	void NetworkEvolver::AccumulateGeneStats(uint32_t startIndex, uint32_t endIndex, double* sums) const
+	{
+		uint32_t geneCount = GetGeneCount();
+		double* squares = sums + geneCount;
+		for (uint32_t i = startIndex; i < endIndex; i++)
+		{
+			const Network& network = organisms[i].network;
+			if (network.genes)
 			{
-				//if thread index is more than extraIndex, the thread needs to take care of one more organism
-				uint32_t endIndex = startIndex + perThreadAmount + (uint32_t)(t >= extraIndex);
-				//just runs the same function as non threaded in parallel 
-				//i know for a fact this is not a good way to do threading but I can't find a good example to base my implimentation off of
-				//its not like I can keep this thread alive over generations, I have no way to know when the user will call EvaluateGeneration()
-				threads.emplace_back(RunEpisodePerThread, this, startIndex, endIndex);
-				startIndex = endIndex;
+				const float* genes = network.genes;
+				for (uint32_t g = 0; g < geneCount; g++)
+				{
+					sums[g] += genes[g];
+					squares[g] += (double)genes[g] * genes[g];
+				}
 			}
-
-			//rejoin threads
-			for (auto& thread : threads)
+			else
 			{
-				thread.join();
+				for (uint32_t g = 0; g < geneCount; g++)
+				{
+					float gene = network.GetGene(g);
+					sums[g] += gene;
+					squares[g] += (double)gene * gene;
+				}
 			}
 		}
+	}
+
+	void NetworkEvolver::UpdatePopulationStats()
+	{
+		if (populationStatsHistory.empty())
+			return;
+		EvolverTrace::Scope scope(trace, "Population stats");
+
+		//gene stats, the episode threads already summed the genes if the episode was threaded
+		uint32_t geneCount = GetGeneCount();
+		uint32_t partCount = 1;
+		if (geneSumsReady)
+			partCount = (uint32_t)(geneSums.size() / ((size_t)geneCount * 2));
 		else
 		{
-			size_t i = 0;
-			//if every episode is the same the elite do not need to be stepped through since there fitness will be the same as previous episodes
-			if (staticEpisodes && currentGeneration != 0)
-				i = elitePercent * populationSize;
+			geneSums.assign((size_t)geneCount * 2, 0.0);
+			AccumulateGeneStats(0, populationSize, geneSums.data());
+		}
+		geneSumsReady = false;
 
-			//loop through all organisms and step through them
-			for (; i < populationSize; i++)
+		geneMeans.resize(geneCount);
+		geneVariances.resize(geneCount);
+		double deviationSum = 0;
+		for (uint32_t g = 0; g < geneCount; g++)
+		{
+			double sum = 0, squares = 0;
+			for (uint32_t p = 0; p < partCount; p++)
 			{
-				//an organism stops stepping if continuestepping evaluates to false or if the step count reaches maxSteps
-				for (; organisms[i].steps < maxSteps && organisms[i].continueStepping; organisms[i].steps++)
-				{
-					//evaluate organism brain
-					organisms[i].network.Evaluate(organisms[i].networkInputs, neuralInputSize);
-					//call the step callback 
-					stepCallback(*this, organisms[i], i);
-				}
+				sum += geneSums[(size_t)p * geneCount * 2 + g];
+				squares += geneSums[(size_t)p * geneCount * 2 + geneCount + g];
 			}
+			double mean = sum / populationSize;
+			//(can come out slightly negative from rounding)
+			double variance = std::max(squares / populationSize - mean * mean, 0.0);
+			geneMeans[g] = (float)mean;
+			geneVariances[g] = (float)variance;
+			deviationSum += std::sqrt(variance);
 		}
 
-		if (activateStaticEpisodes)
-			staticEpisodes = true;
+		//once the history is full the oldest generation is overwritten
+		uint32_t length = (uint32_t)populationStatsHistory.size();
+		uint32_t slot;
+		if (populationStatsCount < length)
+			slot = (populationStatsStart + populationStatsCount++) % length;
+		else
+		{
+			slot = populationStatsStart;
+			populationStatsStart = (populationStatsStart + 1) % length;
+		}
+		EvolverPopulationStats& populationStats = populationStatsHistory[slot];
+
+		populationStats.generation = currentGeneration;
+		populationStats.populationSize = populationSize;
+		populationStats.diversity = geneCount == 0 ? 0.0f : (float)(deviationSum / geneCount);
+
+		//fitness and step stats
+		std::vector<float> fitnesses(populationSize);
+		double fitnessSum = 0, fitnessSquares = 0;
+		uint64_t stepSum = 0;
+		uint32_t earlyTerminations = 0;
+		populationStats.bestIndex = 0;
+		for (uint32_t i = 0; i < populationSize; i++)
+		{
+			const NetworkOrganism& organism = organisms[i];
+			fitnesses[i] = organism.fitness;
+			fitnessSum += organism.fitness;
+			fitnessSquares += (double)organism.fitness * organism.fitness;
+			stepSum += organism.steps;
+			earlyTerminations += organism.steps < maxSteps;
+			if (organism.fitness > organisms[populationStats.bestIndex].fitness)
+				populationStats.bestIndex = i;
+		}
+		double fitnessMean = fitnessSum / populationSize;
+		populationStats.meanFitness = (float)fitnessMean;
+		populationStats.fitnessVariance = (float)std::max(fitnessSquares / populationSize - fitnessMean * fitnessMean, 0.0);
+		populationStats.meanSteps = (float)((double)stepSum / populationSize);
+		populationStats.earlyTerminationRate = (float)earlyTerminations / populationSize;
+
+		std::sort(fitnesses.begin(), fitnesses.end());
+		populationStats.minFitness = fitnesses.front();
+		populationStats.maxFitness = fitnesses.back();
+		const float quantiles[5] = { 0.1f, 0.25f, 0.5f, 0.75f, 0.9f };
+		for (uint32_t q = 0; q < 5; q++)
+		{
+			//linear interpolation between the closest ranks
+			float rank = quantiles[q] * (populationSize - 1);
+			uint32_t lower = (uint32_t)rank;
+			uint32_t upper = std::min(lower + 1, populationSize - 1);
+			populationStats.fitnessQuantiles[q] = fitnesses[lower] + (fitnesses[upper] - fitnesses[lower]) * (rank - lower);
+		}
+	}
 
+	float NetworkEvolver::GetProgress() const
+	{
+		uint32_t total = progressTotal.load(std::memory_order_relaxed);
+		if (total == 0)
+			return 0.0f;
+		uint32_t finished = 0;
+		for (uint32_t i = 0; i < PROGRESS_SLOTS; i++)
+			finished += progressCounters[i].finished.load(std::memory_order_relaxed);
+		//(can be read while the counters are being reset)
+		return std::min((float)finished / total, 1.0f);
+	}
+
+	void NetworkEvolver::StartProgress(uint32_t total)
+	{
+		for (uint32_t i = 0; i < PROGRESS_SLOTS; i++)
+			progressCounters[i].finished.store(0, std::memory_order_relaxed);
+		progressTotal.store(total, std::memory_order_relaxed);
 	}
 
-	void NetworkEvolver::RunEpisodePerThread(NetworkEvolver* obj, uint32_t startIndex, uint32_t endIndex)
+	void NetworkEvolver::PublishSnapshot()
 	{
-		for (size_t i = startIndex; i < endIndex; i++)
+		//the spare snapshot is the one published before the last, nobody can start reading it again so it can be reused if it isn't held
+		std::shared_ptr<EvolverSnapshot> next;
+		if (spareSnapshot && spareSnapshot.use_count() == 1)
 		{
-			NetworkOrganism& organism = obj->organisms[i];
-			//an organism stops stepping if continuestepping evaluates to false or if the step count reaches maxSteps
-			for (; organism.steps < obj->maxSteps && organism.continueStepping; organism.steps++)
-			{
-				//evaluate organism brain
-				organism.network.Evaluate(organism.networkInputs, obj->neuralInputSize);
-				//call the step callback 
-				obj->stepCallback(*obj, organism, i);
-			}
+			//(use_count doesn't synchronize with the last reader letting go of it)
+			std::atomic_thread_fence(std::memory_order_acquire);
+			next = std::move(spareSnapshot);
+		}
+		else
+			next = std::make_shared<EvolverSnapshot>();
+
+		next->generation = currentGeneration;
+		next->geneCount = GetGeneCount();
+		next->fitness.resize(populationSize);
+		next->steps.resize(populationSize);
+		for (uint32_t i = 0; i < populationSize; i++)
+		{
+			next->fitness[i] = organisms[i].fitness;
+			next->steps[i] = organisms[i].steps;
+		}
+
+		uint32_t bestCount = std::min(snapshotGenomeCount, populationSize);
+		std::vector<uint32_t>& best = next->bestIndexes;
+		best.resize(populationSize);
+		for (uint32_t i = 0; i < populationSize; i++)
+			best[i] = i;
+		std::partial_sort(best.begin(), best.begin() + bestCount, best.end(), [this](uint32_t a, uint32_t b) { return organisms[a].fitness > organisms[b].fitness; });
+		best.resize(bestCount);
+		next->bestGenes.resize((size_t)bestCount * next->geneCount);
+		for (uint32_t i = 0; i < bestCount; i++)
+			organisms[best[i]].network.CopyGenes(next->bestGenes.data() + (size_t)i * next->geneCount);
+
+		spareSnapshot = std::const_pointer_cast<EvolverSnapshot>(snapshot.exchange(std::move(next)));
+	}
+
+	float NetworkEvolver::ReduceReplicaFitness(float* replicaFitness) const
+	{
+		switch (fitnessReduction)
+		{
+		case EvolverFitnessReduction::Mean:
+		{
+			float sum = 0;
+			for (uint32_t i = 0; i < replicaCount; i++)
+				sum += replicaFitness[i];
+			return sum / replicaCount;
+		}
+		case EvolverFitnessReduction::Min:
+			return *std::min_element(replicaFitness, replicaFitness + replicaCount);
+		case EvolverFitnessReduction::Percentile:
+		{
+			//nearest rank
+			uint32_t index = (uint32_t)std::round(fitnessPercentile * (replicaCount - 1));
+			std::nth_element(replicaFitness, replicaFitness + index, replicaFitness + replicaCount);
+			return replicaFitness[index];
+		}
+		default:
+			throw std::runtime_error("Fitness reduction type is incorrectly defined");
 		}
 	}
 
@@ -498,14 +1089,7 @@ namespace nlv
 		if (!initialized)
 			throw std::runtime_error("NetworkEvolver was not initiated correctly");
 
-		CreateNewGen();
-		if (startCallback)
-			startCallback(*this, organisms);
-		RunEpisode();
-		if (endCallback)
-			endCallback(*this, organisms);
-		currentGeneration++;
-
+		RunGeneration([this]() { RunEpisode(); });
 	}
 
 	void NetworkEvolver::EvaluateGenerations(uint32_t count)
@@ -516,15 +1100,17 @@ namespace nlv
 			throw std::runtime_error("Count cannot be 0");
 
 		for (size_t i = 0; i < count; i++)
-		{
-			if (startCallback)
-				startCallback(*this, organisms);
-			CreateNewGen();
-			RunEpisode();
-			currentGeneration++;
-			if (endCallback)
-				endCallback(*this, organisms);
-		}
+			RunGeneration([this]() { RunEpisode(); });
+	}
+
+	void NetworkEvolver::EvaluateSteadyState(uint32_t evaluationCount)
+	{
+		if (stepCallback == nullptr)
+			throw std::runtime_error("Step callback cannot be nullptr");
+
+		//children are evaluated one at a time, so this always goes through the step callback (not the batch callback)
+		auto stepper = [this](NetworkOrganism& organism, uint32_t organismIndex) { stepCallback(*this, organism, organismIndex); };
+		EvaluateSteadyState(evaluationCount, stepper);
 	}
 
 	const NetworkOrganism& NetworkEvolver::FindBestOrganism() const
@@ -561,6 +1147,14 @@ namespace nlv
 		stepCallback = callback;
 	}
 
+	void NetworkEvolver::SetReplicas(uint32_t count, EvolverReplicaCallback callback)
+	{
+		if (count > 1 && callback == nullptr)
+			throw std::runtime_error("Replica callback cannot be nullptr when using more than one replica");
+		replicaCount = std::max(count, 1U);
+		replicaCallback = callback;
+	}
+
 	void NetworkEvolver::SetCustomCrossover(EvolverCustomCrossoverCallback callback)
 	{
 		crossoverCallback = callback;
@@ -663,7 +1257,7 @@ namespace nlv
 		{
 			for (size_t i = 0; i < geneCount; i++)
 			{
-				stream << organisms[i].network.genes[i];
+				stream << organisms[i].network.GetGene(i);
 			}
 			stream << organisms[i].fitness;
 		}
@@ -685,6 +1279,9 @@ namespace nlv
 
 		//delete contents first if already initialized
 		Uninitialize();
+		//(the history was for the old population)
+		populationStatsStart = 0;
+		populationStatsCount = 0;
 		
 		stream >> currentGeneration;
 		stream >> populationSize;
@@ -706,10 +1303,14 @@ namespace nlv
 		{
 			new (organisms + i) NetworkOrganism(network);
 			
-			const Network& network = organisms[i].GetNetwork();
+			Network& network = organisms[i].network;
+			network.SetGenePrecision(genePrecision);
+			network.SetSharedGenes(sharedGenes);
 			for (size_t i = 0; i < network.geneCount; i++)
 			{
-				stream >> network.genes[i];
+				float gene;
+				stream >> gene;
+				network.SetGene(i, gene);
 			}
 			stream >> organisms[i].fitness;
 		}
@@ -717,22 +1318,85 @@ namespace nlv
 		fitnessOrderedIndexes = new uint32_t[populationSize];
 		for (size_t i = 0; i < populationSize; i++)
 			fitnessOrderedIndexes[i] = i;
+		BindHiddenStates();
+		nextPopulationSize = populationSize;
+		eliteCount = std::min((uint32_t)(elitePercent * populationSize), populationSize);
+		adaptivePopulation.hasBestFitness = false;
+		adaptivePopulation.stagnantGenerations = 0;
 
 		initialized = true;
 		return true;
 	}
 
+	void NetworkEvolver::GetMigrants(uint32_t count, float* genes, float* fitnesses, uint8_t* masks) const
+	{
+		count = std::min(count, populationSize);
+		std::vector<uint32_t> indexes(populationSize);
+		for (uint32_t i = 0; i < populationSize; i++)
+			indexes[i] = i;
+		std::partial_sort(indexes.begin(), indexes.begin() + count, indexes.end(), [this](uint32_t a, uint32_t b) { return organisms[a].fitness > organisms[b].fitness; });
+
+		uint32_t geneCount = organisms[0].network.geneCount;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const NetworkOrganism& organism = organisms[indexes[i]];
+			organism.network.CopyGenes(genes + i * geneCount);
+			fitnesses[i] = organism.fitness;
+			if (masks)
+			{
+				const uint8_t* mask = organism.network.connectionMask;
+				if (mask)
+					memcpy(masks + (size_t)i * geneCount, mask, geneCount);
+				else
+					memset(masks + (size_t)i * geneCount, 1, geneCount);
+			}
+		}
+	}
+
+	void NetworkEvolver::ReceiveMigrants(uint32_t count, const float* genes, const float* fitnesses, const uint8_t* masks)
+	{
+		count = std::min(count, populationSize);
+		std::vector<uint32_t> indexes(populationSize);
+		for (uint32_t i = 0; i < populationSize; i++)
+			indexes[i] = i;
+		std::partial_sort(indexes.begin(), indexes.begin() + count, indexes.end(), [this](uint32_t a, uint32_t b) { return organisms[a].fitness < organisms[b].fitness; });
+
+		//migrants keep the fitness they had on their island, so they take part in selection straight away
+		//(if episodes are static and a migrant becomes elite, it will not be stepped again on this island)
+		uint32_t geneCount = organisms[0].network.geneCount;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			NetworkOrganism& organism = organisms[indexes[i]];
+			organism.network.SetGenes(genes + i * geneCount);
+			organism.fitness = fitnesses[i];
+			//the migrant's disabled connections come with it, otherwise it would be a different genome to the one that was selected
+			if (masks && organism.network.connectionMask)
+			{
+				memcpy(organism.network.connectionMask, masks + (size_t)i * geneCount, geneCount);
+				organism.network.sparseDirty = true;
+			}
+		}
+	}
+
 	void NetworkEvolver::Uninitialize()
 	{
 		if (initialized)
 		{
-			for (size_t i = 0; i < populationSize; i++)
-				(*(organisms + i)).~NetworkOrganism();
-			free(organisms);
+			FreeOrganisms(organisms);
+			FreeOrganisms(spareOrganisms);
 			delete[] fitnessOrderedIndexes;
 			fitnessOrderedIndexes = nullptr;
-			organisms = nullptr;
 			initialized = false;
 		}
 	}
+
+	void NetworkEvolver::FreeOrganisms(NetworkOrganism*& array)
+	{
+		if (array == nullptr)
+			return;
+		for (size_t i = 0; i < populationSize; i++)
+			array[i].~NetworkOrganism();
+		free(array);
+		array = nullptr;
+	}
 }
\ No newline at end of file
@@ -4,13 +4,26 @@
 #include <sstream>
 #include <random>
 #include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
 #include "EvolverEnums.h"
 #include "NetworkEvolverBuilder.h"
+#include "NetworkRemoteEvaluator.h"
+#include "NetworkSharedMemoryBridge.h"
+#include "EvolutionStrategy.h"
+#include "EvolverStats.h"
+#include "EvolverTrace.h"
 
 namespace nlv
 {
 	class NetworkEvolver
 	{
+		//used for migration between islands
+		friend class NetworkIslandEvolver;
+		//sets the fitness of organisms evaluated by workers
+		friend class NetworkRemoteEvaluator;
 	public:
 		//this will not fully initiate the network evolver
 		NetworkEvolver() = default;
@@ -50,14 +63,46 @@ namespace nlv
 		// Evaluates several generations: constructs new generations and calculates fitness values for them
 		void EvaluateGenerations(uint32_t count);
 
+		// Same as EvaluateGeneration, but organisms are stepped through a callable instead of the step callback (the batch step callback is not used either)
+		// Since the type of the callable is known the compiler can inline it into the episode loop, unlike the step callback
+		// stepper: any callable that takes (NetworkOrganism& organism, uint32_t organismIndex), called for each organism every step. 
+		// it is shared between threads when episodes are threaded, so per organism state should be indexed with organismIndex
+		template<typename Stepper>
+		void EvaluateGeneration(Stepper&& stepper);
+		// Same as EvaluateGenerations, but organisms are stepped through a callable (see EvaluateGeneration(Stepper&&))
+		template<typename Stepper>
+		void EvaluateGenerations(uint32_t count, Stepper&& stepper);
+
+		// Evaluates organisms without generations: each episode thread repeatedly creates a child from the current population, replaces a loser with it and evaluates it
+		// Threads never wait for each other, so one long episode doesn't hold up the rest of the population
+		// The first population is evaluated normally first (calling the start and end callbacks), after that only the birth callback is called
+		// Parents are chosen by tournament, the loser is chosen by the replacement type. The child is evaluated in the loser's place, so organismIndex stays below the population size
+		// evaluationCount: the number of children to evaluate
+		void EvaluateSteadyState(uint32_t evaluationCount);
+		// Same as EvaluateSteadyState, but organisms are stepped through a callable (see EvaluateGeneration(Stepper&&))
+		template<typename Stepper>
+		void EvaluateSteadyState(uint32_t evaluationCount, Stepper&& stepper);
+
 		//Finds the organism with the highest fitness
 		const NetworkOrganism& FindBestOrganism() const;
 
 		//Getters
 		inline const NetworkOrganism const* GetPopulationArray() const { return organisms; }
 		inline uint32_t GetGeneration() const { return currentGeneration; }
+		// Returns the number of children evaluated with EvaluateSteadyState (every populationSize of them also counts as a generation)
+		inline uint64_t GetSteadyStateEvaluations() const { return steadyStateEvaluations; }
 		inline uint32_t GetPopulationSize() const { return populationSize; }
+		// Returns the number of organisms the next generation will be made with (see SetPopulationSize)
+		inline uint32_t GetNextPopulationSize() const { return nextPopulationSize; }
+		inline bool GetIsAdaptivePopulation() const { return adaptivePopulation.maxSize != 0; }
+		inline uint32_t GetGeneCount() const { return initialized ? organisms[0].network.geneCount : 0; }
 		inline bool GetIfThreadedEpisodes() const { return threadedStepping; }
+		inline bool GetQuantizedInference() const { return quantizedInference; }
+		inline bool GetPackedInference() const { return packedInference; }
+		inline GenePrecision GetGenePrecision() const { return genePrecision; }
+		inline bool GetSharedGenes() const { return sharedGenes; }
+		inline bool GetHasConnectionMasks() const { return connectionMasks; }
+		inline float GetConnectionToggleRate() const { return connectionToggleRate; }
 		inline bool GetStaticEpisodes() const { return staticEpisodes; }
 		inline bool GetIsInitiated() const { return initialized; }
 		inline float GetMutationScale() const { return mutationScale; }
@@ -67,15 +112,52 @@ namespace nlv
 		inline uint32_t GetTournamentSize() const { return tournamentSize; }
 		inline uint32_t GetEpisodeThreadCount() const { return episodeThreadCount; }
 		inline EvolverStepCallback GetStepCallback() const { return stepCallback; }
+		inline EvolverBatchStepCallback GetBatchStepCallback() const { return batchStepCallback; }
+		inline EvolverReplicaCallback GetReplicaCallback() const { return replicaCallback; }
+		inline uint32_t GetReplicaCount() const { return replicaCount; }
+		inline EvolverFitnessReduction GetFitnessReduction() const { return fitnessReduction; }
+		inline float GetFitnessPercentile() const { return fitnessPercentile; }
+		inline EvolverOrganismCallback GetBirthCallback() const { return birthCallback; }
+		inline EvolverReplacementType GetReplacementType() const { return replacementType; }
+		inline EvolverOptimizerType GetOptimizerType() const { return optimizerType; }
+		// The state of the evolution strategy (only used if the optimizer type isn't Genetic)
+		inline const EvolutionStrategy& GetEvolutionStrategy() const { return strategy; }
 		inline EvolverGenerationCallback GetStartCallback() const { return startCallback; }
 		inline EvolverGenerationCallback GetEndCallback() const { return endCallback; }
 		inline EvolverCrossoverType GetCrossoverType() const { return crossoverType; }
 		inline EvolverMutationType GetMutationType() const { return mutationType; }
 		inline EvolverSelectionType GetSelectionType() const { return selectionType; }
 		inline void* GetUserPointer() const { return userPointer; }
+		inline NetworkRemoteEvaluator* GetRemoteEvaluator() const { return remoteEvaluator; }
+		inline NetworkSharedMemoryBridge* GetSharedMemoryBridge() const { return sharedMemoryBridge; }
+		// Timings and counters of the last generation (read them in the end callback). Always empty unless NLV_STATS is defined
+		inline const EvolverStats& GetStats() const { return stats; }
+		inline EvolverTrace* GetTrace() const { return trace; }
+		// Returns the number of generations in the population stats history
+		inline uint32_t GetPopulationStatsCount() const { return populationStatsCount; }
+		inline uint32_t GetPopulationStatsHistoryLength() const { return (uint32_t)populationStatsHistory.size(); }
+		// Returns the population stats of a past generation (only available if the history length isn't 0)
+		// age: 0 is the last evaluated generation, 1 the one before that and so on (has to be less than GetPopulationStatsCount())
+		const EvolverPopulationStats& GetPopulationStats(uint32_t age = 0) const;
+		// Returns how much of the current episode (or steady state run) is done, from 0 to 1
+		// Can be called from any thread while the evolver is running
+		float GetProgress() const;
+		// Returns the snapshot published after the last generation (nullptr before the first one)
+		// Can be called from any thread while the evolver is running, the snapshot stays valid for as long as it is held
+		inline std::shared_ptr<const EvolverSnapshot> GetSnapshot() const { return snapshot.load(); }
+		inline uint32_t GetSnapshotGenomeCount() const { return snapshotGenomeCount; }
+		// The mean and variance of every gene over the population of the last evaluated generation
+		inline const std::vector<float>& GetGeneMeans() const { return geneMeans; }
+		inline const std::vector<float>& GetGeneVariances() const { return geneVariances; }
 
 		//Setters
 		inline void SetIsThreadedEpisodes(bool threaded) { threadedStepping = threaded; }
+		// Whether organisms are evaluated with int8 weights during episodes (remote workers and the shared memory bridge evaluate networks themselves, so they aren't affected)
+		inline void SetQuantizedInference(bool quantized) { quantizedInference = quantized; }
+		// Whether organisms are evaluated with packed weights during episodes (see Network::Pack). Quantized inference is used instead if both are on
+		inline void SetPackedInference(bool packed) { packedInference = packed; }
+		// Only used if the evolver was built with connection masks (evolution strategies don't change masks)
+		inline void SetConnectionToggleRate(float rate) { connectionToggleRate = std::clamp(rate, 0.0f, 1.0f); }
 		void SetStaticEpisodes(bool staticEpisodes);
 		inline void SetMutationRate(float rate) { mutationRate = std::clamp(rate, 0.0f, 1.0f); }
 		inline void SetMutationScale(float scale) { mutationScale = scale; }
@@ -84,12 +166,46 @@ namespace nlv
 		inline void SetTournamentSize(uint32_t size) { tournamentSize = std::max(3U, size); }
 		inline void SetEpisodeThreadCount(uint32_t count) { episodeThreadCount = std::max(1U, count); }
 		void SetStepCallback(EvolverStepCallback callback);
+		// Setting this to nullptr goes back to stepping organisms one at a time through the step callback
+		inline void SetBatchStepCallback(EvolverBatchStepCallback callback) { batchStepCallback = callback; }
+		// count: the number of episodes every organism is evaluated over (1 turns replicas off)
+		// callback: called before every replica, cannot be nullptr if count is more than 1
+		void SetReplicas(uint32_t count, EvolverReplicaCallback callback);
+		// percentile: only used for EvolverFitnessReduction::Percentile
+		inline void SetFitnessReduction(EvolverFitnessReduction reduction, float percentile = 0.5f) { fitnessReduction = reduction; fitnessPercentile = std::clamp(percentile, 0.0f, 1.0f); }
+		inline void SetBirthCallback(EvolverOrganismCallback callback) { birthCallback = callback; }
+		inline void SetReplacementType(EvolverReplacementType type) { replacementType = type; }
+		// Only used if the optimizer type isn't Genetic
+		inline void SetStrategyLearningRate(float rate) { strategy.SetLearningRate(rate); }
 		inline void SetStartCallback(EvolverGenerationCallback callback) { startCallback = callback; }
 		inline void SetEndCallback(EvolverGenerationCallback callback) { endCallback = callback; }
 		inline void SetCrossoverType(EvolverCrossoverType type) { crossoverType = type; }
 		inline void SetMutationType(EvolverMutationType type) { mutationType = type; }
 		inline void SetSelectionType(EvolverSelectionType type) { selectionType = type; }
 		inline void SetUserPointer(void* ptr) { userPointer = ptr; }
+		// Organisms are evaluated by the evaluator's worker processes instead of the step callbacks while this is set (nullptr turns it off)
+		// The evaluator is not owned by the evolver and has to outlive it (or be unset first)
+		inline void SetRemoteEvaluator(NetworkRemoteEvaluator* evaluator) { remoteEvaluator = evaluator; }
+		// Organisms are stepped by a simulator in another process instead of the step callbacks while this is set (nullptr turns it off)
+		// The bridge is not owned by the evolver and has to outlive it (or be unset first)
+		inline void SetSharedMemoryBridge(NetworkSharedMemoryBridge* bridge) { sharedMemoryBridge = bridge; }
+		// Every generation is recorded into the trace while this is set (nullptr turns it off)
+		// The trace is not owned by the evolver and has to outlive it (or be unset first)
+		inline void SetTrace(EvolverTrace* evolverTrace) { trace = evolverTrace; }
+		// Sets the number of best organisms whose genes are copied into snapshots
+		inline void SetSnapshotGenomeCount(uint32_t count) { snapshotGenomeCount = count; }
+		// Sets the number of generations population stats are kept for (0 stops collecting them). Clears the history
+		void SetPopulationStatsHistory(uint32_t length);
+		// Sets the number of organisms the next generations are made with. The best organisms are kept as elite like every generation, and every other slot is filled with a child
+		// only the genetic optimizer can change population size, and steady state evolution keeps the size the population has
+		void SetPopulationSize(uint32_t size);
+		// Changes the population size after every generation: it shrinks while the best fitness goes up, and grows when it hasn't gone up for patience generations
+		// minSize, maxSize: the smallest and largest the population can get
+		// patience: the number of generations without a new best fitness before the population grows
+		// shrinkFactor, growFactor: what the population size is multiplied by when it shrinks or grows
+		void SetAdaptivePopulation(uint32_t minSize, uint32_t maxSize, uint32_t patience = 5, float shrinkFactor = 0.9f, float growFactor = 1.5f);
+		// Stops changing the population size automatically (it keeps the size it has)
+		void ClearAdaptivePopulation();
 		void SetCustomCrossover(EvolverCustomCrossoverCallback callback);
 		void SetCustomMutation(EvolverCustomMutationCallback callback);
 		void SetCustomSelection(EvolverCustomSelectionCallback callback);
@@ -101,13 +217,110 @@ namespace nlv
 		NetworkOrganism& SelectionFitnessProportional(float fitnessAddition);
 		NetworkOrganism& SelectionRanked(float inverseSumOfAllRanks);
 		//Crossover function
+		// writes every one of the child's genes (the child doesn't have to be a copy of p1 first, except for custom crossover where it is made one)
 		void Crossover(NetworkOrganism& child, NetworkOrganism& p1, NetworkOrganism& p2);
+		// Returns the organism's genes as floats. If they are stored in 16 bits or shared they are copied into slot (0-2) of widenedGenes
+		float* WidenGenes(NetworkOrganism& organism, uint32_t slot);
+		// Writes genes returned by WidenGenes back into the organism (rounding them)
+		void NarrowGenes(NetworkOrganism& organism, const float* genes);
 		//Mutate functions
 		void MutateSet(NetworkOrganism& org);
 		void MutateAdd(NetworkOrganism& org);
-		// Step through the current generation
+		// Enables or disables random connections of a child (if connection masks are used)
+		void MutateConnections(NetworkOrganism& org);
+		// Makes the next generation and runs its episode, calling the generation callbacks (every EvaluateGeneration(s) overload goes through this)
+		// runEpisode: called to step through the new generation
+		template<typename EpisodeFunction>
+		void RunGeneration(EpisodeFunction&& runEpisode);
+		// Step through the current generation using the step callbacks
 		void RunEpisode();
-		static void RunEpisodePerThread(NetworkEvolver* obj, uint32_t startIndex, uint32_t endIndex);
+		// Step through the current generation using a callable
+		template<typename Stepper>
+		void RunEpisode(Stepper& stepper);
+		// Calls function(startIndex, endIndex) for the organisms that need to be stepped this episode, split between threads if episodes are threaded
+		template<typename RangeFunction>
+		void RunEpisodeRanges(RangeFunction&& function);
+		// Creates a child in the place of a loser for steady state evolution (only call with the steady state lock held)
+		// busy: whether each organism is being evaluated by a thread. organisms that are busy are not used and the loser is set as busy
+		// Returns the index of the child
+		uint32_t CreateSteadyStateChild(uint8_t* busy);
+		// Returns a random organism that isn't busy
+		uint32_t RandomIdleOrganism(const uint8_t* busy);
+		// Mutates a single child based on the mutation type
+		void MutateChild(NetworkOrganism& child);
+		// Returns the index of the first organism that needs to be stepped this episode
+		uint32_t GetEpisodeStartIndex() const;
+		// Steps every organism in the range until its episode is over (once per replica)
+		template<typename Stepper>
+		void RunEpisodeRange(Stepper& stepper, uint32_t startIndex, uint32_t endIndex);
+		// Steps an organism until its episode is over
+		template<typename Stepper>
+		void RunOrganismEpisode(Stepper& stepper, uint32_t organismIndex NLV_STATS_ONLY(, EvolverEpisodeCounters& counters));
+		// Combines the fitness values of every replica of an organism into one (may reorder the array)
+		float ReduceReplicaFitness(float* replicaFitness) const;
+		// Steps every organism in the range in lockstep
+		// stepRange: called with (startIndex, endIndex) once every step
+		template<typename StepRange>
+		void RunEpisodeBatched(StepRange& stepRange, uint32_t startIndex, uint32_t endIndex);
+		// Quantizes or packs the networks of organisms in [startIndex, endIndex) if quantized or packed inference is on (genes change every generation, so this is done before every episode)
+		inline void PrepareInferenceRange(uint32_t startIndex, uint32_t endIndex)
+		{
+			if (quantizedInference)
+			{
+				for (uint32_t i = startIndex; i < endIndex; i++)
+					organisms[i].network.Quantize();
+			}
+			else if (packedInference)
+			{
+				for (uint32_t i = startIndex; i < endIndex; i++)
+					organisms[i].network.Pack();
+			}
+		}
+		// Picks the next population size with the adaptive population policy (called after every generation)
+		void AdaptPopulationSize();
+		// Points every organism's network at its part of hiddenStates (has to be done whenever the organism array is replaced)
+		void BindHiddenStates();
+		// Resets the hidden state of recurrent networks of organisms in [startIndex, endIndex) (done at the start of every episode)
+		inline void ResetHiddenStates(uint32_t startIndex, uint32_t endIndex)
+		{
+			if (!hiddenStates.empty())
+				std::fill(hiddenStates.begin() + (size_t)startIndex * stateCount, hiddenStates.begin() + (size_t)endIndex * stateCount, 0.0f);
+		}
+		// Evaluates the organism's network with its inputs, quantized, packed or neither
+		inline void EvaluateOrganism(NetworkOrganism& organism)
+		{
+			if (quantizedInference)
+				organism.network.EvaluateQuantized(organism.networkInputs, neuralInputSize);
+			else if (packedInference)
+				organism.network.EvaluatePacked(organism.networkInputs, neuralInputSize);
+			else
+				organism.network.Evaluate(organism.networkInputs, neuralInputSize);
+		}
+		// Runs an episode through the shared memory bridge
+		void RunEpisodeBridged();
+		// Adds the genes of organisms in [startIndex, endIndex) to sums (geneCount sums of genes followed by geneCount sums of squared genes)
+		void AccumulateGeneStats(uint32_t startIndex, uint32_t endIndex, double* sums) const;
+		// Summarizes the population into the stats history after an episode (does nothing if the history length is 0)
+		void UpdatePopulationStats();
+		// Copies the fitness of the population and the genes of the best organisms into a new snapshot and publishes it
+		void PublishSnapshot();
+		// Resets progress for an episode that evaluates total organism episodes
+		void StartProgress(uint32_t total);
+		// Adds organism episodes that finished on the calling thread to the progress
+		inline void AddProgress(uint32_t count)
+		{
+			progressCounters[episodeThread % PROGRESS_SLOTS].finished.fetch_add(count, std::memory_order_relaxed);
+		}
+		// Sets the index of the calling thread (0 is the thread running the evolver, episode threads start at 1)
+		static inline void SetEpisodeThread(uint32_t index)
+		{
+			episodeThread = index;
+			EvolverTrace::SetLane(index);
+		}
+#ifdef NLV_STATS
+		// Adds the counters of a range of organisms to stats (locked, since ranges finish on different threads)
+		void AddEpisodeCounters(const EvolverEpisodeCounters& counters);
+#endif
 
 		//called by save and load functions to save and load into either string or file streams
 		bool Save(std::ostream& stream) const;
@@ -115,6 +328,17 @@ namespace nlv
 		bool Load(std::istream& stream);
 
 		void Uninitialize();
+		// Destroys and frees an organism array and sets it to nullptr
+		void FreeOrganisms(NetworkOrganism*& array);
+
+		//migration (used by NetworkIslandEvolver)
+		// Copies the genes and fitness of the best organisms (highest fitness first)
+		// genes: needs space for count * gene count values
+		// masks: nullptr, or space for count * gene count connection mask bytes (every connection is enabled for organisms without a mask)
+		void GetMigrants(uint32_t count, float* genes, float* fitnesses, uint8_t* masks = nullptr) const;
+		// Replaces the worst organisms with migrants
+		// masks: nullptr, or the migrants' connection masks (only used if organisms have connection masks)
+		void ReceiveMigrants(uint32_t count, const float* genes, const float* fitnesses, const uint8_t* masks = nullptr);
 
 		struct EvolverRandom {
 			//note: mersenne twister is slow
@@ -136,6 +360,12 @@ namespace nlv
 		// Called for each organism for every step. Allows the user to modify values used for the organism's next step
 		// Inside this callback no values accessed by other organisms should be modified.
 		EvolverStepCallback stepCallback = nullptr;
+		// Called once per step for a range of organisms instead of stepCallback if it is set. 
+		EvolverBatchStepCallback batchStepCallback = nullptr;
+		// Called before every replica of an organism's episode if replicaCount is more than 1
+		EvolverReplicaCallback replicaCallback = nullptr;
+		// Called before a child is evaluated during steady state evolution
+		EvolverOrganismCallback birthCallback = nullptr;
 		//Called once at the start of a generation. Allows the user to setup initial input values for the organism, as well as any variables used on the users side.
 		//Neither this or endCallback need to be set.
 		EvolverGenerationCallback startCallback = nullptr;
@@ -147,10 +377,36 @@ namespace nlv
 		EvolverCustomMutationCallback mutationCallback = nullptr;
 		//User pointer, pointing to whatever they want it to point to
 		void* userPointer = nullptr;
+		//if set, organisms are evaluated in worker processes instead of through the step callbacks
+		NetworkRemoteEvaluator* remoteEvaluator = nullptr;
+		//if set, organisms are stepped by a simulator in another process instead of through the step callbacks
+		NetworkSharedMemoryBridge* sharedMemoryBridge = nullptr;
+		//if set, generations are recorded into it
+		EvolverTrace* trace = nullptr;
 		// the organisms in the current generation. Not accessible outside of the evolver.
 		NetworkOrganism* organisms = nullptr;
+		// the organisms of the generation before the current one. the next generation is made in them so networks aren't reallocated every generation
+		// (nullptr until the first new generation is made)
+		NetworkOrganism* spareOrganisms = nullptr;
 		// The number of organisms in a given generation
 		uint32_t populationSize = 0;
+		// The number of organisms the next generation is made with
+		uint32_t nextPopulationSize = 0;
+		// The number of elite the current generation kept from the last one
+		uint32_t eliteCount = 0;
+		//automatic population sizing (off while maxSize is 0), see SetAdaptivePopulation
+		struct AdaptivePopulation
+		{
+			uint32_t minSize = 0;
+			uint32_t maxSize = 0;
+			uint32_t patience = 0;
+			float shrinkFactor = 1;
+			float growFactor = 1;
+			//the highest best fitness since the policy started, and the number of generations since it went up
+			bool hasBestFitness = false;
+			float bestFitness = 0;
+			uint32_t stagnantGenerations = 0;
+		} adaptivePopulation;
 		// The size of the neural networks' input and output arrays
 		uint32_t neuralInputSize = 0, neuralOutputSize = 0;
 		// The percentage chance that a gene is mutated
@@ -169,14 +425,76 @@ namespace nlv
 		EvolverCrossoverType crossoverType = EvolverCrossoverType::Arithmetic;
 		//The type of selection used
 		EvolverSelectionType selectionType = EvolverSelectionType::FitnessProportional;
+		//How the organism replaced by a child is chosen in steady state evolution
+		EvolverReplacementType replacementType = EvolverReplacementType::Worst;
+		//The algorithm used to create new generations
+		EvolverOptimizerType optimizerType = EvolverOptimizerType::Genetic;
+		//Used instead of selection, crossover and mutation if optimizerType isn't Genetic
+		EvolutionStrategy strategy;
+		//The number of children evaluated in steady state evolution
+		uint64_t steadyStateEvaluations = 0;
 		//Whether stepping through organisms is threaded or not
 		bool threadedStepping = false;
 		//Whether every episode is the same as the last
 		bool staticEpisodes = false;
+		//Whether networks are quantized to int8 before episodes and evaluated with EvaluateQuantized
+		bool quantizedInference = false;
+		//Whether networks are packed before episodes and evaluated with EvaluatePacked
+		bool packedInference = false;
+		//How the genes of every organism are stored
+		GenePrecision genePrecision = GenePrecision::Float32;
+		//Whether organisms share unchanged genes with their parents (see Network::SetSharedGenes)
+		bool sharedGenes = false;
+		//The hidden state of every organism's recurrent layers, stateCount floats for each organism one after another
+		//(so it can be reset for a whole range of organisms at once)
+		std::vector<float> hiddenStates;
+		uint32_t stateCount = 0;
+		//Whether organisms have connection masks that are evolved with their genes
+		bool connectionMasks = false;
+		//The percentage chance a connection of a child is toggled (checked repeatedly)
+		float connectionToggleRate = 0.0f;
+		//Population stats of the last generations, a ring buffer starting at populationStatsStart (empty if they aren't collected)
+		std::vector<EvolverPopulationStats> populationStatsHistory;
+		uint32_t populationStatsStart = 0;
+		uint32_t populationStatsCount = 0;
+		std::vector<float> geneMeans;
+		std::vector<float> geneVariances;
+		//gene sums for each episode thread, see AccumulateGeneStats
+		std::vector<double> geneSums;
+		//whether the episode threads already filled geneSums this episode
+		bool geneSumsReady = false;
+		//Organism episodes finished this episode, one counter per thread (on its own cache line) so threads don't fight over it
+		//readers add them up, see GetProgress
+		static constexpr uint32_t PROGRESS_SLOTS = 16;
+		struct alignas(64) ProgressCounter
+		{
+			std::atomic<uint32_t> finished = 0;
+		};
+		ProgressCounter progressCounters[PROGRESS_SLOTS];
+		std::atomic<uint32_t> progressTotal = 0;
+		//the index of the calling thread, see SetEpisodeThread
+		static thread_local uint32_t episodeThread;
+		//The last published snapshot, and the one before it which is reused for the next snapshot if no reader still holds it
+		std::atomic<std::shared_ptr<const EvolverSnapshot>> snapshot;
+		std::shared_ptr<EvolverSnapshot> spareSnapshot;
+		uint32_t snapshotGenomeCount = 1;
+		//Timings of the last generation, only written if NLV_STATS is defined
+		EvolverStats stats;
+#ifdef NLV_STATS
+		std::mutex statsMutex;
+#endif
+		//float copies of the genes of a child and its parents, used by crossover and custom mutation when genes are stored in 16 bits
+		std::vector<float> widenedGenes;
 		//The number of threads created
 		uint32_t episodeThreadCount = 0;
 		//the size of the tournament if using tournament selection
 		uint32_t tournamentSize = 0;
+		//the number of episodes each organism is evaluated over every generation
+		uint32_t replicaCount = 1;
+		//how the fitness values of the replicas are combined
+		EvolverFitnessReduction fitnessReduction = EvolverFitnessReduction::Mean;
+		//the percentile used for EvolverFitnessReduction::Percentile
+		float fitnessPercentile = 0.5f;
 
 		//if the evolver is initiated or not. if it has been destroyed or was not constructed correctly this may evaluate to false
 		bool initialized = false;
@@ -184,5 +502,372 @@ namespace nlv
 		//for if static episodes is set to true after multiple generations have been run, to prevent issues
 		bool activateStaticEpisodes = false;
 	};
+
+	template<typename Stepper>
+	void NetworkEvolver::EvaluateGeneration(Stepper&& stepper)
+	{
+		if (!initialized)
+			throw std::runtime_error("NetworkEvolver was not initiated correctly");
+
+		RunGeneration([&]() { RunEpisode(stepper); });
+	}
+
+	template<typename Stepper>
+	void NetworkEvolver::EvaluateGenerations(uint32_t count, Stepper&& stepper)
+	{
+		if (!initialized)
+			throw std::runtime_error("NetworkEvolver was not initiated correctly");
+		if (count == 0)
+			throw std::runtime_error("Count cannot be 0");
+
+		for (size_t i = 0; i < count; i++)
+			RunGeneration([&]() { RunEpisode(stepper); });
+	}
+
+	template<typename EpisodeFunction>
+	void NetworkEvolver::RunGeneration(EpisodeFunction&& runEpisode)
+	{
+		EvolverTrace::Scope scope(trace, "Generation");
+		CreateNewGen();
+		//the start callback gets the new generation (it can be a different size to the last one)
+		if (startCallback)
+		{
+			EvolverTrace::Scope callbackScope(trace, "Start callback");
+			startCallback(*this, organisms);
+		}
+		runEpisode();
+		UpdatePopulationStats();
+		AdaptPopulationSize();
+		PublishSnapshot();
+		if (endCallback)
+		{
+			EvolverTrace::Scope callbackScope(trace, "End callback");
+			endCallback(*this, organisms);
+		}
+		currentGeneration++;
+	}
+
+	template<typename Stepper>
+	void NetworkEvolver::EvaluateSteadyState(uint32_t evaluationCount, Stepper&& stepper)
+	{
+		if (!initialized)
+			throw std::runtime_error("NetworkEvolver was not initiated correctly");
+		if (evaluationCount == 0)
+			throw std::runtime_error("Count cannot be 0");
+		if (birthCallback == nullptr)
+			throw std::runtime_error("Birth callback cannot be nullptr when using steady state evolution");
+		if (optimizerType != EvolverOptimizerType::Genetic)
+			throw std::runtime_error("Steady state evolution can only be used with the genetic optimizer");
+		uint32_t threadCount = threadedStepping ? episodeThreadCount : 1;
+		//every thread needs a loser and two parents that aren't being evaluated
+		if (populationSize < threadCount + 2)
+			throw std::runtime_error("Population size is too small for steady state evolution with this many threads");
+
+		NLV_STATS_ONLY(stats = EvolverStats());
+		//children are made from an evaluated population
+		if (currentGeneration == 0)
+		{
+			EvolverTrace::Scope scope(trace, "Generation");
+			if (startCallback)
+			{
+				EvolverTrace::Scope callbackScope(trace, "Start callback");
+				startCallback(*this, organisms);
+			}
+			RunEpisode(stepper);
+			UpdatePopulationStats();
+			PublishSnapshot();
+			if (endCallback)
+			{
+				EvolverTrace::Scope callbackScope(trace, "End callback");
+				endCallback(*this, organisms);
+			}
+			currentGeneration++;
+		}
+
+		std::vector<uint8_t> busy(populationSize, false);
+		std::mutex mutex;
+		uint32_t started = 0;
+		uint64_t finished = 0;
+#ifdef NLV_STATS
+		//(the first population's stats are kept, apart from the threads which are replaced)
+		stats.threads.assign(threadCount, EvolverThreadStats());
+		uint64_t episodeStart = timing::Now();
+#endif
+		//only creating a child and returning it to the population is locked, the episode itself isn't
+		if (trace)
+			trace->PrepareLanes(threadCount);
+		StartProgress(evaluationCount * replicaCount);
+		EvolverTrace::Scope scope(trace, "Steady state");
+		auto work = [&](uint32_t thread)
+		{
+			SetEpisodeThread(thread + 1);
+			//time spent waiting for the lock is idle, everything else is busy
+			NLV_STATS_ONLY(uint64_t workStart = timing::Now());
+			NLV_STATS_ONLY(uint64_t idle = 0);
+			while (true)
+			{
+				uint32_t index;
+				{
+					NLV_STATS_ONLY(uint64_t waitStart = timing::Now());
+					std::lock_guard<std::mutex> lock(mutex);
+					NLV_STATS_ONLY(idle += timing::Now() - waitStart);
+					if (started == evaluationCount)
+						break;
+					started++;
+					EvolverTrace::Scope childScope(trace, "Create child");
+					index = CreateSteadyStateChild(busy.data());
+				}
+
+				NetworkOrganism& child = organisms[index];
+				child.Reset();
+				{
+					EvolverTrace::Scope callbackScope(trace, "Birth callback", index, index + 1);
+					birthCallback(*this, child, index);
+				}
+				RunEpisodeRange(stepper, index, index + 1);
+				NLV_STATS_ONLY(stats.threads[thread].organisms++);
+
+				NLV_STATS_ONLY(uint64_t waitStart = timing::Now());
+				std::lock_guard<std::mutex> lock(mutex);
+				NLV_STATS_ONLY(idle += timing::Now() - waitStart);
+				busy[index] = false;
+				finished++;
+			}
+#ifdef NLV_STATS
+			stats.threads[thread].idleNanoseconds = idle;
+			stats.threads[thread].busyNanoseconds = timing::Now() - workStart - idle;
+#endif
+			SetEpisodeThread(0);
+		};
+
+		if (threadCount > 1)
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(threadCount);
+			for (uint32_t t = 0; t < threadCount; t++)
+				threads.emplace_back(work, t);
+			for (auto& thread : threads)
+				thread.join();
+		}
+		else
+			work(0);
+		NLV_STATS_ONLY(stats.episodeNanoseconds += timing::Now() - episodeStart);
+
+		//generations are only counted once every thread has stopped, so GetGeneration() doesn't change during an episode
+		uint64_t previousEvaluations = steadyStateEvaluations;
+		steadyStateEvaluations += finished;
+		currentGeneration += (uint32_t)(steadyStateEvaluations / populationSize - previousEvaluations / populationSize);
+		UpdatePopulationStats();
+		PublishSnapshot();
+	}
+
+	template<typename Stepper>
+	void NetworkEvolver::RunEpisode(Stepper& stepper)
+	{
+		RunEpisodeRanges([this, &stepper](uint32_t startIndex, uint32_t endIndex) { RunEpisodeRange(stepper, startIndex, endIndex); });
+	}
+
+	template<typename RangeFunction>
+	void NetworkEvolver::RunEpisodeRanges(RangeFunction&& function)
+	{
+		uint32_t eliteTranslation = GetEpisodeStartIndex();
+		EvolverTrace::Scope scope(trace, "Episode", eliteTranslation, populationSize);
+		StartProgress((populationSize - eliteTranslation) * replicaCount);
+#ifdef NLV_STATS
+		uint64_t episodeStart = timing::Now();
+		stats.organismsSkipped = eliteTranslation;
+		stats.threads.assign(threadedStepping ? episodeThreadCount : 1, EvolverThreadStats());
+#endif
+
+		//if threaded stepping is enabled, the system creates episodeThreadCount threads and uses them to step through the organism
+		if (threadedStepping)
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(episodeThreadCount);
+			if (trace)
+				trace->PrepareLanes(episodeThreadCount);
+			//genes don't change during an episode, so the threads also sum them for the population stats once their organisms are done
+			//(over an even split of the whole population, which includes the elite that weren't stepped)
+			uint32_t geneCount = GetGeneCount();
+			bool sumGenes = !populationStatsHistory.empty();
+			if (sumGenes)
+				geneSums.assign((size_t)episodeThreadCount * geneCount * 2, 0.0);
+
+			uint32_t perThreadAmount = (populationSize - eliteTranslation) / episodeThreadCount;
+			uint32_t extraIndex = episodeThreadCount - ((populationSize - eliteTranslation) % episodeThreadCount);
+			uint32_t startIndex = eliteTranslation;
+			for (uint32_t t = 0; t < episodeThreadCount; t++)
+			{
+				//if thread index is more than extraIndex, the thread needs to take care of one more organism
+				uint32_t endIndex = startIndex + perThreadAmount + (uint32_t)(t >= extraIndex);
+				//just runs the same function as non threaded in parallel 
+				//i know for a fact this is not a good way to do threading but I can't find a good example to base my implimentation off of
+				//its not like I can keep this thread alive over generations, I have no way to know when the user will call EvaluateGeneration()
+				threads.emplace_back([this, &function, startIndex, endIndex, t, geneCount, sumGenes]()
+					{
+						NLV_STATS_ONLY(uint64_t threadStart = timing::Now());
+						SetEpisodeThread(t + 1);
+						{
+							EvolverTrace::Scope rangeScope(trace, "Range", startIndex, endIndex);
+							function(startIndex, endIndex);
+						}
+						if (sumGenes)
+						{
+							EvolverTrace::Scope sumScope(trace, "Gene stats");
+							AccumulateGeneStats((uint64_t)populationSize * t / episodeThreadCount, (uint64_t)populationSize * (t + 1) / episodeThreadCount, geneSums.data() + (size_t)t * geneCount * 2);
+						}
+						NLV_STATS_ONLY(stats.threads[t].busyNanoseconds = timing::Now() - threadStart);
+						NLV_STATS_ONLY(stats.threads[t].organisms = endIndex - startIndex);
+					});
+				startIndex = endIndex;
+			}
+
+			//rejoin threads
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+			geneSumsReady = sumGenes;
+		}
+		else
+		{
+			//loop through all organisms and step through them (same as a single thread would)
+			function(eliteTranslation, populationSize);
+			NLV_STATS_ONLY(stats.threads[0].busyNanoseconds = timing::Now() - episodeStart);
+			NLV_STATS_ONLY(stats.threads[0].organisms = populationSize - eliteTranslation);
+		}
+#ifdef NLV_STATS
+		uint64_t episodeTime = timing::Now() - episodeStart;
+		stats.episodeNanoseconds += episodeTime;
+		//threads that finished early waited for the slowest one
+		for (auto& thread : stats.threads)
+			thread.idleNanoseconds = episodeTime - std::min(thread.busyNanoseconds, episodeTime);
+#endif
+
+		if (activateStaticEpisodes)
+			staticEpisodes = true;
+	}
+
+	template<typename StepRange>
+	void NetworkEvolver::RunEpisodeBatched(StepRange& stepRange, uint32_t startIndex, uint32_t endIndex)
+	{
+		//which organisms were stepping at the start of the current step
+		//(the callback sets continueStepping to false, but the step it stopped on is still counted like in the regular loop)
+		std::vector<uint8_t> stepping(endIndex - startIndex);
+		PrepareInferenceRange(startIndex, endIndex);
+		ResetHiddenStates(startIndex, endIndex);
+#ifdef NLV_STATS
+		EvolverEpisodeCounters counters;
+		counters.organisms = endIndex - startIndex;
+		uint64_t phaseStart = timing::Now();
+#endif
+
+		//organisms that finished their episode and were added to the progress
+		uint32_t finished = 0;
+		for (uint32_t step = 0; step < maxSteps; step++)
+		{
+			uint32_t steppingCount = 0;
+			for (uint32_t i = startIndex; i < endIndex; i++)
+			{
+				NetworkOrganism& organism = organisms[i];
+				stepping[i - startIndex] = organism.steps < maxSteps && organism.continueStepping;
+				//evaluate organism brain
+				if (stepping[i - startIndex])
+				{
+					EvaluateOrganism(organism);
+					NLV_STATS_ONLY(counters.forwardPasses++);
+					steppingCount++;
+				}
+			}
+			AddProgress(endIndex - startIndex - steppingCount - finished);
+			finished = endIndex - startIndex - steppingCount;
+			bool anyStepping = steppingCount > 0;
+			NLV_STATS_ONLY(counters.forwardPassNanoseconds += timing::Lap(phaseStart));
+			//every organism has finished its episode
+			if (!anyStepping)
+				break;
+
+			//step every organism at once
+			{
+				EvolverTrace::Scope stepScope(trace, "Batch step callback", startIndex, endIndex);
+				stepRange(startIndex, endIndex);
+			}
+			NLV_STATS_ONLY(counters.stepNanoseconds += timing::Lap(phaseStart));
+
+			for (uint32_t i = startIndex; i < endIndex; i++)
+			{
+				if (stepping[i - startIndex])
+					organisms[i].steps++;
+			}
+		}
+		//organisms still stepping when maxSteps was reached
+		AddProgress(endIndex - startIndex - finished);
+		//(every organism that was evaluated also took a step)
+		NLV_STATS_ONLY(counters.steps = counters.forwardPasses);
+		NLV_STATS_ONLY(AddEpisodeCounters(counters));
+	}
+
+	template<typename Stepper>
+	void NetworkEvolver::RunEpisodeRange(Stepper& stepper, uint32_t startIndex, uint32_t endIndex)
+	{
+		PrepareInferenceRange(startIndex, endIndex);
+		ResetHiddenStates(startIndex, endIndex);
+#ifdef NLV_STATS
+		EvolverEpisodeCounters counters;
+		counters.organisms = endIndex - startIndex;
+#endif
+		if (replicaCount <= 1)
+		{
+			for (uint32_t i = startIndex; i < endIndex; i++)
+				RunOrganismEpisode(stepper, i NLV_STATS_ONLY(, counters));
+			NLV_STATS_ONLY(AddEpisodeCounters(counters));
+			return;
+		}
+
+		//every organism runs an episode per replica (on the same thread, so they can share the organism's network and inputs)
+		//its fitness is then the combination of every replica's fitness, and its step count is the average
+		std::vector<float> replicaFitness(replicaCount);
+		for (uint32_t i = startIndex; i < endIndex; i++)
+		{
+			NetworkOrganism& organism = organisms[i];
+			uint64_t totalSteps = 0;
+			for (uint32_t r = 0; r < replicaCount; r++)
+			{
+				organism.Reset();
+				organism.network.ResetState();
+				{
+					EvolverTrace::Scope callbackScope(trace, "Replica callback", i, i + 1);
+					replicaCallback(*this, organism, i, r);
+				}
+				RunOrganismEpisode(stepper, i NLV_STATS_ONLY(, counters));
+				replicaFitness[r] = organism.fitness;
+				totalSteps += organism.steps;
+			}
+			organism.fitness = ReduceReplicaFitness(replicaFitness.data());
+			organism.steps = (uint32_t)(totalSteps / replicaCount);
+		}
+		NLV_STATS_ONLY(AddEpisodeCounters(counters));
+	}
+
+	template<typename Stepper>
+	inline void NetworkEvolver::RunOrganismEpisode(Stepper& stepper, uint32_t organismIndex NLV_STATS_ONLY(, EvolverEpisodeCounters& counters))
+	{
+		NetworkOrganism& organism = organisms[organismIndex];
+		EvolverTrace::Scope scope(trace, "Organism", organismIndex, organismIndex + 1);
+		NLV_STATS_ONLY(uint64_t phaseStart = timing::Now());
+		//an organism stops stepping if continuestepping evaluates to false or if the step count reaches maxSteps
+		for (; organism.steps < maxSteps && organism.continueStepping; organism.steps++)
+		{
+			//evaluate organism brain
+			EvaluateOrganism(organism);
+			NLV_STATS_ONLY(counters.forwardPassNanoseconds += timing::Lap(phaseStart));
+			//step the organism
+			stepper(organism, organismIndex);
+			NLV_STATS_ONLY(counters.stepNanoseconds += timing::Lap(phaseStart));
+			NLV_STATS_ONLY(counters.forwardPasses++);
+			NLV_STATS_ONLY(counters.steps++);
+		}
+		AddProgress(1);
+	}
 }
 
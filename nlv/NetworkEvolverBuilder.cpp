@@ -14,6 +14,36 @@ namespace nlv
 		return *this;
 	}
 
+	NetworkEvolverBuilder& NetworkEvolverBuilder::SetBatchStepCallback(EvolverBatchStepCallback batchStepFunction)
+	{
+		this->batchStepFunction = batchStepFunction;
+		return *this;
+	}
+
+	NetworkEvolverBuilder& NetworkEvolverBuilder::SetReplicas(uint32_t replicaCount, EvolverReplicaCallback replicaFunction, EvolverFitnessReduction reduction, float percentile)
+	{
+		this->replicaCount = std::max(replicaCount, 1U);
+		this->replicaFunction = replicaFunction;
+		fitnessReduction = reduction;
+		fitnessPercentile = std::clamp(percentile, 0.0f, 1.0f);
+		return *this;
+	}
+
+	NetworkEvolverBuilder& NetworkEvolverBuilder::SetSteadyState(EvolverOrganismCallback birthFunction, EvolverReplacementType replacement)
+	{
+		this->birthFunction = birthFunction;
+		replacementType = replacement;
+		return *this;
+	}
+
+	NetworkEvolverBuilder& NetworkEvolverBuilder::SetEvolutionStrategy(EvolverOptimizerType type, float sigma, float learningRate)
+	{
+		optimizerType = type;
+		strategySigma = sigma;
+		strategyLearningRate = learningRate;
+		return *this;
+	}
+
 	NetworkEvolverBuilder& NetworkEvolverBuilder::SetElitePercent(float elitePercent)
 	{
 		this->elitePercent = std::clamp(elitePercent, 0.0f, 1.0f);
@@ -28,6 +58,55 @@ namespace nlv
 		return *this;
 	}
 
+	NetworkEvolverBuilder& NetworkEvolverBuilder::SetGenePrecision(GenePrecision precision)
+	{
+		genePrecision = precision;
+		return *this;
+	}
+
+	NetworkEvolverBuilder& NetworkEvolverBuilder::SetSharedGenes(bool shared)
+	{
+		sharedGenes = shared;
+		return *this;
+	}
+
+	NetworkEvolverBuilder& NetworkEvolverBuilder::SetConnectionMask(float toggleRate, float initialDensity, float sparseThreshold)
+	{
+		connectionMask = true;
+		connectionToggleRate = std::clamp(toggleRate, 0.0f, 1.0f);
+		initialConnectionDensity = std::clamp(initialDensity, 0.0f, 1.0f);
+		this->sparseThreshold = sparseThreshold;
+		return *this;
+	}
+
+	NetworkEvolverBuilder& NetworkEvolverBuilder::SetQuantizedInference(bool quantized)
+	{
+		quantizedInference = quantized;
+		return *this;
+	}
+
+	NetworkEvolverBuilder& NetworkEvolverBuilder::SetPackedInference(bool packed)
+	{
+		packedInference = packed;
+		return *this;
+	}
+
+	NetworkEvolverBuilder& NetworkEvolverBuilder::SetPopulationStats(uint32_t historyLength)
+	{
+		populationStatsHistory = historyLength;
+		return *this;
+	}
+
+	NetworkEvolverBuilder& NetworkEvolverBuilder::SetAdaptivePopulation(uint32_t minSize, uint32_t maxSize, uint32_t patience, float shrinkFactor, float growFactor)
+	{
+		adaptiveMinPopulation = minSize;
+		adaptiveMaxPopulation = maxSize;
+		adaptivePatience = patience;
+		adaptiveShrinkFactor = shrinkFactor;
+		adaptiveGrowFactor = growFactor;
+		return *this;
+	}
+
 	NetworkEvolverBuilder& NetworkEvolverBuilder::SetMutation(EvolverMutationType type, float mutationRate, float mutationScale)
 	{
 		mutationType = type;
@@ -10,7 +10,7 @@ namespace nlv
 	{
 		friend NetworkEvolver;
 		// networkTemplate: A network that is used as a template for the networks in the evolver
-		// stepFunction: The step function used in the evolver
+		// stepFunction: The step function used in the evolver (can be nullptr if a batch step function is set, or if organisms are only stepped through EvaluateGeneration(stepper))
 		// population: The number of individuals in the population
 		// maxSteps: The maximum number of steps in an episode per individual
 		// seed: The seed for the initial values of the networks. Setting this to zero automatically assigns a random seed
@@ -18,12 +18,48 @@ namespace nlv
 		// startFunction: A callback called before running each episode
 		// endFunction: A callback called after running each episode
 		NetworkEvolverBuilder& SetCallbacks(EvolverGenerationCallback startFunction, EvolverGenerationCallback endFunction);
+		// batchStepFunction: A callback that steps a range of organisms at once. When set it is used instead of the step function
+		NetworkEvolverBuilder& SetBatchStepCallback(EvolverBatchStepCallback batchStepFunction);
+		// replicaCount: The number of episodes (replicas) every organism is evaluated over each generation
+		// replicaFunction: A callback called before every replica of an organism, used to set up the environment for that replica
+		// reduction: How the fitness values of the replicas are combined
+		// percentile: The percentile used when reduction is EvolverFitnessReduction::Percentile
+		NetworkEvolverBuilder& SetReplicas(uint32_t replicaCount, EvolverReplicaCallback replicaFunction, EvolverFitnessReduction reduction = EvolverFitnessReduction::Mean, float percentile = 0.5f);
+		// Sets parameters used by NetworkEvolver::EvaluateSteadyState
+		// birthFunction: A callback called before every new child is evaluated, used to reset its environment
+		// replacement: How the organism replaced by a new child is chosen
+		NetworkEvolverBuilder& SetSteadyState(EvolverOrganismCallback birthFunction, EvolverReplacementType replacement = EvolverReplacementType::Worst);
+		// Uses an evolution strategy instead of selection, crossover and mutation (elitism and the GA settings are ignored)
+		// type: The optimizer used to create new generations
+		// sigma: The starting standard deviation of the perturbations
+		// learningRate: How far the mean moves every generation (only used by EvolverOptimizerType::NaturalEvolutionStrategy)
+		NetworkEvolverBuilder& SetEvolutionStrategy(EvolverOptimizerType type, float sigma = 0.05f, float learningRate = 0.05f);
 		// elitePercent: The percentage of individuals that are retained every generation
 		NetworkEvolverBuilder& SetElitePercent(float elitePercent);
 		// staticEpisodes: Whether the parameters for each episode change or not
 		// threadedEpisodes: Whether running episodes is threaded or not
 		// threadCount: The number of threads used when running episodes
 		NetworkEvolverBuilder& SetEpisodeParameters(bool staticEpisodes, bool threadedEpisodes, uint32_t threadCount = 5);
+		// precision: How the genes of every organism are stored. 16 bit genes halve the memory used by the population (see GenePrecision)
+		NetworkEvolverBuilder& SetGenePrecision(GenePrecision precision);
+		// shared: Whether children share the genes they get from their parents in copy on write pages, so only the pages crossover and mutation change are copied
+		// (see Network::SetSharedGenes). Only works with 32 bit genes
+		NetworkEvolverBuilder& SetSharedGenes(bool shared);
+		// Gives every organism a connection mask that is evolved alongside its genes (see Network::EnableConnectionMask)
+		// toggleRate: The percentage chance a connection of a child is enabled or disabled (checked repeatedly like the mutation rate)
+		// initialDensity: The percentage of connections that are enabled in the first generation
+		// sparseThreshold: The density under which networks are evaluated sparsely
+		NetworkEvolverBuilder& SetConnectionMask(float toggleRate, float initialDensity = 1.0f, float sparseThreshold = 0.5f);
+		// quantized: Whether organisms are evaluated with int8 weights during episodes (see Network::Quantize). Evolution still uses the float genes
+		NetworkEvolverBuilder& SetQuantizedInference(bool quantized);
+		// packed: Whether organisms are evaluated with packed weights during episodes (see Network::Pack). Quantized inference is used instead if both are on
+		NetworkEvolverBuilder& SetPackedInference(bool packed);
+		// historyLength: The number of generations population stats (fitness quantiles, gene diversity etc.) are kept for. 0 doesn't collect them
+		NetworkEvolverBuilder& SetPopulationStats(uint32_t historyLength);
+		// Changes the population size after every generation, shrinking it while fitness improves and growing it when it stagnates (see NetworkEvolver::SetAdaptivePopulation)
+		// minSize, maxSize: The smallest and largest the population can get
+		// patience: The number of generations without a new best fitness before the population grows
+		NetworkEvolverBuilder& SetAdaptivePopulation(uint32_t minSize, uint32_t maxSize, uint32_t patience = 5, float shrinkFactor = 0.9f, float growFactor = 1.5f);
 		// type: The type of mutation
 		// mutationRate: The percentage chance a individual is mutated every generation
 		// mutationScale: The scale of mutation when using EvolverMutationType::Add
@@ -52,6 +88,9 @@ namespace nlv
 	private:
 		Network& networkTemplate;
 		EvolverStepCallback stepFunction;
+		EvolverBatchStepCallback batchStepFunction = nullptr;
+		EvolverReplicaCallback replicaFunction = nullptr;
+		EvolverOrganismCallback birthFunction = nullptr; //for steady state evolution
 		EvolverGenerationCallback startFunction = nullptr;
 		EvolverGenerationCallback endFunction = nullptr;
 		EvolverCustomSelectionCallback selectionCallback = nullptr; //for selectiontype::custom
@@ -66,9 +105,30 @@ namespace nlv
 		float mutationScale = 1.0f; //for mutationtype::add
 		uint32_t episodeThreadCount = 0; //for threadedEpisodes == true
 		uint32_t tournamentSize = 5; //for selectiontype::tournament
+		uint32_t replicaCount = 1;
+		float fitnessPercentile = 0.5f; //for fitnessreduction::percentile
+		EvolverFitnessReduction fitnessReduction = EvolverFitnessReduction::Mean;
+		EvolverReplacementType replacementType = EvolverReplacementType::Worst; //for steady state evolution
+		EvolverOptimizerType optimizerType = EvolverOptimizerType::Genetic;
+		float strategySigma = 0.05f; //for evolution strategies
+		float strategyLearningRate = 0.05f; //for optimizertype::naturalevolutionstrategy
 		EvolverMutationType mutationType = EvolverMutationType::Set;
 		EvolverCrossoverType crossoverType = EvolverCrossoverType::Uniform;
 		EvolverSelectionType selectionType = EvolverSelectionType::Ranked;
+		bool quantizedInference = false;
+		bool packedInference = false;
+		uint32_t populationStatsHistory = 0;
+		uint32_t adaptiveMinPopulation = 0; //for adaptive population sizing (off while adaptiveMaxPopulation is 0)
+		uint32_t adaptiveMaxPopulation = 0;
+		uint32_t adaptivePatience = 5;
+		float adaptiveShrinkFactor = 0.9f;
+		float adaptiveGrowFactor = 1.5f;
+		GenePrecision genePrecision = GenePrecision::Float32;
+		bool sharedGenes = false;
+		bool connectionMask = false; //for connection masks
+		float connectionToggleRate = 0.0f;
+		float initialConnectionDensity = 1.0f;
+		float sparseThreshold = 0.5f;
 		bool threadedEpisodes = false;
 		bool staticEpisodes = false;
 	};
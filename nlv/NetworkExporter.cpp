@@ -0,0 +1,230 @@
+#include "NetworkExporter.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <cctype>
+#include <cmath>
+
+namespace nlv
+{
+	//the part of every header that doesn't depend on the network
+	//every loop has a constant length, so compilers can unroll and vectorize them (the inner loops go over neurons, so sums don't have to be reordered)
+	static const char* HEADER_FUNCTIONS =
+		"\tnamespace detail\n"
+		"\t{\n"
+		"\t\tinline float Activate(float weightedInput)\n"
+		"\t\t{\n"
+		"\t\t\treturn 1.0f / (1 + std::exp(weightedInput));\n"
+		"\t\t}\n"
+		"\n"
+		"\t\t//adds input * weights into sums\n"
+		"\t\ttemplate<uint32_t IN, uint32_t OUT>\n"
+		"\t\tinline void AddWeighted(const float* input, const float (&weights)[IN][OUT], float (&sums)[OUT])\n"
+		"\t\t{\n"
+		"\t\t\tfor (uint32_t i = 0; i < IN; i++)\n"
+		"\t\t\t\tfor (uint32_t n = 0; n < OUT; n++)\n"
+		"\t\t\t\t\tsums[n] += input[i] * weights[i][n];\n"
+		"\t\t}\n"
+		"\n"
+		"\t\t//outputs = Activate(biases + input * weights)\n"
+		"\t\ttemplate<uint32_t IN, uint32_t OUT>\n"
+		"\t\tinline void Dense(const float* input, const float (&biases)[OUT], const float (&weights)[IN][OUT], float (&outputs)[OUT])\n"
+		"\t\t{\n"
+		"\t\t\tfor (uint32_t n = 0; n < OUT; n++)\n"
+		"\t\t\t\toutputs[n] = biases[n];\n"
+		"\t\t\tAddWeighted(input, weights, outputs);\n"
+		"\t\t\tfor (uint32_t n = 0; n < OUT; n++)\n"
+		"\t\t\t\toutputs[n] = Activate(outputs[n]);\n"
+		"\t\t}\n"
+		"\n"
+		"\t\t//outputs = Activate(biases + input * weights + hiddenInput * hiddenWeights), a gate of a recurrent layer\n"
+		"\t\ttemplate<uint32_t IN, uint32_t OUT>\n"
+		"\t\tinline void Gate(const float* input, const float* hiddenInput, const float (&biases)[OUT], const float (&weights)[IN][OUT],\n"
+		"\t\t\tconst float (&hiddenWeights)[OUT][OUT], float (&outputs)[OUT])\n"
+		"\t\t{\n"
+		"\t\t\tfor (uint32_t n = 0; n < OUT; n++)\n"
+		"\t\t\t\toutputs[n] = biases[n];\n"
+		"\t\t\tAddWeighted(input, weights, outputs);\n"
+		"\t\t\tAddWeighted(hiddenInput, hiddenWeights, outputs);\n"
+		"\t\t\tfor (uint32_t n = 0; n < OUT; n++)\n"
+		"\t\t\t\toutputs[n] = Activate(outputs[n]);\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\n";
+
+	static const char* LAYER_TYPE_NAMES[] = { "dense", "elman", "gru" };
+
+	NetworkExporter::NetworkExporter(const Network& network, std::string name)
+		: network(network), name(name)
+	{
+		bool valid = !name.empty() && !std::isdigit((unsigned char)name[0]);
+		for (char c : name)
+			valid &= std::isalnum((unsigned char)c) || c == '_';
+		if (!valid)
+			throw std::runtime_error("The header name has to be a valid identifier");
+	}
+
+	bool NetworkExporter::SaveToFile(std::string filename) const
+	{
+		std::ofstream file(filename);
+		if (!file.is_open())
+			return false;
+
+		bool success = Save(file);
+
+		file.close();
+		return success;
+	}
+
+	std::string NetworkExporter::SaveToString() const
+	{
+		std::stringstream ss;
+		Save(ss);
+		return ss.str();
+	}
+
+	bool NetworkExporter::ExportFile(std::string networkFilename, std::string headerFilename, std::string name)
+	{
+		Network network;
+		if (!network.LoadFromFile(networkFilename))
+			return false;
+		return NetworkExporter(network, name).SaveToFile(headerFilename);
+	}
+
+	void NetworkExporter::SaveArray(std::ostream& stream, const std::vector<float>& genes, uint32_t start, uint32_t rows, uint32_t columns) const
+	{
+		stream << "{";
+		for (uint32_t r = 0; r < rows; r++)
+		{
+			stream << (rows > 1 ? "\n\t\t{ " : " ");
+			for (uint32_t c = 0; c < columns; c++)
+			{
+				float value = genes[start + r * columns + c];
+				stream << value;
+				//whole numbers are written without a point, which isn't a float literal
+				if (value == std::floor(value) && std::abs(value) < 1e9f)
+					stream << ".0";
+				stream << "f" << (c + 1 < columns ? ", " : " ");
+			}
+			if (rows > 1)
+				stream << (r + 1 < rows ? "}," : "}\n\t");
+		}
+		stream << "}";
+	}
+
+	bool NetworkExporter::Save(std::ostream& stream) const
+	{
+		if (!network.initialized)
+			return false;
+
+		//disabled connections become 0 weights and compact genes are widened
+		std::vector<float> genes(network.geneCount);
+		network.CopyGenes(genes.data(), true);
+		bool recurrent = network.stateCount > 0;
+
+		stream << "#pragma once\n";
+		stream << "//generated by nlv from a network with " << network.inputCount << " inputs and layers of";
+		for (uint32_t l = 0; l < network.layerCount; l++)
+			stream << " " << network.layers[l].outputCount << " (" << LAYER_TYPE_NAMES[(int)network.layers[l].type] << ")";
+		stream << "\n#include <cmath>\n#include <cstdint>\n\n";
+		stream << "namespace " << name << "\n{\n";
+		stream << "\tconstexpr uint32_t INPUT_COUNT = " << network.inputCount << ";\n";
+		stream << "\tconstexpr uint32_t OUTPUT_COUNT = " << network.GetOutputCount() << ";\n";
+		stream << "\t//the number of floats of hidden state recurrent layers keep between evaluations\n";
+		stream << "\tconstexpr uint32_t STATE_COUNT = " << network.stateCount << ";\n\n";
+		stream << HEADER_FUNCTIONS;
+
+		//max_digits10 so every gene is read back as the same float
+		stream << std::setprecision(std::numeric_limits<float>::max_digits10);
+
+		//the genes of every layer, in the same order as the network's genes ([input][neuron] so the inner loops go over neurons)
+		uint32_t previousCount = network.inputCount;
+		for (uint32_t l = 0; l < network.layerCount; l++)
+		{
+			const Network::Layer& layer = network.layers[l];
+			uint32_t outputCount = layer.outputCount;
+			uint32_t gateCount = Network::GetGateCount(layer.type);
+			uint32_t gateGenes = Network::GetLayerGeneCount(layer.type, previousCount, outputCount) / gateCount;
+
+			stream << "\t//layer " << l << ": " << LAYER_TYPE_NAMES[(int)layer.type] << ", " << previousCount << " inputs, " << outputCount << " outputs";
+			if (gateCount > 1)
+				stream << " (update, reset and candidate gates)";
+			stream << "\n";
+
+			stream << "\tinline constexpr float LAYER" << l << "_BIASES[" << gateCount << "][" << outputCount << "] = {";
+			for (uint32_t g = 0; g < gateCount; g++)
+			{
+				stream << (g == 0 ? "\n\t\t" : ",\n\t\t");
+				SaveArray(stream, genes, layer.geneIndex + g * gateGenes, 1, outputCount);
+			}
+			stream << "\n\t};\n";
+
+			stream << "\tinline constexpr float LAYER" << l << "_WEIGHTS[" << gateCount << "][" << previousCount << "][" << outputCount << "] = {";
+			for (uint32_t g = 0; g < gateCount; g++)
+			{
+				stream << (g == 0 ? "\n\t" : ",\n\t");
+				SaveArray(stream, genes, layer.geneIndex + g * gateGenes + outputCount, previousCount, outputCount);
+			}
+			stream << "\n\t};\n";
+
+			if (layer.type != LayerType::Dense)
+			{
+				stream << "\tinline constexpr float LAYER" << l << "_HIDDEN_WEIGHTS[" << gateCount << "][" << outputCount << "][" << outputCount << "] = {";
+				for (uint32_t g = 0; g < gateCount; g++)
+				{
+					stream << (g == 0 ? "\n\t" : ",\n\t");
+					SaveArray(stream, genes, layer.geneIndex + g * gateGenes + outputCount + previousCount * outputCount, outputCount, outputCount);
+				}
+				stream << "\n\t};\n";
+			}
+			stream << "\n";
+			previousCount = outputCount;
+		}
+
+		//the evaluate function, with every layer written out
+		stream << "\t// input: INPUT_COUNT floats\n";
+		stream << "\t// output: OUTPUT_COUNT floats that the output activations (values between 0 and 1) are written into\n";
+		if (recurrent)
+			stream << "\t// state: STATE_COUNT floats of hidden state that is read and updated (start it at 0s)\n";
+		stream << "\tinline void Evaluate(const float* input, float* output" << (recurrent ? ", float* state" : "") << ")\n\t{\n";
+		for (uint32_t l = 0; l < network.layerCount; l++)
+		{
+			const Network::Layer& layer = network.layers[l];
+			uint32_t outputCount = layer.outputCount;
+			std::string input = l == 0 ? "input" : "layer" + std::to_string(l - 1);
+			std::string output = "layer" + std::to_string(l);
+			std::string arrays = "LAYER" + std::to_string(l);
+
+			stream << "\t\tfloat " << output << "[" << outputCount << "];\n";
+			if (layer.type == LayerType::Dense)
+				stream << "\t\tdetail::Dense(" << input << ", " << arrays << "_BIASES[0], " << arrays << "_WEIGHTS[0], " << output << ");\n";
+			else
+			{
+				stream << "\t\t{\n";
+				stream << "\t\t\tfloat* hidden = state + " << layer.stateIndex << ";\n";
+				if (layer.type == LayerType::Elman)
+					stream << "\t\t\tdetail::Gate(" << input << ", hidden, " << arrays << "_BIASES[0], " << arrays << "_WEIGHTS[0], " << arrays << "_HIDDEN_WEIGHTS[0], " << output << ");\n";
+				else
+				{
+					stream << "\t\t\tfloat update[" << outputCount << "];\n";
+					stream << "\t\t\tfloat resetHidden[" << outputCount << "];\n";
+					stream << "\t\t\tdetail::Gate(" << input << ", hidden, " << arrays << "_BIASES[0], " << arrays << "_WEIGHTS[0], " << arrays << "_HIDDEN_WEIGHTS[0], update);\n";
+					stream << "\t\t\tdetail::Gate(" << input << ", hidden, " << arrays << "_BIASES[1], " << arrays << "_WEIGHTS[1], " << arrays << "_HIDDEN_WEIGHTS[1], resetHidden);\n";
+					stream << "\t\t\tfor (uint32_t n = 0; n < " << outputCount << "; n++)\n";
+					stream << "\t\t\t\tresetHidden[n] *= hidden[n];\n";
+					stream << "\t\t\tdetail::Gate(" << input << ", resetHidden, " << arrays << "_BIASES[2], " << arrays << "_WEIGHTS[2], " << arrays << "_HIDDEN_WEIGHTS[2], " << output << ");\n";
+					stream << "\t\t\tfor (uint32_t n = 0; n < " << outputCount << "; n++)\n";
+					stream << "\t\t\t\t" << output << "[n] = (1 - update[n]) * hidden[n] + update[n] * " << output << "[n];\n";
+				}
+				stream << "\t\t\tfor (uint32_t n = 0; n < " << outputCount << "; n++)\n";
+				stream << "\t\t\t\thidden[n] = " << output << "[n];\n";
+				stream << "\t\t}\n";
+			}
+		}
+		stream << "\t\tfor (uint32_t n = 0; n < OUTPUT_COUNT; n++)\n";
+		stream << "\t\t\toutput[n] = layer" << network.layerCount - 1 << "[n];\n";
+		stream << "\t}\n}\n";
+		return stream.good();
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "Network.h"
+#include <string>
+#include <ostream>
+
+namespace nlv
+{
+	//turns a trained network into a standalone c++ header, with the genes as constexpr arrays and an evaluate function written out layer by layer
+	//the header only needs the standard library and doesn't allocate, so programs that run the network don't need nlv
+	//it evaluates the same way Network::Evaluate does, the outputs can only differ by the float optimizations of the compiler
+	class NetworkExporter
+	{
+	public:
+		// network: the network to export (it is read when the header is saved, so it has to outlive the exporter)
+		// name: the namespace everything in the header goes in (has to be a valid c++ identifier)
+		NetworkExporter(const Network& network, std::string name = "network");
+
+		// Saves the header
+		// Returns whether the save succeeded or failed
+		bool SaveToFile(std::string filename) const;
+		// Returns a string containing the header
+		std::string SaveToString() const;
+
+		// Loads a network saved with Network::SaveToFile and saves it as a header
+		// Returns whether the load and the save succeeded or failed
+		static bool ExportFile(std::string networkFilename, std::string headerFilename, std::string name = "network");
+
+	private:
+		bool Save(std::ostream& stream) const;
+		// Writes a layer's genes for a gate into a constexpr array (biases, weights or hidden weights)
+		void SaveArray(std::ostream& stream, const std::vector<float>& genes, uint32_t start, uint32_t rows, uint32_t columns) const;
+
+		const Network& network;
+		std::string name;
+	};
+}
@@ -0,0 +1,160 @@
+#include "NetworkIslandEvolver.h"
+#include <thread>
+
+namespace nlv
+{
+	NetworkIslandEvolver::NetworkIslandEvolver(const std::vector<NetworkEvolverBuilder>& islandDefs, EvolverMigrationTopology topology, uint32_t migrationInterval, uint32_t migrantCount)
+		: topology(topology), migrationInterval(migrationInterval)
+	{
+		if (islandDefs.empty())
+			throw std::runtime_error("Island evolver needs at least one island");
+
+		islands.reserve(islandDefs.size());
+		for (const auto& def : islandDefs)
+		{
+			islands.push_back(NetworkEvolver(def));
+			//migrants are copied gene by gene, so every network has to have the same layout
+			if (islands.back().GetGeneCount() != islands[0].GetGeneCount())
+				throw std::runtime_error("Every island needs to have the same network layout");
+		}
+		SetMigrantCount(migrantCount);
+	}
+
+	void NetworkIslandEvolver::EvaluateGeneration()
+	{
+		EvaluateGenerations(1);
+	}
+
+	void NetworkIslandEvolver::EvaluateGenerations(uint32_t count)
+	{
+		if (islands.empty())
+			throw std::runtime_error("NetworkIslandEvolver was not initiated correctly");
+		if (count == 0)
+			throw std::runtime_error("Count cannot be 0");
+
+		while (count > 0)
+		{
+			//islands run on their own until the next migration
+			uint32_t generations = count;
+			if (migrationInterval != 0)
+				generations = std::min(count, migrationInterval - generationsSinceMigration);
+
+			std::vector<std::thread> threads;
+			threads.reserve(islands.size());
+			for (auto& island : islands)
+				threads.emplace_back([&island, generations]() { island.EvaluateGenerations(generations); });
+			for (auto& thread : threads)
+				thread.join();
+
+			count -= generations;
+			currentGeneration += generations;
+			generationsSinceMigration += generations;
+			if (migrationInterval != 0 && generationsSinceMigration >= migrationInterval)
+			{
+				Migrate();
+				generationsSinceMigration = 0;
+			}
+		}
+	}
+
+	const NetworkOrganism& NetworkIslandEvolver::FindBestOrganism() const
+	{
+		const NetworkOrganism* best = &islands[0].FindBestOrganism();
+		for (size_t i = 1; i < islands.size(); i++)
+		{
+			const NetworkOrganism& organism = islands[i].FindBestOrganism();
+			if (organism.fitness > best->fitness)
+				best = &organism;
+		}
+		return *best;
+	}
+
+	int NetworkIslandEvolver::GetIslandIndex(const NetworkEvolver& island) const
+	{
+		for (size_t i = 0; i < islands.size(); i++)
+		{
+			if (&islands[i] == &island)
+				return (int)i;
+		}
+		return -1;
+	}
+
+	void NetworkIslandEvolver::SetMigrantCount(uint32_t count)
+	{
+		migrantCount = std::min(count, GetMaxMigrantCount());
+	}
+
+	uint32_t NetworkIslandEvolver::GetMaxMigrantCount() const
+	{
+		//an island can't receive more organisms than it has
+		uint32_t maxCount = UINT32_MAX;
+		for (const auto& island : islands)
+		{
+			uint32_t sources = topology == EvolverMigrationTopology::FullyConnected ? std::max((uint32_t)islands.size() - 1, 1U) : 1;
+			maxCount = std::min(maxCount, island.GetPopulationSize() / sources);
+		}
+		return maxCount;
+	}
+
+	void NetworkIslandEvolver::Migrate()
+	{
+		uint32_t islandCount = (uint32_t)islands.size();
+		//islands can shrink after the migrant count was set (see NetworkEvolver::SetPopulationSize), so it is clamped again every migration
+		uint32_t count = std::min(migrantCount, GetMaxMigrantCount());
+		if (islandCount < 2 || count == 0)
+			return;
+		uint32_t geneCount = islands[0].GetGeneCount();
+		uint32_t genesPerIsland = count * geneCount;
+		//connection masks migrate with the genes if any island uses them
+		bool masked = false;
+		for (const auto& island : islands)
+			masked |= island.GetHasConnectionMasks();
+
+		//every island's migrants are taken before any are received, so organisms don't migrate twice in one go
+		std::vector<float> genes(islandCount * genesPerIsland);
+		std::vector<float> fitnesses(islandCount * count);
+		std::vector<uint8_t> masks(masked ? islandCount * genesPerIsland : 0);
+		auto islandMasks = [&](std::vector<uint8_t>& array, uint32_t i) { return masked ? array.data() + i * genesPerIsland : nullptr; };
+		for (uint32_t i = 0; i < islandCount; i++)
+			islands[i].GetMigrants(count, genes.data() + i * genesPerIsland, fitnesses.data() + i * count, islandMasks(masks, i));
+
+		switch (topology)
+		{
+		case EvolverMigrationTopology::Ring:
+		{
+			//every island receives migrants from the island before it
+			for (uint32_t i = 0; i < islandCount; i++)
+			{
+				uint32_t source = (i + islandCount - 1) % islandCount;
+				islands[i].ReceiveMigrants(count, genes.data() + source * genesPerIsland, fitnesses.data() + source * count, islandMasks(masks, source));
+			}
+			break;
+		}
+		case EvolverMigrationTopology::FullyConnected:
+		{
+			//every island receives migrants from every other island
+			std::vector<float> incomingGenes((islandCount - 1) * genesPerIsland);
+			std::vector<float> incomingFitnesses((islandCount - 1) * count);
+			std::vector<uint8_t> incomingMasks(masked ? (islandCount - 1) * genesPerIsland : 0);
+			for (uint32_t i = 0; i < islandCount; i++)
+			{
+				uint32_t incomingIndex = 0;
+				for (uint32_t source = 0; source < islandCount; source++)
+				{
+					if (source == i)
+						continue;
+					memcpy(incomingGenes.data() + incomingIndex * genesPerIsland, genes.data() + source * genesPerIsland, sizeof(float) * genesPerIsland);
+					memcpy(incomingFitnesses.data() + incomingIndex * count, fitnesses.data() + source * count, sizeof(float) * count);
+					if (masked)
+						memcpy(islandMasks(incomingMasks, incomingIndex), islandMasks(masks, source), genesPerIsland);
+					incomingIndex++;
+				}
+				islands[i].ReceiveMigrants((islandCount - 1) * count, incomingGenes.data(), incomingFitnesses.data(), islandMasks(incomingMasks, 0));
+			}
+			break;
+		}
+		default:
+			throw std::runtime_error("Migration topology is incorrectly defined");
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "NetworkEvolver.h"
+#include <vector>
+
+namespace nlv
+{
+	//an evolver made of multiple network evolvers (islands) that evolve seperately, each on its own thread
+	//every migrationInterval generations the best organisms of each island migrate to other islands based on the migration topology
+	//islands only have to wait for each other when migrating, and keep more diversity than one big population
+	class NetworkIslandEvolver
+	{
+	public:
+		//this will not fully initiate the island evolver
+		NetworkIslandEvolver() = default;
+		// Create an island evolver with an island for every network evolver definition
+		// islandDefs: The definitions of every island (every island needs the same network layout, but can use different operators)
+		// topology: Which islands migrants are sent to
+		// migrationInterval: The number of generations between migrations (0 means islands never migrate)
+		// migrantCount: The number of organisms an island sends to each island it migrates to
+		NetworkIslandEvolver(const std::vector<NetworkEvolverBuilder>& islandDefs, EvolverMigrationTopology topology, uint32_t migrationInterval, uint32_t migrantCount);
+		NetworkIslandEvolver(NetworkIslandEvolver&& other) = default;
+		NetworkIslandEvolver& operator=(NetworkIslandEvolver&& other) = default;
+		NetworkIslandEvolver(const NetworkIslandEvolver& other) = delete;
+		NetworkIslandEvolver& operator=(const NetworkIslandEvolver& other) = delete;
+
+		// Evaluates a generation on every island, migrating if it is time to
+		void EvaluateGeneration();
+		// Evaluates several generations on every island. islands only synchronize when migrating
+		void EvaluateGenerations(uint32_t count);
+
+		//Finds the organism with the highest fitness out of every island
+		const NetworkOrganism& FindBestOrganism() const;
+		// Returns the index of an island, or -1 if the evolver is not one of the islands (useful inside of callbacks)
+		int GetIslandIndex(const NetworkEvolver& island) const;
+
+		//Getters
+		inline NetworkEvolver& GetIsland(uint32_t index) { return islands[index]; }
+		inline const NetworkEvolver& GetIsland(uint32_t index) const { return islands[index]; }
+		inline uint32_t GetIslandCount() const { return (uint32_t)islands.size(); }
+		inline uint32_t GetGeneration() const { return currentGeneration; }
+		inline bool GetIsInitiated() const { return !islands.empty(); }
+		inline EvolverMigrationTopology GetMigrationTopology() const { return topology; }
+		inline uint32_t GetMigrationInterval() const { return migrationInterval; }
+		inline uint32_t GetMigrantCount() const { return migrantCount; }
+
+		//Setters
+		inline void SetMigrationTopology(EvolverMigrationTopology topology) { this->topology = topology; }
+		inline void SetMigrationInterval(uint32_t interval) { migrationInterval = interval; }
+		void SetMigrantCount(uint32_t count);
+
+	private:
+		// Sends the best organisms of every island to other islands, replacing their worst organisms
+		void Migrate();
+		// Returns the most migrants every island can send without an island receiving more organisms than it has
+		uint32_t GetMaxMigrantCount() const;
+
+		std::vector<NetworkEvolver> islands;
+		EvolverMigrationTopology topology = EvolverMigrationTopology::Ring;
+		uint32_t migrationInterval = 0;
+		uint32_t migrantCount = 0;
+		// The number of generations every island has evaluated
+		uint32_t currentGeneration = 0;
+		// The number of generations since the last migration
+		uint32_t generationsSinceMigration = 0;
+	};
+}
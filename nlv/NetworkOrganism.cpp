@@ -22,7 +22,7 @@ namespace nlv {
 		continueStepping(other.continueStepping)
 	{
 		networkInputs = new float[other.network.GetInputCount()];
-		memcpy(other.networkInputs, networkInputs, sizeof(float) * other.network.GetInputCount());
+		memcpy(networkInputs, other.networkInputs, sizeof(float) * other.network.GetInputCount());
 	}
 
 	NetworkOrganism& NetworkOrganism::operator=(const NetworkOrganism& other)
@@ -38,7 +38,7 @@ namespace nlv {
 		fitness = other.fitness;
 		continueStepping = other.continueStepping;
 		networkInputs = new float[other.network.GetInputCount()];
-		memcpy(other.networkInputs, networkInputs, sizeof(float) * other.network.GetInputCount());
+		memcpy(networkInputs, other.networkInputs, sizeof(float) * other.network.GetInputCount());
 		return *this;
 	}
 
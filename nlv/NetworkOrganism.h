@@ -8,6 +8,8 @@ namespace nlv
 	class NetworkOrganism
 	{
 		friend NetworkEvolver;
+		friend class NetworkRemoteEvaluator;
+		friend class EvolutionStrategy;
 	private:
 		NetworkOrganism(Network& networkToCopy);
 		~NetworkOrganism();
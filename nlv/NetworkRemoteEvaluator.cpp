@@ -0,0 +1,266 @@
+#include "NetworkRemoteEvaluator.h"
+#include "NetworkEvolver.h"
+#include <chrono>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+
+namespace nlv
+{
+	//appends a value to a message
+	template<typename T>
+	static inline void Write(std::vector<char>& message, const T& value)
+	{
+		size_t size = message.size();
+		message.resize(size + sizeof(T));
+		memcpy(message.data() + size, &value, sizeof(T));
+	}
+
+	NetworkRemoteEvaluator::NetworkRemoteEvaluator(const std::string& socketPath, uint32_t batchSize, uint32_t organismTimeoutMilliseconds)
+		: socketPath(socketPath), batchSize(batchSize == 0 ? 1 : batchSize), organismTimeoutMilliseconds(organismTimeoutMilliseconds)
+	{
+		listener = remote::Listen(socketPath);
+		if (listener == remote::INVALID_SOCKET_HANDLE)
+			throw std::runtime_error("Could not create the remote evaluator socket");
+	}
+
+	NetworkRemoteEvaluator::~NetworkRemoteEvaluator()
+	{
+		for (auto& worker : workers)
+		{
+			uint32_t type = (uint32_t)remote::MessageType::Shutdown;
+			remote::SendAll(worker.socket, &type, sizeof(type));
+			remote::Close(worker.socket);
+		}
+		remote::Close(listener);
+		remote::RemovePath(socketPath);
+	}
+
+	uint32_t NetworkRemoteEvaluator::WaitForWorkers(uint32_t count, uint32_t timeoutMilliseconds)
+	{
+		auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMilliseconds);
+		while (workers.size() < count)
+		{
+			auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(end - std::chrono::steady_clock::now()).count();
+			if (remaining <= 0)
+				break;
+			AcceptWorker((int)remaining);
+		}
+		return (uint32_t)workers.size();
+	}
+
+	void NetworkRemoteEvaluator::Evaluate(NetworkEvolver& evolver, uint32_t startIndex, uint32_t endIndex)
+	{
+		//workers that connected since the last generation
+		while (AcceptWorker(0));
+
+		//split the organisms into batches
+		std::deque<std::pair<uint32_t, uint32_t>> queue;
+		for (uint32_t i = startIndex; i < endIndex; i += batchSize)
+			queue.emplace_back(i, std::min(i + batchSize, endIndex));
+		size_t remainingBatches = queue.size();
+
+		std::vector<remote::Socket> sockets;
+		std::vector<size_t> socketWorkers;
+		std::unique_ptr<bool[]> readable;
+		std::vector<size_t> deadWorkers;
+		while (remainingBatches > 0)
+		{
+			//give every idle worker a batch
+			deadWorkers.clear();
+			for (size_t w = 0; w < workers.size() && !queue.empty(); w++)
+			{
+				Worker& worker = workers[w];
+				if (worker.busy)
+					continue;
+
+				worker.busy = true;
+				worker.batchStart = queue.front().first;
+				worker.batchEnd = queue.front().second;
+				queue.pop_front();
+				if (!SendBatch(worker, evolver))
+					deadWorkers.push_back(w);
+			}
+			for (auto w = deadWorkers.rbegin(); w != deadWorkers.rend(); w++)
+				RemoveWorker(*w, queue);
+
+			if (workers.empty())
+				throw std::runtime_error("There are no remote workers left to evaluate organisms");
+			if (!deadWorkers.empty())
+				continue;
+
+			//wait for any busy worker to send results, or for the first deadline to pass
+			sockets.clear();
+			socketWorkers.clear();
+			for (size_t w = 0; w < workers.size(); w++)
+			{
+				if (workers[w].busy)
+				{
+					sockets.push_back(workers[w].socket);
+					socketWorkers.push_back(w);
+				}
+			}
+			readable.reset(new bool[sockets.size()]);
+			if (!remote::WaitReadable(sockets.data(), (uint32_t)sockets.size(), readable.get(), GetWaitTimeout()))
+				throw std::runtime_error("Could not wait for remote workers");
+
+			auto now = std::chrono::steady_clock::now();
+			deadWorkers.clear();
+			for (size_t i = 0; i < sockets.size(); i++)
+			{
+				Worker& worker = workers[socketWorkers[i]];
+				if (!readable[i])
+				{
+					//a worker that hung is dropped like one that disconnected, so its batch goes to another worker
+					if (organismTimeoutMilliseconds != 0 && now >= worker.deadline)
+						deadWorkers.push_back(socketWorkers[i]);
+					continue;
+				}
+
+				if (ReceiveResults(worker, evolver))
+				{
+					worker.busy = false;
+					remainingBatches--;
+				}
+				else
+					deadWorkers.push_back(socketWorkers[i]);
+			}
+			//(socketWorkers is in order, so this removes from the back first)
+			for (auto w = deadWorkers.rbegin(); w != deadWorkers.rend(); w++)
+				RemoveWorker(*w, queue);
+		}
+	}
+
+	bool NetworkRemoteEvaluator::AcceptWorker(int timeoutMilliseconds)
+	{
+		remote::Socket socket = remote::Accept(listener, timeoutMilliseconds);
+		if (socket == remote::INVALID_SOCKET_HANDLE)
+			return false;
+
+		//workers send a signature and version first, so random connections and old workers are ignored
+		//(a connection that doesn't send anything is dropped after a timeout instead of blocking the evolver)
+		uint32_t header[2];
+		if (!remote::SetReceiveTimeout(socket, remote::HANDSHAKE_TIMEOUT_MILLISECONDS) || !remote::ReceiveAll(socket, header, sizeof(header))
+			|| header[0] != remote::WORKER_SIGNATURE || header[1] != remote::PROTOCOL_VERSION || !remote::SetReceiveTimeout(socket, 0))
+		{
+			remote::Close(socket);
+			return false;
+		}
+
+		Worker worker;
+		worker.socket = socket;
+		workers.push_back(worker);
+		return true;
+	}
+
+	bool NetworkRemoteEvaluator::SendLayout(Worker& worker, const Network& network)
+	{
+		messageBuffer.clear();
+		Write(messageBuffer, (uint32_t)remote::MessageType::Layout);
+		Write(messageBuffer, network.GetInputCount());
+		Write(messageBuffer, network.GetLayerCount());
+		for (uint32_t i = 0; i < network.GetLayerCount(); i++)
+			Write(messageBuffer, network.GetLayerNeuronCount(i));
+		for (uint32_t i = 0; i < network.GetLayerCount(); i++)
+			Write(messageBuffer, (uint32_t)network.GetLayerType(i));
+		Write(messageBuffer, network.GetGeneCount());
+
+		worker.sentLayout = remote::SendAll(worker.socket, messageBuffer.data(), messageBuffer.size());
+		return worker.sentLayout;
+	}
+
+	bool NetworkRemoteEvaluator::SendBatch(Worker& worker, NetworkEvolver& evolver)
+	{
+		//(the deadline is scaled by the batch size, since a worker evaluates its batch one organism after another)
+		worker.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds((uint64_t)organismTimeoutMilliseconds * (worker.batchEnd - worker.batchStart));
+		if (!worker.sentLayout && !SendLayout(worker, evolver.organisms[0].network))
+			return false;
+
+		uint32_t geneCount = evolver.organisms[0].network.GetGeneCount();
+		messageBuffer.clear();
+		messageBuffer.reserve(sizeof(uint32_t) * 4 + (worker.batchEnd - worker.batchStart) * (sizeof(uint32_t) + sizeof(float) * geneCount));
+		Write(messageBuffer, (uint32_t)remote::MessageType::Batch);
+		Write(messageBuffer, evolver.GetGeneration());
+		Write(messageBuffer, evolver.GetMaxSteps());
+		Write(messageBuffer, worker.batchEnd - worker.batchStart);
+		for (uint32_t i = worker.batchStart; i < worker.batchEnd; i++)
+		{
+			Write(messageBuffer, i);
+			size_t size = messageBuffer.size();
+			messageBuffer.resize(size + sizeof(float) * geneCount);
+			//(widened if the genes are stored in 16 bits, workers always get floats. disabled connections are sent as 0 weights)
+			evolver.organisms[i].network.CopyGenes((float*)(messageBuffer.data() + size), true);
+		}
+
+		return remote::SendAll(worker.socket, messageBuffer.data(), messageBuffer.size());
+	}
+
+	bool NetworkRemoteEvaluator::ReceiveResults(Worker& worker, NetworkEvolver& evolver)
+	{
+		//a worker that stops halfway through sending its results can't block the evolver past its deadline either
+		if (organismTimeoutMilliseconds != 0)
+		{
+			auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(worker.deadline - std::chrono::steady_clock::now()).count();
+			//(0 would block forever)
+			if (remaining <= 0 || !remote::SetReceiveTimeout(worker.socket, (int)remaining))
+				return false;
+		}
+
+		uint32_t count;
+		if (!remote::ReceiveAll(worker.socket, &count, sizeof(count)) || count != worker.batchEnd - worker.batchStart)
+			return false;
+
+		struct Result
+		{
+			uint32_t index;
+			float fitness;
+			uint32_t steps;
+		};
+		std::vector<Result> results(count);
+		if (!remote::ReceiveAll(worker.socket, results.data(), sizeof(Result) * count))
+			return false;
+
+		//nothing is written until the whole batch has arrived, so a worker dying halfway through doesn't leave half a batch behind
+		for (const auto& result : results)
+		{
+			if (result.index < worker.batchStart || result.index >= worker.batchEnd)
+				return false;
+		}
+		for (const auto& result : results)
+		{
+			NetworkOrganism& organism = evolver.organisms[result.index];
+			organism.fitness = result.fitness;
+			organism.steps = result.steps;
+			organism.continueStepping = false;
+		}
+		return true;
+	}
+
+	int NetworkRemoteEvaluator::GetWaitTimeout() const
+	{
+		if (organismTimeoutMilliseconds == 0)
+			return -1;
+
+		auto now = std::chrono::steady_clock::now();
+		long long timeout = -1;
+		for (const auto& worker : workers)
+		{
+			if (!worker.busy)
+				continue;
+			//(rounded up, so the deadline has passed when the wait ends)
+			long long remaining = std::max((long long)std::chrono::duration_cast<std::chrono::milliseconds>(worker.deadline - now).count() + 1, 0ll);
+			if (timeout < 0 || remaining < timeout)
+				timeout = remaining;
+		}
+		return (int)std::min(timeout, (long long)INT32_MAX);
+	}
+
+	void NetworkRemoteEvaluator::RemoveWorker(size_t index, std::deque<std::pair<uint32_t, uint32_t>>& queue)
+	{
+		Worker& worker = workers[index];
+		if (worker.busy)
+			queue.emplace_front(worker.batchStart, worker.batchEnd);
+		remote::Close(worker.socket);
+		workers.erase(workers.begin() + index);
+	}
+}
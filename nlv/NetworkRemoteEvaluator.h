@@ -0,0 +1,80 @@
+#pragma once
+#include "RemoteSocket.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <chrono>
+
+namespace nlv
+{
+	class NetworkEvolver;
+	class Network;
+
+	//evaluates organisms in other processes (NetworkRemoteWorker) instead of stepping them inside of the evolver
+	//workers connect over a unix domain socket. organisms are sent to them in batches and their fitness is sent back
+	//if a worker disconnects (e.g. it crashed) or takes too long (e.g. it hung) the batch it was evaluating is given to another worker
+	//results are written back by organism index, so they don't depend on which worker evaluated which organism
+	class NetworkRemoteEvaluator
+	{
+	public:
+		// socketPath: the path of the socket that workers connect to
+		// batchSize: the number of organisms sent to a worker at a time
+		// organismTimeoutMilliseconds: how long a worker can take per organism in its batch before it is dropped (0 waits forever)
+		NetworkRemoteEvaluator(const std::string& socketPath, uint32_t batchSize = 16, uint32_t organismTimeoutMilliseconds = 10000);
+		// Tells every worker to stop and removes the socket
+		~NetworkRemoteEvaluator();
+		NetworkRemoteEvaluator(const NetworkRemoteEvaluator& other) = delete;
+		NetworkRemoteEvaluator& operator=(const NetworkRemoteEvaluator& other) = delete;
+
+		// Accepts workers until there are count workers connected (workers can also connect between generations)
+		// timeoutMilliseconds: the longest time to wait for
+		// Returns the number of connected workers
+		uint32_t WaitForWorkers(uint32_t count, uint32_t timeoutMilliseconds);
+
+		inline uint32_t GetWorkerCount() const { return (uint32_t)workers.size(); }
+		inline uint32_t GetBatchSize() const { return batchSize; }
+		inline const std::string& GetSocketPath() const { return socketPath; }
+		inline void SetBatchSize(uint32_t size) { batchSize = size == 0 ? 1 : size; }
+		inline uint32_t GetOrganismTimeout() const { return organismTimeoutMilliseconds; }
+		inline void SetOrganismTimeout(uint32_t timeoutMilliseconds) { organismTimeoutMilliseconds = timeoutMilliseconds; }
+
+	private:
+		friend NetworkEvolver;
+
+		struct Worker
+		{
+			remote::Socket socket;
+			//whether the network layout was sent to the worker
+			bool sentLayout = false;
+			//whether the worker is evaluating a batch
+			bool busy = false;
+			//the organisms in the batch the worker is evaluating [batchStart, batchEnd)
+			uint32_t batchStart = 0;
+			uint32_t batchEnd = 0;
+			//when the worker is dropped if it hasn't sent the batch's results (only used if there is an organism timeout)
+			std::chrono::steady_clock::time_point deadline;
+		};
+
+		// Evaluates organisms in [startIndex, endIndex) on the workers, setting their fitness and steps
+		// Throws if there are no workers left to evaluate on
+		void Evaluate(NetworkEvolver& evolver, uint32_t startIndex, uint32_t endIndex);
+		// Accepts a worker connection (and checks its signature). Returns false if no worker was accepted
+		bool AcceptWorker(int timeoutMilliseconds);
+		bool SendLayout(Worker& worker, const Network& network);
+		bool SendBatch(Worker& worker, NetworkEvolver& evolver);
+		// Returns false if the results were wrong or didn't all arrive before the worker's deadline
+		bool ReceiveResults(Worker& worker, NetworkEvolver& evolver);
+		// Returns how long to wait for results before the first busy worker's deadline passes (-1 waits forever)
+		int GetWaitTimeout() const;
+		// Disconnects a worker, putting the batch it was evaluating back into the queue
+		void RemoveWorker(size_t index, std::deque<std::pair<uint32_t, uint32_t>>& queue);
+
+		std::vector<Worker> workers;
+		remote::Socket listener = remote::INVALID_SOCKET_HANDLE;
+		std::string socketPath;
+		uint32_t batchSize;
+		uint32_t organismTimeoutMilliseconds;
+		//reused between batches so they don't allocate
+		std::vector<char> messageBuffer;
+	};
+}
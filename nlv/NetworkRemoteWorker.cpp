@@ -0,0 +1,121 @@
+#include "NetworkRemoteWorker.h"
+#include <cstring>
+
+namespace nlv
+{
+	NetworkRemoteWorker::NetworkRemoteWorker(const std::string& socketPath, EvolverRemoteEpisodeCallback episodeFunction, void* userPointer)
+		: socketPath(socketPath), episodeCallback(episodeFunction), userPointer(userPointer)
+	{
+		if (episodeCallback == nullptr)
+			throw std::runtime_error("Episode callback cannot be nullptr");
+	}
+
+	NetworkRemoteWorker::~NetworkRemoteWorker()
+	{
+		remote::Close(socket);
+	}
+
+	bool NetworkRemoteWorker::Run()
+	{
+		remote::Close(socket);
+		socket = remote::Connect(socketPath);
+		if (socket == remote::INVALID_SOCKET_HANDLE)
+			return false;
+
+		uint32_t header[2] = { remote::WORKER_SIGNATURE, remote::PROTOCOL_VERSION };
+		bool connected = remote::SendAll(socket, header, sizeof(header));
+		bool shutdown = false;
+		while (connected && !shutdown)
+		{
+			uint32_t type;
+			if (!remote::ReceiveAll(socket, &type, sizeof(type)))
+				break;
+
+			switch ((remote::MessageType)type)
+			{
+			case remote::MessageType::Layout:
+				connected = ReceiveLayout();
+				break;
+			case remote::MessageType::Batch:
+				connected = EvaluateBatch();
+				break;
+			case remote::MessageType::Shutdown:
+				shutdown = true;
+				break;
+			default:
+				//the rest of the message can't be skipped without knowing what it is
+				connected = false;
+				break;
+			}
+		}
+
+		remote::Close(socket);
+		socket = remote::INVALID_SOCKET_HANDLE;
+		return shutdown;
+	}
+
+	bool NetworkRemoteWorker::ReceiveLayout()
+	{
+		uint32_t inputCount, layerCount;
+		if (!remote::ReceiveAll(socket, &inputCount, sizeof(inputCount)) || !remote::ReceiveAll(socket, &layerCount, sizeof(layerCount)) || layerCount == 0)
+			return false;
+
+		std::vector<uint32_t> neuronCounts(layerCount);
+		std::vector<uint32_t> layerTypes(layerCount);
+		uint32_t geneCount;
+		if (!remote::ReceiveAll(socket, neuronCounts.data(), sizeof(uint32_t) * layerCount) || !remote::ReceiveAll(socket, layerTypes.data(), sizeof(uint32_t) * layerCount)
+			|| !remote::ReceiveAll(socket, &geneCount, sizeof(geneCount)))
+			return false;
+
+		std::vector<int> hiddenLayers(neuronCounts.begin(), neuronCounts.end() - 1);
+		std::vector<LayerType> hiddenTypes(hiddenLayers.size());
+		for (size_t i = 0; i < hiddenTypes.size(); i++)
+		{
+			if (layerTypes[i] > (uint32_t)LayerType::GRU)
+				return false;
+			hiddenTypes[i] = (LayerType)layerTypes[i];
+		}
+		network = Network(inputCount, hiddenLayers, neuronCounts.back(), hiddenTypes);
+		//if this doesn't match the evaluator has a different network than the worker thinks it has
+		if (network.GetGeneCount() != geneCount)
+			return false;
+
+		genes.resize(geneCount);
+		return true;
+	}
+
+	bool NetworkRemoteWorker::EvaluateBatch()
+	{
+		uint32_t info[3];
+		if (!remote::ReceiveAll(socket, info, sizeof(info)) || genes.empty())
+			return false;
+		uint32_t generation = info[0], maxSteps = info[1], count = info[2];
+
+		//results are sent back all at once
+		results.resize(sizeof(uint32_t) + count * (sizeof(uint32_t) + sizeof(float) + sizeof(uint32_t)));
+		char* result = results.data();
+		memcpy(result, &count, sizeof(count));
+		result += sizeof(count);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t organismIndex;
+			if (!remote::ReceiveAll(socket, &organismIndex, sizeof(organismIndex)) || !remote::ReceiveAll(socket, genes.data(), sizeof(float) * genes.size()))
+				return false;
+
+			network.SetGenes(genes.data());
+			//every organism starts its episode with no memory
+			network.ResetState();
+			float fitness = 0;
+			uint32_t steps = 0;
+			episodeCallback(network, organismIndex, generation, maxSteps, fitness, steps, userPointer);
+
+			memcpy(result, &organismIndex, sizeof(organismIndex));
+			memcpy(result + sizeof(uint32_t), &fitness, sizeof(fitness));
+			memcpy(result + sizeof(uint32_t) + sizeof(float), &steps, sizeof(steps));
+			result += sizeof(uint32_t) + sizeof(float) + sizeof(uint32_t);
+		}
+
+		return remote::SendAll(socket, results.data(), results.size());
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "RemoteSocket.h"
+#include "EvolverEnums.h"
+#include <vector>
+
+namespace nlv
+{
+	//runs in a separate process and evaluates organisms sent to it by a NetworkRemoteEvaluator
+	//the worker doesn't know anything about the evolver, it just gets genes and sends back fitness
+	class NetworkRemoteWorker
+	{
+	public:
+		// socketPath: the path the evaluator is listening on
+		// episodeFunction: runs the episode for one organism
+		// userPointer: passed to episodeFunction
+		NetworkRemoteWorker(const std::string& socketPath, EvolverRemoteEpisodeCallback episodeFunction, void* userPointer = nullptr);
+		~NetworkRemoteWorker();
+		NetworkRemoteWorker(const NetworkRemoteWorker& other) = delete;
+		NetworkRemoteWorker& operator=(const NetworkRemoteWorker& other) = delete;
+
+		// Connects to the evaluator and evaluates organisms until it is told to stop
+		// Returns true if the evaluator told the worker to stop, false if the connection failed or broke
+		bool Run();
+
+		inline void* GetUserPointer() const { return userPointer; }
+		inline void SetUserPointer(void* ptr) { userPointer = ptr; }
+
+	private:
+		bool ReceiveLayout();
+		bool EvaluateBatch();
+
+		std::string socketPath;
+		EvolverRemoteEpisodeCallback episodeCallback;
+		void* userPointer;
+		remote::Socket socket = remote::INVALID_SOCKET_HANDLE;
+		//the network every organism's genes are loaded into
+		Network network;
+		//reused between batches so they don't allocate
+		std::vector<float> genes;
+		std::vector<char> results;
+	};
+}
@@ -0,0 +1,101 @@
+#include "NetworkSharedMemoryBridge.h"
+#include "NetworkEvolver.h"
+#include <cstring>
+
+namespace nlv
+{
+	NetworkSharedMemoryBridge::NetworkSharedMemoryBridge(const std::string& name, uint32_t populationSize, uint32_t inputCount, uint32_t outputCount)
+		: layout(populationSize, inputCount, outputCount)
+	{
+		if (!shared::Create(name, layout.size, region))
+			throw std::runtime_error("Could not create the shared memory bridge");
+
+		header = new (region.data) shared::BridgeHeader();
+		header->populationSize = populationSize;
+		header->inputCount = inputCount;
+		header->outputCount = outputCount;
+		if (!shared::CreateSignal(name + "_request", &header->requestCounter, requestSignal) || !shared::CreateSignal(name + "_response", &header->responseCounter, responseSignal))
+		{
+			shared::CloseSignal(requestSignal);
+			shared::Close(region);
+			throw std::runtime_error("Could not create the shared memory bridge signals");
+		}
+		//written last, the simulator doesn't use the region until the signature is there
+		header->version = shared::BRIDGE_VERSION;
+		std::atomic_thread_fence(std::memory_order_release);
+		header->signature = shared::BRIDGE_SIGNATURE;
+	}
+
+	NetworkSharedMemoryBridge::~NetworkSharedMemoryBridge()
+	{
+		//the simulator isn't waited for, it might not even be running
+		header->command = shared::BridgeCommand::Shutdown;
+		shared::Notify(requestSignal);
+		shared::CloseSignal(requestSignal);
+		shared::CloseSignal(responseSignal);
+		shared::Close(region);
+	}
+
+	void NetworkSharedMemoryBridge::BeginEpisode(const NetworkEvolver& evolver, NetworkOrganism* organisms, uint32_t startIndex, uint32_t endIndex)
+	{
+		uint8_t* continueStepping = (uint8_t*)region.data + layout.continueStepping;
+		float* fitness = (float*)((char*)region.data + layout.fitness);
+		for (uint32_t i = startIndex; i < endIndex; i++)
+		{
+			continueStepping[i] = true;
+			fitness[i] = 0;
+		}
+
+		Request(evolver, shared::BridgeCommand::BeginEpisode, startIndex, endIndex);
+
+		for (uint32_t i = startIndex; i < endIndex; i++)
+			ReadOrganism(organisms[i], i);
+	}
+
+	void NetworkSharedMemoryBridge::Step(const NetworkEvolver& evolver, NetworkOrganism* organisms, uint32_t startIndex, uint32_t endIndex)
+	{
+		uint32_t outputCount = header->outputCount;
+		uint32_t maxSteps = evolver.GetMaxSteps();
+		uint8_t* stepping = (uint8_t*)region.data + layout.stepping;
+		float* outputs = (float*)((char*)region.data + layout.outputs);
+		for (uint32_t i = startIndex; i < endIndex; i++)
+		{
+			const NetworkOrganism& organism = organisms[i];
+			stepping[i] = organism.continueStepping && organism.GetStepsTaken() < maxSteps;
+			if (stepping[i])
+				memcpy(outputs + i * outputCount, organism.GetNetworkOutputActivations(), sizeof(float) * outputCount);
+		}
+
+		Request(evolver, shared::BridgeCommand::Step, startIndex, endIndex);
+
+		for (uint32_t i = startIndex; i < endIndex; i++)
+		{
+			if (stepping[i])
+				ReadOrganism(organisms[i], i);
+		}
+	}
+
+	void NetworkSharedMemoryBridge::Request(const NetworkEvolver& evolver, shared::BridgeCommand command, uint32_t startIndex, uint32_t endIndex)
+	{
+		header->command = command;
+		header->generation = evolver.GetGeneration();
+		header->maxSteps = evolver.GetMaxSteps();
+		header->startIndex = startIndex;
+		header->endIndex = endIndex;
+
+		//the response counter changes once the simulator has answered
+		uint32_t response = header->responseCounter.load(std::memory_order_acquire);
+		shared::Notify(requestSignal);
+		if (!shared::Wait(responseSignal, response, timeout))
+			throw std::runtime_error("The simulator did not answer the shared memory bridge in time");
+	}
+
+	void NetworkSharedMemoryBridge::ReadOrganism(NetworkOrganism& organism, uint32_t index)
+	{
+		uint32_t inputCount = header->inputCount;
+		const float* inputs = (const float*)((const char*)region.data + layout.inputs);
+		memcpy(organism.GetNetworkInputArray(), inputs + index * inputCount, sizeof(float) * inputCount);
+		organism.fitness = ((const float*)((const char*)region.data + layout.fitness))[index];
+		organism.continueStepping = ((const uint8_t*)region.data + layout.continueStepping)[index] != 0;
+	}
+}
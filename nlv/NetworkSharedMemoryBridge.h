@@ -0,0 +1,50 @@
+#pragma once
+#include "SharedMemory.h"
+
+namespace nlv
+{
+	class NetworkEvolver;
+	class NetworkOrganism;
+
+	//lets a simulator in another process (using NetworkSharedMemoryClient) step organisms instead of the step callbacks
+	//every step the evolver writes the network outputs of the whole population into shared memory, and the simulator writes back
+	//inputs, fitness and continueStepping, so a step costs two memory copies and a wake up instead of a message per organism
+	class NetworkSharedMemoryBridge
+	{
+	public:
+		// name: the name of the shared memory, the simulator opens it with the same name
+		// the network sizes and population size have to match the evolver it is used with
+		NetworkSharedMemoryBridge(const std::string& name, uint32_t populationSize, uint32_t inputCount, uint32_t outputCount);
+		// Tells the simulator to stop and removes the shared memory
+		~NetworkSharedMemoryBridge();
+		NetworkSharedMemoryBridge(const NetworkSharedMemoryBridge& other) = delete;
+		NetworkSharedMemoryBridge& operator=(const NetworkSharedMemoryBridge& other) = delete;
+
+		inline const std::string& GetName() const { return region.name; }
+		inline uint32_t GetPopulationSize() const { return header->populationSize; }
+		inline uint32_t GetInputCount() const { return header->inputCount; }
+		inline uint32_t GetOutputCount() const { return header->outputCount; }
+		inline int GetTimeout() const { return timeout; }
+		// timeoutMilliseconds: the longest time to wait for the simulator to answer before throwing (-1 waits forever)
+		inline void SetTimeout(int timeoutMilliseconds) { timeout = timeoutMilliseconds; }
+
+	private:
+		friend NetworkEvolver;
+
+		// Has the simulator reset organisms [startIndex, endIndex) and copies their first inputs into them
+		void BeginEpisode(const NetworkEvolver& evolver, NetworkOrganism* organisms, uint32_t startIndex, uint32_t endIndex);
+		// Has the simulator step every organism in [startIndex, endIndex) that is still stepping
+		void Step(const NetworkEvolver& evolver, NetworkOrganism* organisms, uint32_t startIndex, uint32_t endIndex);
+		// Writes the command, wakes the simulator and waits for it to finish
+		void Request(const NetworkEvolver& evolver, shared::BridgeCommand command, uint32_t startIndex, uint32_t endIndex);
+		// Copies what the simulator wrote for an organism into it
+		void ReadOrganism(NetworkOrganism& organism, uint32_t index);
+
+		shared::Region region;
+		shared::BridgeLayout layout;
+		shared::BridgeHeader* header;
+		shared::Signal requestSignal;
+		shared::Signal responseSignal;
+		int timeout = -1;
+	};
+}
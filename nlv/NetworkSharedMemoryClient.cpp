@@ -0,0 +1,64 @@
+#include "NetworkSharedMemoryClient.h"
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+
+namespace nlv
+{
+	//the layout isn't known until the header has been read
+	NetworkSharedMemoryClient::NetworkSharedMemoryClient(const std::string& name, int timeoutMilliseconds)
+		: layout(0, 0, 0)
+	{
+		//the simulator can be started before the evolver, so keep trying until the bridge exists
+		auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMilliseconds);
+		while (true)
+		{
+			if (shared::Open(name, region))
+			{
+				header = (shared::BridgeHeader*)region.data;
+				if (region.size >= sizeof(shared::BridgeHeader) && header->signature == shared::BRIDGE_SIGNATURE)
+					break;
+				shared::Close(region);
+			}
+			if (timeoutMilliseconds >= 0 && std::chrono::steady_clock::now() >= end)
+				throw std::runtime_error("Could not open the shared memory bridge");
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (header->version != shared::BRIDGE_VERSION)
+		{
+			shared::Close(region);
+			throw std::runtime_error("The shared memory bridge uses a different version");
+		}
+		layout = shared::BridgeLayout(header->populationSize, header->inputCount, header->outputCount);
+		if (region.size < layout.size || !shared::CreateSignal(name + "_request", &header->requestCounter, requestSignal) || !shared::CreateSignal(name + "_response", &header->responseCounter, responseSignal))
+		{
+			shared::CloseSignal(requestSignal);
+			shared::Close(region);
+			throw std::runtime_error("Could not open the shared memory bridge");
+		}
+		//every request gets exactly one response, so a request sent before the simulator started is still waiting
+		lastRequest = header->responseCounter.load(std::memory_order_acquire);
+	}
+
+	NetworkSharedMemoryClient::~NetworkSharedMemoryClient()
+	{
+		shared::CloseSignal(requestSignal);
+		shared::CloseSignal(responseSignal);
+		shared::Close(region);
+	}
+
+	shared::BridgeCommand NetworkSharedMemoryClient::WaitForCommand(int timeoutMilliseconds)
+	{
+		if (!shared::Wait(requestSignal, lastRequest, timeoutMilliseconds))
+			return shared::BridgeCommand::Shutdown;
+		lastRequest = header->requestCounter.load(std::memory_order_acquire);
+		return header->command;
+	}
+
+	void NetworkSharedMemoryClient::Respond()
+	{
+		shared::Notify(responseSignal);
+	}
+}
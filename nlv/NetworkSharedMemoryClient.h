@@ -0,0 +1,51 @@
+#pragma once
+#include "SharedMemory.h"
+
+namespace nlv
+{
+	//the simulator's side of a NetworkSharedMemoryBridge. only depends on SharedMemory, so it can be built into a simulator without the rest of the library
+	//usage: call WaitForCommand, do what the command says for organisms [GetStartIndex(), GetEndIndex()), then call Respond
+	class NetworkSharedMemoryClient
+	{
+	public:
+		// name: the name the bridge was created with
+		// timeoutMilliseconds: how long to wait for the bridge to be created (-1 waits forever)
+		NetworkSharedMemoryClient(const std::string& name, int timeoutMilliseconds = 5000);
+		~NetworkSharedMemoryClient();
+		NetworkSharedMemoryClient(const NetworkSharedMemoryClient& other) = delete;
+		NetworkSharedMemoryClient& operator=(const NetworkSharedMemoryClient& other) = delete;
+
+		// Waits for the evolver to send a command
+		// Returns the command, or Shutdown if it timed out
+		shared::BridgeCommand WaitForCommand(int timeoutMilliseconds = -1);
+		// Tells the evolver that the command has been finished
+		void Respond();
+
+		inline uint32_t GetPopulationSize() const { return header->populationSize; }
+		inline uint32_t GetInputCount() const { return header->inputCount; }
+		inline uint32_t GetOutputCount() const { return header->outputCount; }
+		inline uint32_t GetGeneration() const { return header->generation; }
+		inline uint32_t GetMaxSteps() const { return header->maxSteps; }
+		inline uint32_t GetStartIndex() const { return header->startIndex; }
+		inline uint32_t GetEndIndex() const { return header->endIndex; }
+
+		// Returns whether the organism should be stepped for the current Step command
+		inline bool GetIsStepping(uint32_t organismIndex) const { return ((const uint8_t*)region.data + layout.stepping)[organismIndex] != 0; }
+		// Returns the organism's network outputs from this step
+		inline const float* GetNetworkOutputActivations(uint32_t organismIndex) const { return (const float*)((const char*)region.data + layout.outputs) + organismIndex * header->outputCount; }
+		// Returns the array the organism's network inputs for the next step are written to
+		inline float* GetNetworkInputArray(uint32_t organismIndex) { return (float*)((char*)region.data + layout.inputs) + organismIndex * header->inputCount; }
+		inline float GetFitness(uint32_t organismIndex) const { return ((const float*)((const char*)region.data + layout.fitness))[organismIndex]; }
+		inline void SetFitness(uint32_t organismIndex, float fitness) { ((float*)((char*)region.data + layout.fitness))[organismIndex] = fitness; }
+		inline void SetContinueStepping(uint32_t organismIndex, bool continueStepping) { ((uint8_t*)region.data + layout.continueStepping)[organismIndex] = continueStepping; }
+
+	private:
+		shared::Region region;
+		shared::BridgeLayout layout;
+		shared::BridgeHeader* header;
+		shared::Signal requestSignal;
+		shared::Signal responseSignal;
+		//the request counter when the last command was received
+		uint32_t lastRequest;
+	};
+}
@@ -0,0 +1,445 @@
+#include "NetworkTopologyEvolver.h"
+#include <thread>
+#include <stdexcept>
+
+namespace nlv
+{
+	NetworkTopologyEvolver::NetworkTopologyEvolver(uint32_t inputs, uint32_t outputs, TopologyStepCallback stepFunction, uint32_t populationSize, uint32_t maxSteps, uint32_t seed)
+		: stepCallback(stepFunction), maxSteps(maxSteps)
+	{
+		if (populationSize == 0)
+			throw std::runtime_error("Generation size cannot be 0");
+		if (maxSteps == 0)
+			throw std::runtime_error("Max steps cannot be 0");
+		if (stepCallback == nullptr)
+			throw std::runtime_error("Step callback cannot be nullptr");
+
+		if (seed == 0)
+			engine.seed(std::random_device()());
+		else
+			engine.seed(seed);
+
+		//every network starts minimal, with the same innovations for its input to output connections
+		TopologyNetwork minimal(inputs, outputs);
+		for (const auto& connection : minimal.GetConnections())
+			connectionInnovations[{ connection.from, connection.to }] = connection.innovation;
+		nextInnovation = inputs * outputs;
+		nextNodeId = inputs + outputs;
+
+		organisms.reserve(populationSize);
+		for (uint32_t i = 0; i < populationSize; i++)
+		{
+			TopologyNetwork network = minimal;
+			for (auto& connection : network.connections)
+				connection.weight = Chance() * 2 - 1;
+			network.Compile();
+			organisms.emplace_back(network);
+		}
+	}
+
+	void NetworkTopologyEvolver::EvaluateGeneration()
+	{
+		CreateNewGen();
+		if (startCallback)
+			startCallback(*this, organisms.data());
+		RunEpisode();
+		if (endCallback)
+			endCallback(*this, organisms.data());
+		currentGeneration++;
+	}
+
+	void NetworkTopologyEvolver::EvaluateGenerations(uint32_t count)
+	{
+		if (count == 0)
+			throw std::runtime_error("Count cannot be 0");
+
+		for (uint32_t i = 0; i < count; i++)
+			EvaluateGeneration();
+	}
+
+	const TopologyOrganism& NetworkTopologyEvolver::FindBestOrganism() const
+	{
+		uint32_t index = 0;
+		for (uint32_t i = 1; i < organisms.size(); i++)
+		{
+			if (organisms[i].fitness > organisms[index].fitness)
+				index = i;
+		}
+		return organisms[index];
+	}
+
+	void NetworkTopologyEvolver::SetCompatibility(float threshold, float excessCoefficient, float disjointCoefficient, float weightCoefficient)
+	{
+		compatibilityThreshold = std::max(threshold, 0.0f);
+		this->excessCoefficient = excessCoefficient;
+		this->disjointCoefficient = disjointCoefficient;
+		this->weightCoefficient = weightCoefficient;
+	}
+
+	void NetworkTopologyEvolver::SetMutation(float weightRate, float addConnectionRate, float addNodeRate, float weightScale)
+	{
+		weightMutationRate = std::clamp(weightRate, 0.0f, 1.0f);
+		this->addConnectionRate = std::clamp(addConnectionRate, 0.0f, 1.0f);
+		this->addNodeRate = std::clamp(addNodeRate, 0.0f, 1.0f);
+		weightMutationScale = weightScale;
+	}
+
+	void NetworkTopologyEvolver::CreateNewGen()
+	{
+		//the first generation hasn't been stepped yet, and therefore cannot be used for creating a new generation
+		if (currentGeneration == 0)
+			return;
+
+		Speciate();
+		AllocateOffspring();
+
+		uint32_t populationSize = (uint32_t)organisms.size();
+		std::vector<TopologyOrganism> newOrganisms;
+		newOrganisms.reserve(populationSize);
+		for (auto& s : species)
+		{
+			if (s.offspringCount == 0)
+				continue;
+
+			std::sort(s.members.begin(), s.members.end(), [this](uint32_t a, uint32_t b) { return organisms[a].fitness > organisms[b].fitness; });
+			uint32_t children = s.offspringCount;
+			//the champion of a big enough species is kept as is
+			if (s.members.size() >= 5)
+			{
+				newOrganisms.emplace_back(organisms[s.members[0]].network);
+				children--;
+			}
+
+			//only the best of the species can be parents
+			uint32_t parentCount = std::max((uint32_t)std::ceil(survivalRate * s.members.size()), 1U);
+			for (uint32_t c = 0; c < children; c++)
+			{
+				const TopologyOrganism& p1 = organisms[s.members[ChanceIndex(parentCount)]];
+				TopologyNetwork child;
+				if (parentCount > 1 && Chance() < crossoverRate)
+				{
+					const TopologyOrganism& p2 = organisms[s.members[ChanceIndex(parentCount)]];
+					if (p1.fitness >= p2.fitness)
+						Crossover(child, p1.network, p2.network);
+					else
+						Crossover(child, p2.network, p1.network);
+				}
+				else
+					child = p1.network;
+
+				Mutate(child);
+				child.Compile();
+				newOrganisms.emplace_back(child);
+			}
+		}
+
+		//species without children are gone, the rest are represented by a random member of the last generation
+		species.erase(std::remove_if(species.begin(), species.end(), [](const Species& s) { return s.offspringCount == 0; }), species.end());
+		for (auto& s : species)
+		{
+			s.representative = organisms[s.members[ChanceIndex((uint32_t)s.members.size())]].network;
+			s.members.clear();
+		}
+
+		organisms = std::move(newOrganisms);
+	}
+
+	void NetworkTopologyEvolver::Speciate()
+	{
+		for (auto& s : species)
+			s.members.clear();
+
+		for (uint32_t i = 0; i < organisms.size(); i++)
+		{
+			TopologyOrganism& organism = organisms[i];
+			bool found = false;
+			for (uint32_t s = 0; s < species.size() && !found; s++)
+			{
+				if (Distance(species[s].representative, organism.network) < compatibilityThreshold)
+				{
+					species[s].members.push_back(i);
+					found = true;
+				}
+			}
+			if (!found)
+			{
+				Species newSpecies;
+				newSpecies.representative = organism.network;
+				newSpecies.members.push_back(i);
+				species.push_back(std::move(newSpecies));
+			}
+		}
+
+		species.erase(std::remove_if(species.begin(), species.end(), [](const Species& s) { return s.members.empty(); }), species.end());
+		for (uint32_t s = 0; s < species.size(); s++)
+		{
+			float best = -INFINITY;
+			for (uint32_t member : species[s].members)
+			{
+				organisms[member].species = s;
+				best = std::max(best, organisms[member].fitness);
+			}
+
+			if (best > species[s].bestFitness)
+			{
+				species[s].bestFitness = best;
+				species[s].generationsSinceImprovement = 0;
+			}
+			else
+				species[s].generationsSinceImprovement++;
+		}
+	}
+
+	void NetworkTopologyEvolver::AllocateOffspring()
+	{
+		uint32_t populationSize = (uint32_t)organisms.size();
+		const TopologyOrganism& best = FindBestOrganism();
+
+		//fitness sharing: a species' score is the average fitness of its members, so big species don't take over the population
+		//(fitnesses are shifted so they are all positive)
+		float minFitness = INFINITY;
+		for (const auto& organism : organisms)
+			minFitness = std::min(minFitness, organism.fitness);
+		float shift = minFitness < 0 ? -minFitness : 0;
+
+		std::vector<double> scores(species.size(), 0);
+		double totalScore = 0;
+		uint32_t allowedSpecies = 0;
+		for (uint32_t s = 0; s < species.size(); s++)
+		{
+			//stagnant species have no children, unless they have the best organism
+			if (species[s].generationsSinceImprovement >= stagnationLimit && s != best.species)
+				continue;
+			double sum = 0;
+			for (uint32_t member : species[s].members)
+				sum += organisms[member].fitness + shift;
+			//(a tiny score still lets species with all zero fitness have children)
+			scores[s] = sum / species[s].members.size() + 1e-6;
+			totalScore += scores[s];
+			allowedSpecies++;
+		}
+
+		//the rounded down shares, then the leftover children go to the species with the biggest remainders
+		uint32_t given = 0;
+		std::vector<std::pair<double, uint32_t>> remainders;
+		for (uint32_t s = 0; s < species.size(); s++)
+		{
+			double share = scores[s] / totalScore * populationSize;
+			species[s].offspringCount = (uint32_t)share;
+			given += species[s].offspringCount;
+			if (scores[s] > 0)
+				remainders.push_back({ share - species[s].offspringCount, s });
+		}
+		std::sort(remainders.begin(), remainders.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+		for (uint32_t i = 0; given < populationSize; i = (i + 1) % (uint32_t)remainders.size())
+		{
+			species[remainders[i].second].offspringCount++;
+			given++;
+		}
+	}
+
+	void NetworkTopologyEvolver::RunEpisode()
+	{
+		uint32_t populationSize = (uint32_t)organisms.size();
+		if (threadedStepping && episodeThreadCount > 1)
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(episodeThreadCount);
+			uint32_t perThreadAmount = populationSize / episodeThreadCount;
+			uint32_t extraIndex = episodeThreadCount - (populationSize % episodeThreadCount);
+			uint32_t startIndex = 0;
+			for (uint32_t t = 0; t < episodeThreadCount; t++)
+			{
+				//if thread index is more than extraIndex, the thread needs to take care of one more organism
+				uint32_t endIndex = startIndex + perThreadAmount + (uint32_t)(t >= extraIndex);
+				threads.emplace_back([this, startIndex, endIndex]() { RunEpisodeRange(startIndex, endIndex); });
+				startIndex = endIndex;
+			}
+			for (auto& thread : threads)
+				thread.join();
+		}
+		else
+			RunEpisodeRange(0, populationSize);
+	}
+
+	void NetworkTopologyEvolver::RunEpisodeRange(uint32_t startIndex, uint32_t endIndex)
+	{
+		uint32_t inputCount = organisms[0].network.GetInputCount();
+		for (uint32_t i = startIndex; i < endIndex; i++)
+		{
+			TopologyOrganism& organism = organisms[i];
+			//an organism stops stepping if continuestepping evaluates to false or if the step count reaches maxSteps
+			for (; organism.steps < maxSteps && organism.continueStepping; organism.steps++)
+			{
+				organism.network.Evaluate(organism.networkInputs.data(), inputCount);
+				stepCallback(*this, organism, i);
+			}
+		}
+	}
+
+	float NetworkTopologyEvolver::Distance(const TopologyNetwork& a, const TopologyNetwork& b) const
+	{
+		const auto& ca = a.connections;
+		const auto& cb = b.connections;
+		uint32_t excess = 0, disjoint = 0, matching = 0;
+		float weightDifference = 0;
+		size_t i = 0, j = 0;
+		while (i < ca.size() && j < cb.size())
+		{
+			if (ca[i].innovation == cb[j].innovation)
+			{
+				weightDifference += std::abs(ca[i].weight - cb[j].weight);
+				matching++;
+				i++;
+				j++;
+			}
+			else if (ca[i].innovation < cb[j].innovation)
+			{
+				disjoint++;
+				i++;
+			}
+			else
+			{
+				disjoint++;
+				j++;
+			}
+		}
+		//whatever is left over is past the end of the other genome
+		excess = (uint32_t)((ca.size() - i) + (cb.size() - j));
+
+		//small genomes aren't normalized (like in the NEAT paper)
+		size_t largest = std::max(ca.size(), cb.size());
+		float normalizer = largest < 20 ? 1.0f : (float)largest;
+		return excessCoefficient * excess / normalizer + disjointCoefficient * disjoint / normalizer + weightCoefficient * (matching ? weightDifference / matching : 0);
+	}
+
+	void NetworkTopologyEvolver::Crossover(TopologyNetwork& child, const TopologyNetwork& fitter, const TopologyNetwork& other)
+	{
+		//structure comes from the fitter parent, matching genes are taken from either parent
+		child = fitter;
+		size_t j = 0;
+		for (auto& connection : child.connections)
+		{
+			while (j < other.connections.size() && other.connections[j].innovation < connection.innovation)
+				j++;
+			if (j == other.connections.size() || other.connections[j].innovation != connection.innovation)
+				continue;
+
+			const TopologyConnectionGene& match = other.connections[j];
+			if (Chance() < 0.5f)
+				connection.weight = match.weight;
+			//a gene disabled in either parent is usually disabled in the child
+			if (!connection.enabled || !match.enabled)
+				connection.enabled = Chance() > 0.75f;
+		}
+
+		j = 0;
+		for (auto& node : child.nodes)
+		{
+			while (j < other.nodes.size() && other.nodes[j].id < node.id)
+				j++;
+			if (j < other.nodes.size() && other.nodes[j].id == node.id && Chance() < 0.5f)
+				node.bias = other.nodes[j].bias;
+		}
+	}
+
+	void NetworkTopologyEvolver::Mutate(TopologyNetwork& network)
+	{
+		if (Chance() < weightMutationRate)
+			MutateWeights(network);
+		if (Chance() < addConnectionRate)
+			MutateAddConnection(network);
+		if (Chance() < addNodeRate)
+			MutateAddNode(network);
+	}
+
+	void NetworkTopologyEvolver::MutateWeights(TopologyNetwork& network)
+	{
+		//mostly nudged, sometimes replaced
+		for (auto& connection : network.connections)
+		{
+			if (Chance() < 0.9f)
+				connection.weight += gaussian(engine) * weightMutationScale;
+			else
+				connection.weight = Chance() * 2 - 1;
+		}
+		for (auto& node : network.nodes)
+		{
+			if (node.type != TopologyNodeType::Input)
+				node.bias += gaussian(engine) * weightMutationScale * 0.5f;
+		}
+	}
+
+	void NetworkTopologyEvolver::MutateAddConnection(TopologyNetwork& network)
+	{
+		//a few random pairs are tried, in a dense network most of them will already be connected
+		uint32_t nodeCount = (uint32_t)network.nodes.size();
+		for (int attempt = 0; attempt < 20; attempt++)
+		{
+			const TopologyNodeGene& from = network.nodes[ChanceIndex(nodeCount)];
+			const TopologyNodeGene& to = network.nodes[ChanceIndex(nodeCount)];
+			if (from.type == TopologyNodeType::Output || to.type == TopologyNodeType::Input)
+				continue;
+			if (network.HasConnection(from.id, to.id) || network.CreatesCycle(from.id, to.id))
+				continue;
+
+			TopologyConnectionGene connection = { GetInnovation(from.id, to.id), from.id, to.id, Chance() * 2 - 1, true };
+			auto position = std::upper_bound(network.connections.begin(), network.connections.end(), connection.innovation,
+				[](uint32_t innovation, const TopologyConnectionGene& gene) { return innovation < gene.innovation; });
+			network.connections.insert(position, connection);
+			return;
+		}
+	}
+
+	void NetworkTopologyEvolver::MutateAddNode(TopologyNetwork& network)
+	{
+		std::vector<uint32_t> enabled;
+		for (uint32_t c = 0; c < network.connections.size(); c++)
+		{
+			if (network.connections[c].enabled)
+				enabled.push_back(c);
+		}
+		if (enabled.empty())
+			return;
+
+		//the connection is split in two, with the new node in between
+		TopologyConnectionGene& split = network.connections[enabled[ChanceIndex((uint32_t)enabled.size())]];
+		split.enabled = false;
+		TopologyConnectionGene old = split;
+
+		//the same split in another network gets the same node, unless this network already split it once
+		uint32_t id;
+		auto it = splitNodes.find(old.innovation);
+		if (it != splitNodes.end() && network.FindNode(it->second) == -1)
+			id = it->second;
+		else
+		{
+			id = nextNodeId++;
+			if (it == splitNodes.end())
+				splitNodes[old.innovation] = id;
+		}
+
+		TopologyNodeGene node = { id, TopologyNodeType::Hidden, 0 };
+		auto nodePosition = std::upper_bound(network.nodes.begin(), network.nodes.end(), id, [](uint32_t id, const TopologyNodeGene& gene) { return id < gene.id; });
+		network.nodes.insert(nodePosition, node);
+
+		//the incoming connection has a weight of 1 and the outgoing connection keeps the old weight, so the network changes as little as possible
+		TopologyConnectionGene in = { GetInnovation(old.from, id), old.from, id, 1.0f, true };
+		TopologyConnectionGene out = { GetInnovation(id, old.to), id, old.to, old.weight, true };
+		for (const auto& connection : { in, out })
+		{
+			auto position = std::upper_bound(network.connections.begin(), network.connections.end(), connection.innovation,
+				[](uint32_t innovation, const TopologyConnectionGene& gene) { return innovation < gene.innovation; });
+			network.connections.insert(position, connection);
+		}
+	}
+
+	uint32_t NetworkTopologyEvolver::GetInnovation(uint32_t from, uint32_t to)
+	{
+		auto it = connectionInnovations.find({ from, to });
+		if (it != connectionInnovations.end())
+			return it->second;
+		connectionInnovations[{ from, to }] = nextInnovation;
+		return nextInnovation++;
+	}
+}
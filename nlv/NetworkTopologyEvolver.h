@@ -0,0 +1,142 @@
+#pragma once
+#include "TopologyOrganism.h"
+#include <random>
+#include <map>
+#include <algorithm>
+#include <cmath>
+
+namespace nlv
+{
+	class NetworkTopologyEvolver;
+
+	//the same as EvolverStepCallback, for topology evolving networks
+	typedef void(*TopologyStepCallback)(const NetworkTopologyEvolver& evolver, TopologyOrganism& organism, int organismIndex);
+	//the same as EvolverGenerationCallback, for topology evolving networks
+	typedef void(*TopologyGenerationCallback)(const NetworkTopologyEvolver& evolver, TopologyOrganism* organisms);
+
+	//evolves the topology of networks as well as their weights (NEAT)
+	//networks start with no hidden nodes and only grow by mutation, every new node and connection gets an innovation number so
+	//networks with different topologies can be crossed over and compared. organisms are split into species by how similar they are,
+	//and share fitness within their species, so new structures get time to be optimized before competing with the rest of the population
+	class NetworkTopologyEvolver
+	{
+	public:
+		// inputs: The number of network inputs
+		// outputs: The number of network outputs
+		// stepFunction: Called for each organism every step
+		// populationSize: The number of organisms in the population
+		// maxSteps: The maximum number of steps in an episode per organism
+		// seed: The seed for the random engine. Setting this to zero automatically assigns a random seed
+		NetworkTopologyEvolver(uint32_t inputs, uint32_t outputs, TopologyStepCallback stepFunction, uint32_t populationSize, uint32_t maxSteps, uint32_t seed = 0);
+
+		// Evaluates a generation: constructs a new generation and calculates fitness values for them
+		void EvaluateGeneration();
+		// Evaluates several generations
+		void EvaluateGenerations(uint32_t count);
+
+		//Finds the organism with the highest fitness
+		const TopologyOrganism& FindBestOrganism() const;
+
+		//Getters
+		inline const TopologyOrganism* GetPopulationArray() const { return organisms.data(); }
+		inline uint32_t GetGeneration() const { return currentGeneration; }
+		inline uint32_t GetPopulationSize() const { return (uint32_t)organisms.size(); }
+		inline uint32_t GetMaxSteps() const { return maxSteps; }
+		inline uint32_t GetSpeciesCount() const { return (uint32_t)species.size(); }
+		inline bool GetIfThreadedEpisodes() const { return threadedStepping; }
+		inline uint32_t GetEpisodeThreadCount() const { return episodeThreadCount; }
+		inline float GetCompatibilityThreshold() const { return compatibilityThreshold; }
+		inline void* GetUserPointer() const { return userPointer; }
+
+		//Setters
+		// startFunction: called before running each episode
+		// endFunction: called after running each episode
+		inline void SetCallbacks(TopologyGenerationCallback startFunction, TopologyGenerationCallback endFunction) { startCallback = startFunction; endCallback = endFunction; }
+		inline void SetEpisodeParameters(bool threaded, uint32_t threadCount = 5) { threadedStepping = threaded; episodeThreadCount = std::max(threadCount, 1U); }
+		inline void SetMaxSteps(uint32_t max) { maxSteps = std::max(max, 1U); }
+		// threshold: organisms closer than this are in the same species
+		// excessCoefficient, disjointCoefficient, weightCoefficient: how much each difference between genomes adds to their distance
+		void SetCompatibility(float threshold, float excessCoefficient = 1.0f, float disjointCoefficient = 1.0f, float weightCoefficient = 0.4f);
+		// weightRate: the chance that a child's weights are mutated
+		// addConnectionRate: the chance that a child gets a new connection
+		// addNodeRate: the chance that a child gets a new node (splitting a connection)
+		// weightScale: the standard deviation of weight mutations
+		void SetMutation(float weightRate, float addConnectionRate, float addNodeRate, float weightScale = 0.5f);
+		// crossoverRate: the chance that a child is made from two parents instead of one
+		// survivalRate: the percentage of each species that can be parents
+		inline void SetReproduction(float crossoverRate, float survivalRate) { this->crossoverRate = std::clamp(crossoverRate, 0.0f, 1.0f); this->survivalRate = std::clamp(survivalRate, 0.01f, 1.0f); }
+		// generations: a species that hasn't improved for this many generations has no children (unless it has the best organism)
+		inline void SetStagnationLimit(uint32_t generations) { stagnationLimit = std::max(generations, 1U); }
+		inline void SetUserPointer(void* ptr) { userPointer = ptr; }
+
+	private:
+		struct Species
+		{
+			// new organisms are compared against this to decide if they are part of the species
+			TopologyNetwork representative;
+			std::vector<uint32_t> members;
+			float bestFitness = -INFINITY;
+			uint32_t generationsSinceImprovement = 0;
+			uint32_t offspringCount = 0;
+		};
+
+		// Create the next generation based on values from the last generation
+		void CreateNewGen();
+		// Puts every organism into a species
+		void Speciate();
+		// Decides how many children every species has
+		void AllocateOffspring();
+		void RunEpisode();
+		void RunEpisodeRange(uint32_t startIndex, uint32_t endIndex);
+
+		// Returns how different two networks are
+		float Distance(const TopologyNetwork& a, const TopologyNetwork& b) const;
+		// fitter: the parent whose structure is kept
+		void Crossover(TopologyNetwork& child, const TopologyNetwork& fitter, const TopologyNetwork& other);
+		void Mutate(TopologyNetwork& network);
+		void MutateWeights(TopologyNetwork& network);
+		void MutateAddConnection(TopologyNetwork& network);
+		void MutateAddNode(TopologyNetwork& network);
+		// Returns the innovation number of a connection between two nodes, making a new one if it has never existed
+		uint32_t GetInnovation(uint32_t from, uint32_t to);
+
+		std::vector<TopologyOrganism> organisms;
+		std::vector<Species> species;
+
+		//innovation tracking: the same structural change always gets the same number, in any network
+		std::map<std::pair<uint32_t, uint32_t>, uint32_t> connectionInnovations;
+		//the node made by splitting a connection (by the connection's innovation number)
+		std::map<uint32_t, uint32_t> splitNodes;
+		uint32_t nextInnovation = 0;
+		uint32_t nextNodeId = 0;
+
+		std::default_random_engine engine;
+		std::uniform_real_distribution<float> dist = std::uniform_real_distribution<float>(0.0f, 1.0f);
+		std::normal_distribution<float> gaussian = std::normal_distribution<float>(0.0f, 1.0f);
+		//between 0 and 1
+		inline float Chance() { return dist(engine); }
+		inline uint32_t ChanceIndex(uint32_t size) { return std::min((uint32_t)(Chance() * size), size - 1); }
+
+		TopologyStepCallback stepCallback = nullptr;
+		TopologyGenerationCallback startCallback = nullptr;
+		TopologyGenerationCallback endCallback = nullptr;
+		void* userPointer = nullptr;
+
+		uint32_t maxSteps;
+		uint32_t currentGeneration = 0;
+		bool threadedStepping = false;
+		uint32_t episodeThreadCount = 1;
+
+		float compatibilityThreshold = 3.0f;
+		float excessCoefficient = 1.0f;
+		float disjointCoefficient = 1.0f;
+		float weightCoefficient = 0.4f;
+		float weightMutationRate = 0.8f;
+		float addConnectionRate = 0.05f;
+		float addNodeRate = 0.03f;
+		float weightMutationScale = 0.5f;
+		float crossoverRate = 0.75f;
+		float survivalRate = 0.2f;
+		uint32_t stagnationLimit = 15;
+	};
+}
@@ -0,0 +1,185 @@
+#include "RemoteSocket.h"
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <afunix.h>
+#include <cstdio>
+#pragma comment(lib, "Ws2_32.lib")
+typedef SOCKET NativeSocket;
+typedef WSAPOLLFD PollDescriptor;
+#define poll WSAPoll
+#define closeSocket closesocket
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+typedef int NativeSocket;
+typedef pollfd PollDescriptor;
+#define closeSocket close
+#endif
+
+//stops a broken connection from killing the process with SIGPIPE
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+namespace nlv
+{
+	namespace remote
+	{
+		static bool CreateAddress(const std::string& path, sockaddr_un& address)
+		{
+			memset(&address, 0, sizeof(address));
+			address.sun_family = AF_UNIX;
+			if (path.size() >= sizeof(address.sun_path))
+				return false;
+			memcpy(address.sun_path, path.c_str(), path.size());
+			return true;
+		}
+
+		bool Initialize()
+		{
+#ifdef _WIN32
+			static bool initialized = false;
+			if (!initialized)
+			{
+				WSADATA data;
+				initialized = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+			}
+			return initialized;
+#else
+			return true;
+#endif
+		}
+
+		Socket Listen(const std::string& path)
+		{
+			sockaddr_un address;
+			if (!Initialize() || !CreateAddress(path, address))
+				return INVALID_SOCKET_HANDLE;
+
+			NativeSocket listener = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (listener == (NativeSocket)INVALID_SOCKET_HANDLE)
+				return INVALID_SOCKET_HANDLE;
+
+			//a socket file left over from an old run would stop bind from working
+			RemovePath(path);
+			if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0)
+			{
+				closeSocket(listener);
+				return INVALID_SOCKET_HANDLE;
+			}
+			return (Socket)listener;
+		}
+
+		Socket Accept(Socket listener, int timeoutMilliseconds)
+		{
+			bool readable = false;
+			if (!WaitReadable(&listener, 1, &readable, timeoutMilliseconds) || !readable)
+				return INVALID_SOCKET_HANDLE;
+
+			NativeSocket connection = accept((NativeSocket)listener, nullptr, nullptr);
+			if (connection == (NativeSocket)INVALID_SOCKET_HANDLE)
+				return INVALID_SOCKET_HANDLE;
+			return (Socket)connection;
+		}
+
+		Socket Connect(const std::string& path)
+		{
+			sockaddr_un address;
+			if (!Initialize() || !CreateAddress(path, address))
+				return INVALID_SOCKET_HANDLE;
+
+			NativeSocket connection = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (connection == (NativeSocket)INVALID_SOCKET_HANDLE)
+				return INVALID_SOCKET_HANDLE;
+			if (connect(connection, (sockaddr*)&address, sizeof(address)) != 0)
+			{
+				closeSocket(connection);
+				return INVALID_SOCKET_HANDLE;
+			}
+			return (Socket)connection;
+		}
+
+		void Close(Socket socket)
+		{
+			if (socket != INVALID_SOCKET_HANDLE)
+				closeSocket((NativeSocket)socket);
+		}
+
+		void RemovePath(const std::string& path)
+		{
+#ifdef _WIN32
+			std::remove(path.c_str());
+#else
+			unlink(path.c_str());
+#endif
+		}
+
+		bool SendAll(Socket socket, const void* data, size_t size)
+		{
+			const char* bytes = (const char*)data;
+			while (size > 0)
+			{
+				auto sent = send((NativeSocket)socket, bytes, (int)std::min(size, (size_t)INT32_MAX), SEND_FLAGS);
+				if (sent <= 0)
+					return false;
+				bytes += sent;
+				size -= sent;
+			}
+			return true;
+		}
+
+		bool ReceiveAll(Socket socket, void* data, size_t size)
+		{
+			char* bytes = (char*)data;
+			while (size > 0)
+			{
+				auto received = recv((NativeSocket)socket, bytes, (int)std::min(size, (size_t)INT32_MAX), 0);
+				//0 means the other side closed the connection
+				if (received <= 0)
+					return false;
+				bytes += received;
+				size -= received;
+			}
+			return true;
+		}
+
+		bool SetReceiveTimeout(Socket socket, int timeoutMilliseconds)
+		{
+#ifdef _WIN32
+			DWORD timeout = (DWORD)timeoutMilliseconds;
+#else
+			timeval timeout;
+			timeout.tv_sec = timeoutMilliseconds / 1000;
+			timeout.tv_usec = (timeoutMilliseconds % 1000) * 1000;
+#endif
+			return setsockopt((NativeSocket)socket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout)) == 0;
+		}
+
+		bool WaitReadable(const Socket* sockets, uint32_t count, bool* readable, int timeoutMilliseconds)
+		{
+			std::vector<PollDescriptor> descriptors(count);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				descriptors[i].fd = (NativeSocket)sockets[i];
+				descriptors[i].events = POLLIN;
+				descriptors[i].revents = 0;
+			}
+
+			if (poll(descriptors.data(), count, timeoutMilliseconds) < 0)
+				return false;
+
+			for (uint32_t i = 0; i < count; i++)
+				readable[i] = (descriptors[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+			return true;
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace nlv
+{
+	//small wrapper around unix domain sockets shared by NetworkRemoteEvaluator and NetworkRemoteWorker
+	//(windows supports unix domain sockets through winsock since windows 10)
+	namespace remote
+	{
+		//big enough for a file descriptor or a winsock SOCKET
+		typedef intptr_t Socket;
+		constexpr Socket INVALID_SOCKET_HANDLE = -1;
+
+		//sent by a worker when it connects, followed by the protocol version
+		constexpr uint32_t WORKER_SIGNATURE = 0x45564C4E; // NLVE
+		constexpr uint32_t PROTOCOL_VERSION = 1;
+		//how long a worker has to send its signature after connecting before the connection is dropped
+		constexpr int HANDSHAKE_TIMEOUT_MILLISECONDS = 2000;
+
+		//messages sent from the evaluator to a worker (every message starts with its type as a uint32)
+		enum class MessageType : uint32_t
+		{
+			// input count, layer count, neuron count of every layer, type of every layer, gene count
+			Layout = 1,
+			// generation, max steps, organism count, then the index and genes of every organism
+			// the worker replies with the organism count, then the index, fitness and steps of every organism
+			Batch = 2,
+			// the worker should stop
+			Shutdown = 3
+		};
+
+		// Initializes the socket library (only does anything on windows). Returns false if it failed
+		bool Initialize();
+		// Creates a socket listening on the path, removing whatever was at the path first
+		Socket Listen(const std::string& path);
+		// Accepts a connection if one is waiting
+		// timeoutMilliseconds: how long to wait for a connection (0 doesn't wait)
+		Socket Accept(Socket listener, int timeoutMilliseconds);
+		// Connects to a socket listening on the path
+		Socket Connect(const std::string& path);
+		void Close(Socket socket);
+		void RemovePath(const std::string& path);
+
+		// Sends or receives exactly size bytes. Returns false if the connection broke
+		bool SendAll(Socket socket, const void* data, size_t size);
+		bool ReceiveAll(Socket socket, void* data, size_t size);
+		// Sets how long receiving can block before it fails (ReceiveAll returns false)
+		// timeoutMilliseconds: 0 blocks forever
+		// Returns false if the timeout couldn't be set
+		bool SetReceiveTimeout(Socket socket, int timeoutMilliseconds);
+		// Waits until data can be read from any of the sockets (or any of them disconnected)
+		// readable: set for every socket
+		// timeoutMilliseconds: -1 waits forever
+		// Returns false if waiting failed
+		bool WaitReadable(const Socket* sockets, uint32_t count, bool* readable, int timeoutMilliseconds);
+	}
+}
@@ -0,0 +1,203 @@
+#include "SharedMemory.h"
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#endif
+
+//the number of times a waiting process checks the counter before going to sleep
+//a simulator usually answers quickly, so this saves a syscall on most steps
+constexpr int SPIN_COUNT = 4000;
+
+namespace nlv
+{
+	namespace shared
+	{
+		bool Create(const std::string& name, size_t size, Region& region)
+		{
+			Close(region);
+#ifdef _WIN32
+			HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, ("Local\\" + name).c_str());
+			if (handle == nullptr)
+				return false;
+			void* data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+			if (data == nullptr)
+			{
+				CloseHandle(handle);
+				return false;
+			}
+			region.handle = (intptr_t)handle;
+#else
+			std::string path = "/" + name;
+			//a region left over from an old run would have the wrong size
+			shm_unlink(path.c_str());
+			int file = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+			if (file < 0)
+				return false;
+			void* data = MAP_FAILED;
+			if (ftruncate(file, size) == 0)
+				data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+			if (data == MAP_FAILED)
+			{
+				close(file);
+				shm_unlink(path.c_str());
+				return false;
+			}
+			region.handle = file;
+#endif
+			memset(data, 0, size);
+			region.data = data;
+			region.size = size;
+			region.name = name;
+			region.owner = true;
+			return true;
+		}
+
+		bool Open(const std::string& name, Region& region)
+		{
+			Close(region);
+#ifdef _WIN32
+			HANDLE handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, ("Local\\" + name).c_str());
+			if (handle == nullptr)
+				return false;
+			void* data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+			MEMORY_BASIC_INFORMATION info;
+			if (data == nullptr || VirtualQuery(data, &info, sizeof(info)) == 0)
+			{
+				if (data)
+					UnmapViewOfFile(data);
+				CloseHandle(handle);
+				return false;
+			}
+			region.handle = (intptr_t)handle;
+			region.size = info.RegionSize;
+#else
+			int file = shm_open(("/" + name).c_str(), O_RDWR, 0600);
+			if (file < 0)
+				return false;
+			struct stat info;
+			void* data = MAP_FAILED;
+			if (fstat(file, &info) == 0 && info.st_size > 0)
+				data = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+			if (data == MAP_FAILED)
+			{
+				close(file);
+				return false;
+			}
+			region.handle = file;
+			region.size = info.st_size;
+#endif
+			region.data = data;
+			region.name = name;
+			region.owner = false;
+			return true;
+		}
+
+		void Close(Region& region)
+		{
+			if (region.data == nullptr)
+				return;
+#ifdef _WIN32
+			UnmapViewOfFile(region.data);
+			CloseHandle((HANDLE)region.handle);
+#else
+			munmap(region.data, region.size);
+			close((int)region.handle);
+			if (region.owner)
+				shm_unlink(("/" + region.name).c_str());
+#endif
+			region = Region();
+		}
+
+		bool CreateSignal([[maybe_unused]] const std::string& name, std::atomic<uint32_t>* word, Signal& signal)
+		{
+			signal.word = word;
+#ifdef _WIN32
+			//auto reset, so one notify wakes one wait
+			HANDLE event = CreateEventA(nullptr, FALSE, FALSE, ("Local\\" + name).c_str());
+			if (event == nullptr)
+				return false;
+			signal.event = (intptr_t)event;
+#endif
+			return true;
+		}
+
+		void CloseSignal(Signal& signal)
+		{
+#ifdef _WIN32
+			if (signal.event)
+				CloseHandle((HANDLE)signal.event);
+#endif
+			signal = Signal();
+		}
+
+		void Notify(Signal& signal)
+		{
+			signal.word->fetch_add(1, std::memory_order_release);
+#ifdef _WIN32
+			SetEvent((HANDLE)signal.event);
+#else
+			//not FUTEX_PRIVATE_FLAG, since the waiter is in another process
+			syscall(SYS_futex, (uint32_t*)signal.word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+		}
+
+		bool Wait(Signal& signal, uint32_t value, int timeoutMilliseconds)
+		{
+			for (int i = 0; i < SPIN_COUNT; i++)
+			{
+				if (signal.word->load(std::memory_order_acquire) != value)
+					return true;
+			}
+
+			auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMilliseconds);
+			while (signal.word->load(std::memory_order_acquire) == value)
+			{
+				long long remaining = -1;
+				if (timeoutMilliseconds >= 0)
+				{
+					remaining = std::chrono::duration_cast<std::chrono::milliseconds>(end - std::chrono::steady_clock::now()).count();
+					if (remaining <= 0)
+						return false;
+				}
+#ifdef _WIN32
+				//the event can be left set by an earlier notify, which just means the counter gets checked again
+				WaitForSingleObject((HANDLE)signal.event, remaining < 0 ? INFINITE : (DWORD)remaining);
+#else
+				timespec time;
+				time.tv_sec = remaining / 1000;
+				time.tv_nsec = (remaining % 1000) * 1000000;
+				//only sleeps if the counter is still value, so a notify can't be missed
+				syscall(SYS_futex, (uint32_t*)signal.word, FUTEX_WAIT, value, remaining < 0 ? nullptr : &time, nullptr, 0);
+#endif
+			}
+			return true;
+		}
+
+		//arrays start on their own cache line so the two processes don't write to the same line
+		static inline size_t AlignOffset(size_t offset)
+		{
+			return (offset + 63) & ~(size_t)63;
+		}
+
+		BridgeLayout::BridgeLayout(uint32_t populationSize, uint32_t inputCount, uint32_t outputCount)
+		{
+			outputs = AlignOffset(sizeof(BridgeHeader));
+			inputs = AlignOffset(outputs + sizeof(float) * populationSize * outputCount);
+			fitness = AlignOffset(inputs + sizeof(float) * populationSize * inputCount);
+			continueStepping = AlignOffset(fitness + sizeof(float) * populationSize);
+			stepping = AlignOffset(continueStepping + populationSize);
+			size = AlignOffset(stepping + populationSize);
+		}
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <atomic>
+
+namespace nlv
+{
+	//small wrapper around named shared memory and cross process signalling shared by NetworkSharedMemoryBridge and NetworkSharedMemoryClient
+	//(uses shm_open and futexes on linux, file mappings and named events on windows)
+	namespace shared
+	{
+		struct Region
+		{
+			void* data = nullptr;
+			size_t size = 0;
+			//file descriptor or windows HANDLE
+			intptr_t handle = -1;
+			std::string name;
+			//the creator of a region removes its name when it is closed
+			bool owner = false;
+		};
+
+		//a counter in shared memory that one process increments and another waits on
+		struct Signal
+		{
+			std::atomic<uint32_t>* word = nullptr;
+			//windows event HANDLE (unused on linux, where the word itself is waited on)
+			intptr_t event = 0;
+		};
+
+		// Creates a zeroed region of shared memory, replacing whatever had the same name
+		// name: the name the other process opens it with (no slashes)
+		// Returns false if it failed
+		bool Create(const std::string& name, size_t size, Region& region);
+		// Opens a region that was created by another process
+		bool Open(const std::string& name, Region& region);
+		void Close(Region& region);
+
+		// word: where the counter is, it has to be inside of a shared region
+		// name: used to name the event on windows, both processes need to use the same name
+		bool CreateSignal(const std::string& name, std::atomic<uint32_t>* word, Signal& signal);
+		void CloseSignal(Signal& signal);
+		// Increments the counter and wakes up the process waiting on it
+		void Notify(Signal& signal);
+		// Waits until the counter is not value anymore
+		// timeoutMilliseconds: -1 waits forever
+		// Returns false if it timed out
+		bool Wait(Signal& signal, uint32_t value, int timeoutMilliseconds);
+
+		//the layout of the region shared by NetworkSharedMemoryBridge and NetworkSharedMemoryClient
+		constexpr uint32_t BRIDGE_SIGNATURE = 0x424C564E; // NLVB
+		constexpr uint32_t BRIDGE_VERSION = 0;
+
+		//what the evolver wants the simulator to do
+		enum class BridgeCommand : uint32_t
+		{
+			// the simulator should reset the environments of organisms [startIndex, endIndex) and write their first inputs
+			BeginEpisode = 1,
+			// the simulator should step every organism that is stepping, using its outputs, then write its inputs, fitness and continueStepping
+			Step = 2,
+			// the evolver is gone, the simulator should stop
+			Shutdown = 3
+		};
+
+		//at the start of the region, followed by the arrays in BridgeLayout
+		struct BridgeHeader
+		{
+			uint32_t signature;
+			uint32_t version;
+			uint32_t populationSize;
+			uint32_t inputCount;
+			uint32_t outputCount;
+			BridgeCommand command;
+			uint32_t generation;
+			uint32_t maxSteps;
+			uint32_t startIndex;
+			uint32_t endIndex;
+			//incremented by the evolver once a command is written
+			alignas(64) std::atomic<uint32_t> requestCounter;
+			//incremented by the simulator once it has finished a command
+			alignas(64) std::atomic<uint32_t> responseCounter;
+		};
+
+		//byte offsets of the arrays in the region (every array is indexed by organism index)
+		struct BridgeLayout
+		{
+			// float[populationSize * outputCount], written by the evolver
+			size_t outputs;
+			// float[populationSize * inputCount], written by the simulator
+			size_t inputs;
+			// float[populationSize], written by the simulator
+			size_t fitness;
+			// uint8_t[populationSize], written by the simulator
+			size_t continueStepping;
+			// uint8_t[populationSize], written by the evolver. whether the organism is stepped this step
+			size_t stepping;
+			// the size of the whole region
+			size_t size;
+
+			BridgeLayout(uint32_t populationSize, uint32_t inputCount, uint32_t outputCount);
+		};
+	}
+}
@@ -0,0 +1,152 @@
+#include "TopologyNetwork.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace nlv
+{
+	TopologyNetwork::TopologyNetwork(uint32_t inputs, uint32_t outputs)
+		: inputCount(inputs), outputCount(outputs)
+	{
+		if (inputs == 0 || outputs == 0)
+			throw std::runtime_error("Network needs at least one input and output");
+
+		nodes.reserve(inputs + outputs);
+		for (uint32_t i = 0; i < inputs; i++)
+			nodes.push_back({ i, TopologyNodeType::Input, 0 });
+		for (uint32_t i = 0; i < outputs; i++)
+			nodes.push_back({ inputs + i, TopologyNodeType::Output, 0 });
+
+		connections.reserve(inputs * outputs);
+		for (uint32_t o = 0; o < outputs; o++)
+		{
+			for (uint32_t i = 0; i < inputs; i++)
+				connections.push_back({ o * inputs + i, i, inputs + o, 0, true });
+		}
+		Compile();
+	}
+
+	float const* TopologyNetwork::Evaluate(const float* input, uint32_t inputCount)
+	{
+#ifdef _DEBUG
+		if (inputCount != this->inputCount)
+			throw std::runtime_error("Input count does not match network input count");
+#endif
+		memcpy(values.data(), input, sizeof(float) * inputCount);
+
+		float* nodeValues = values.data();
+		const uint32_t* sources = programSources.data();
+		const float* weights = programWeights.data();
+		for (const Instruction& instruction : program)
+		{
+			float weightedInput = instruction.bias;
+			uint32_t end = instruction.connectionStart + instruction.connectionCount;
+			for (uint32_t c = instruction.connectionStart; c < end; c++)
+				weightedInput += weights[c] * nodeValues[sources[c]];
+			nodeValues[instruction.target] = Activate(weightedInput);
+		}
+		return nodeValues + inputCount;
+	}
+
+	void TopologyNetwork::Compile()
+	{
+		//the incoming enabled connections of every node
+		std::vector<std::vector<uint32_t>> incoming(nodes.size());
+		for (uint32_t c = 0; c < connections.size(); c++)
+		{
+			const TopologyConnectionGene& connection = connections[c];
+			if (connection.enabled)
+				incoming[FindNode(connection.to)].push_back(c);
+		}
+
+		program.clear();
+		programSources.clear();
+		programWeights.clear();
+		values.assign(nodes.size(), 0.0f);
+
+		//working back from the outputs means nodes that don't lead to an output are never compiled
+		//0 = not visited, 1 = being visited, 2 = compiled
+		std::vector<uint8_t> state(nodes.size(), 0);
+		for (uint32_t i = 0; i < inputCount; i++)
+			state[i] = 2;
+		for (uint32_t i = inputCount; i < inputCount + outputCount; i++)
+			CompileNode(i, incoming, state);
+	}
+
+	void TopologyNetwork::CompileNode(uint32_t nodeIndex, const std::vector<std::vector<uint32_t>>& incoming, std::vector<uint8_t>& state)
+	{
+		if (state[nodeIndex] == 2)
+			return;
+		if (state[nodeIndex] == 1)
+			throw std::runtime_error("Topology network has a cycle");
+		state[nodeIndex] = 1;
+
+		//every node this one depends on goes first
+		for (uint32_t c : incoming[nodeIndex])
+			CompileNode(FindNode(connections[c].from), incoming, state);
+
+		Instruction instruction;
+		instruction.target = nodeIndex;
+		instruction.connectionStart = (uint32_t)programSources.size();
+		instruction.connectionCount = (uint32_t)incoming[nodeIndex].size();
+		instruction.bias = nodes[nodeIndex].bias;
+		for (uint32_t c : incoming[nodeIndex])
+		{
+			programSources.push_back(FindNode(connections[c].from));
+			programWeights.push_back(connections[c].weight);
+		}
+		program.push_back(instruction);
+		state[nodeIndex] = 2;
+	}
+
+	int TopologyNetwork::FindNode(uint32_t id) const
+	{
+		auto it = std::lower_bound(nodes.begin(), nodes.end(), id, [](const TopologyNodeGene& node, uint32_t id) { return node.id < id; });
+		if (it == nodes.end() || it->id != id)
+			return -1;
+		return (int)(it - nodes.begin());
+	}
+
+	bool TopologyNetwork::HasConnection(uint32_t from, uint32_t to) const
+	{
+		for (const auto& connection : connections)
+		{
+			if (connection.from == from && connection.to == to)
+				return true;
+		}
+		return false;
+	}
+
+	bool TopologyNetwork::CreatesCycle(uint32_t from, uint32_t to) const
+	{
+		if (from == to)
+			return true;
+
+		//a cycle is made if from can already be reached from to
+		std::vector<uint32_t> stack = { to };
+		std::vector<uint8_t> visited(nodes.size(), false);
+		while (!stack.empty())
+		{
+			uint32_t id = stack.back();
+			stack.pop_back();
+			if (id == from)
+				return true;
+			int index = FindNode(id);
+			if (visited[index])
+				continue;
+			visited[index] = true;
+			for (const auto& connection : connections)
+			{
+				if (connection.from == id)
+					stack.push_back(connection.to);
+			}
+		}
+		return false;
+	}
+
+	float TopologyNetwork::Activate(float weightedInput)
+	{
+		return 1.0f / (1 + exp(weightedInput));
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace nlv
+{
+	class NetworkTopologyEvolver;
+
+	enum class TopologyNodeType : char
+	{
+		Input,
+		Hidden,
+		Output
+	};
+
+	struct TopologyNodeGene
+	{
+		// Unique between every network in an evolver. Inputs are [0, inputCount), outputs are [inputCount, inputCount + outputCount)
+		uint32_t id;
+		TopologyNodeType type;
+		float bias;
+	};
+
+	struct TopologyConnectionGene
+	{
+		// The same for every network that has a connection between the same two nodes, used to line up genes during crossover
+		uint32_t innovation;
+		// Node ids
+		uint32_t from;
+		uint32_t to;
+		float weight;
+		bool enabled;
+	};
+
+	//a feed forward neural network with any topology, made of node and connection genes (NEAT style)
+	//the genes are compiled into a flat program of nodes in topological order, so evaluating it only does the work of the connections that exist
+	class TopologyNetwork
+	{
+	public:
+		TopologyNetwork() = default;
+		// Creates a minimal network: every input is connected to every output and there are no hidden nodes
+		// connection innovations are [0, inputs * outputs)
+		TopologyNetwork(uint32_t inputs, uint32_t outputs);
+
+		// input: The activations of the input nodes
+		// inputCount: The number of input nodes
+		// returns the output activations of the network (always values between 0 and 1)
+		float const* Evaluate(const float* input, uint32_t inputCount);
+		// Returns the last output activations calculated by the evaluate function (always values between 0 and 1)
+		inline float const* GetPreviousActivations() const { return values.data() + inputCount; }
+
+		inline uint32_t GetInputCount() const { return inputCount; }
+		inline uint32_t GetOutputCount() const { return outputCount; }
+		inline uint32_t GetHiddenCount() const { return (uint32_t)nodes.size() - inputCount - outputCount; }
+		// Sorted by id
+		inline const std::vector<TopologyNodeGene>& GetNodes() const { return nodes; }
+		// Sorted by innovation
+		inline const std::vector<TopologyConnectionGene>& GetConnections() const { return connections; }
+		// Returns the number of connections evaluated in a forward pass (disabled connections and nodes that don't lead to an output are left out)
+		inline uint32_t GetProgramConnectionCount() const { return (uint32_t)programSources.size(); }
+
+		// Rebuilds the evaluation program from the genes (called by the evolver after genes are changed)
+		void Compile();
+
+		// Returns the index of the node with the id, or -1 if there is none
+		int FindNode(uint32_t id) const;
+		// Returns whether a connection between the two nodes exists (enabled or not)
+		bool HasConnection(uint32_t from, uint32_t to) const;
+		// Returns whether adding a connection from -> to would create a cycle (disabled connections count, so they can always be enabled again)
+		bool CreatesCycle(uint32_t from, uint32_t to) const;
+
+	private:
+		friend NetworkTopologyEvolver;
+
+		// Componentwise activation function (the same sigmoid as Network)
+		static float Activate(float weightedInput);
+		// Adds the node at nodeIndex and every node it depends on to the program, in order
+		void CompileNode(uint32_t nodeIndex, const std::vector<std::vector<uint32_t>>& incoming, std::vector<uint8_t>& state);
+
+		std::vector<TopologyNodeGene> nodes;
+		std::vector<TopologyConnectionGene> connections;
+		uint32_t inputCount = 0;
+		uint32_t outputCount = 0;
+
+		//the compiled program: every instruction calculates one node's value from a range of (source, weight) pairs
+		struct Instruction
+		{
+			// the index of the node's value
+			uint32_t target;
+			uint32_t connectionStart;
+			uint32_t connectionCount;
+			float bias;
+		};
+		std::vector<Instruction> program;
+		std::vector<uint32_t> programSources;
+		std::vector<float> programWeights;
+		// the value of every node, in the same order as nodes (so inputs then outputs then hidden nodes)
+		std::vector<float> values;
+	};
+}
@@ -0,0 +1,16 @@
+#include "TopologyOrganism.h"
+
+namespace nlv
+{
+	TopologyOrganism::TopologyOrganism(const TopologyNetwork& network)
+		: network(network), networkInputs(network.GetInputCount(), 0.0f)
+	{
+	}
+
+	void TopologyOrganism::Reset()
+	{
+		fitness = 0;
+		continueStepping = true;
+		steps = 0;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "TopologyNetwork.h"
+
+namespace nlv
+{
+	class NetworkTopologyEvolver;
+
+	//the same as NetworkOrganism, but with a TopologyNetwork
+	class TopologyOrganism
+	{
+		friend NetworkTopologyEvolver;
+	public:
+		TopologyOrganism(const TopologyNetwork& network);
+
+		// The current fitness of the organism
+		float fitness = 0;
+		//whether the organism should continue stepping or not
+		bool continueStepping = true;
+
+		// Returns the activation array from the outputs of the organism's neural network (all values are between 0 and 1)
+		inline const float* GetNetworkOutputActivations() const { return network.GetPreviousActivations(); }
+		// Returns the array containing the input values to the organism's neural network
+		inline float* GetNetworkInputArray() { return networkInputs.data(); }
+
+		const TopologyNetwork& GetNetwork() const { return network; }
+		float GetFitness() const { return fitness; }
+		uint32_t GetStepsTaken() const { return steps; }
+		// Returns the index of the species the organism was put in
+		uint32_t GetSpecies() const { return species; }
+
+	private:
+		//Reset values used in reinforcement learning episode
+		void Reset();
+
+		// The brain of the organism (also its genome)
+		TopologyNetwork network;
+		// The inputs to the organism's brain.
+		std::vector<float> networkInputs;
+		// The amount of steps the organism has taken
+		uint32_t steps = 0;
+		uint32_t species = 0;
+	};
+}
@@ -1,3 +1,10 @@
 #pragma once
 #include "NetworkEvolver.h"
+#include "NetworkIslandEvolver.h"
+#include "NetworkRemoteEvaluator.h"
+#include "NetworkRemoteWorker.h"
+#include "NetworkSharedMemoryBridge.h"
+#include "NetworkSharedMemoryClient.h"
+#include "NetworkTopologyEvolver.h"
+#include "NetworkExporter.h"
 #include "Network.h"
\ No newline at end of file